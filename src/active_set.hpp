@@ -0,0 +1,80 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef _ACTIVE_SET_HPP_
+#define _ACTIVE_SET_HPP_
+
+#include <vector>
+
+using namespace std;
+
+// Set of module indices backed by a bitmap, walked in increasing index
+// order. Next() re-reads the bitmap on every call, so indices inserted
+// ahead of the current position while walking are still visited.
+class ActiveSet {
+
+public:
+  ActiveSet( ) : _size(0) {}
+
+  inline void Resize( int size ) {
+    _size = size;
+    _bits.assign((size + 63) / 64, 0ULL);
+  }
+  inline int Size( ) const {return _size;}
+
+  inline void Insert( int i ) {
+    _bits[i >> 6] |= (1ULL << (i & 63));
+  }
+  inline void Erase( int i ) {
+    _bits[i >> 6] &= ~(1ULL << (i & 63));
+  }
+  inline bool Contains( int i ) const {
+    return (_bits[i >> 6] >> (i & 63)) & 1ULL;
+  }
+
+  // smallest member >= i, or -1 if there is none
+  inline int Next( int i ) const {
+    if(i >= _size) {
+      return -1;
+    }
+    size_t w = i >> 6;
+    unsigned long long word = _bits[w] & (~0ULL << (i & 63));
+    while(!word) {
+      if(++w >= _bits.size()) {
+	return -1;
+      }
+      word = _bits[w];
+    }
+    return (w << 6) + __builtin_ctzll(word);
+  }
+
+private:
+  int _size;
+  vector<unsigned long long> _bits;
+};
+
+#endif
@@ -0,0 +1,110 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*alloc_counter.cpp
+ *
+ *Replaces the global operator new and delete so that heap allocations can
+ *be counted
+ */
+
+#include <cstdlib>
+#include <new>
+#include <atomic>
+
+#include "booksim.hpp"
+#include "alloc_counter.hpp"
+
+static bool gCountAllocs = false;
+static atomic<long long> gAllocs(0);
+
+void EnableAllocCounter( bool enable )
+{
+  gCountAllocs = enable;
+}
+
+long long AllocCount( )
+{
+  return gAllocs.load(memory_order_relaxed);
+}
+
+static inline void * CountedAlloc( size_t size )
+{
+  if(gCountAllocs) {
+    gAllocs.fetch_add(1, memory_order_relaxed);
+  }
+  void * p = malloc(size ? size : 1);
+  if(!p) {
+    throw bad_alloc();
+  }
+  return p;
+}
+
+void * operator new( size_t size )
+{
+  return CountedAlloc(size);
+}
+
+void * operator new[]( size_t size )
+{
+  return CountedAlloc(size);
+}
+
+void * operator new( size_t size, nothrow_t const & ) noexcept
+{
+  if(gCountAllocs) {
+    gAllocs.fetch_add(1, memory_order_relaxed);
+  }
+  return malloc(size ? size : 1);
+}
+
+void * operator new[]( size_t size, nothrow_t const & ) noexcept
+{
+  if(gCountAllocs) {
+    gAllocs.fetch_add(1, memory_order_relaxed);
+  }
+  return malloc(size ? size : 1);
+}
+
+void operator delete( void * p ) noexcept
+{
+  free(p);
+}
+
+void operator delete[]( void * p ) noexcept
+{
+  free(p);
+}
+
+void operator delete( void * p, size_t ) noexcept
+{
+  free(p);
+}
+
+void operator delete[]( void * p, size_t ) noexcept
+{
+  free(p);
+}
@@ -123,14 +123,19 @@ DenseAllocator::DenseAllocator( Module *parent, const string& name,
       _request[i][j].label = -1;
     }
   }
+
+  _in_bits.Resize(_inputs, _outputs);
+  _out_bits.Resize(_outputs, _inputs);
 }
 
 void DenseAllocator::Clear( )
 {
   for ( int i = 0; i < _inputs; ++i ) {
-    for ( int j = 0; j < _outputs; ++j ) {
+    for ( int j = _in_bits.Next(i, 0); j >= 0; j = _in_bits.Next(i, j + 1) ) {
       _request[i][j].label = -1;
+      _out_bits.Reset(j, i);
     }
+    _in_bits.ClearRow(i);
   }
   Allocator::Clear();
 }
@@ -162,6 +167,9 @@ void DenseAllocator::AddRequest( int in, int out, int label,
   _request[in][out].label   = label;
   _request[in][out].in_pri  = in_pri;
   _request[in][out].out_pri = out_pri;
+
+  _in_bits.Set(in, out);
+  _out_bits.Set(out, in);
 }
 
 void DenseAllocator::RemoveRequest( int in, int out, int label )
@@ -170,48 +178,29 @@ void DenseAllocator::RemoveRequest( int in, int out, int label )
   assert( ( out >= 0 ) && ( out < _outputs ) ); 
   
   _request[in][out].label = -1;
+
+  _in_bits.Reset(in, out);
+  _out_bits.Reset(out, in);
 }
 
 bool DenseAllocator::InputHasRequests( int in ) const
 {
-  for(int out = 0; out < _outputs; ++out) {
-    if(_request[in][out].label >= 0) {
-      return true;
-    }
-  }
-  return false;
+  return _in_bits.Any(in);
 }
 
 bool DenseAllocator::OutputHasRequests( int out ) const
 {
-  for(int in = 0; in < _inputs; ++in) {
-    if(_request[in][out].label >= 0) {
-      return true;
-    }
-  }
-  return false;
+  return _out_bits.Any(out);
 }
 
 int DenseAllocator::NumInputRequests( int in ) const
 {
-  int result = 0;
-  for(int out = 0; out < _outputs; ++out) {
-    if(_request[in][out].label >= 0) {
-      ++result;
-    }
-  }
-  return result;
+  return _in_bits.Count(in);
 }
 
 int DenseAllocator::NumOutputRequests( int out ) const
 {
-  int result = 0;
-  for(int in = 0; in < _inputs; ++in) {
-    if(_request[in][out].label >= 0) {
-      ++result;
-    }
-  }
-  return result;
+  return _out_bits.Count(out);
 }
 
 void DenseAllocator::PrintRequests( ostream * os ) const
@@ -259,29 +248,49 @@ SparseAllocator::SparseAllocator( Module *parent, const string& name,
 				  int inputs, int outputs ) :
   Allocator( parent, name, inputs, outputs )
 {
+  _in_bits.Resize(_inputs, _outputs);
+  _out_bits.Resize(_outputs, _inputs);
+  _in_occ.resize(BitWords(_inputs), 0ULL);
+  _out_occ.resize(BitWords(_outputs), 0ULL);
+  // an input holds at most one request per output
   _in_req.resize(_inputs);
-  _out_req.resize(_outputs);
+  for(int i = 0; i < _inputs; ++i) {
+    _in_req[i].reserve(_outputs);
+  }
 }
 
 
 void SparseAllocator::Clear( )
 {
-  for ( int i = 0; i < _inputs; ++i ) {
-    if(!_in_req[i].empty())
-      _in_req[i].clear( );
+  int const in_words = _in_occ.size();
+  for ( int i = NextBit(&_in_occ[0], in_words, 0); i >= 0;
+	i = NextBit(&_in_occ[0], in_words, i + 1) ) {
+    _in_bits.ClearRow(i);
+    _in_req[i].clear( );
   }
+  _in_occ.assign(in_words, 0ULL);
 
-  for ( int j = 0; j < _outputs; ++j ) {
-    if(!_out_req[j].empty())
-      _out_req[j].clear( );
+  int const out_words = _out_occ.size();
+  for ( int j = NextBit(&_out_occ[0], out_words, 0); j >= 0;
+	j = NextBit(&_out_occ[0], out_words, j + 1) ) {
+    _out_bits.ClearRow(j);
   }
-
-  _in_occ.clear( );
-  _out_occ.clear( );
+  _out_occ.assign(out_words, 0ULL);
 
   Allocator::Clear();
 }
 
+SparseAllocator::sRequest const & SparseAllocator::_GetRequest( int in, int out ) const
+{
+  assert( _in_bits.Test(in, out) );
+  vector<sRequest> const & reqs = _in_req[in];
+  size_t r = 0;
+  while ( reqs[r].port != out ) {
+    ++r;
+  }
+  return reqs[r];
+}
+
 int SparseAllocator::ReadRequest( int in, int out ) const
 {
   sRequest r;
@@ -295,39 +304,27 @@ int SparseAllocator::ReadRequest( int in, int out ) const
 
 bool SparseAllocator::ReadRequest( sRequest &req, int in, int out ) const
 {
-  bool found;
-
   assert( ( in >= 0 ) && ( in < _inputs ) );
   assert( ( out >= 0 ) && ( out < _outputs ) );
 
-  map<int, sRequest>::const_iterator match = _in_req[in].find(out);
-  if ( match != _in_req[in].end( ) ) {
-    req = match->second;
-    found = true;
-  } else {
-    found = false;
+  if ( !_in_bits.Test(in, out) ) {
+    return false;
   }
-
-  return found;
+  req = _GetRequest(in, out);
+  return true;
 }
 
 void SparseAllocator::AddRequest( int in, int out, int label, 
 				  int in_pri, int out_pri )
 {
   Allocator::AddRequest(in, out, label, in_pri, out_pri);//_dirty变为true
-  assert( _in_req[in].count(out) == 0 );
-  assert( _out_req[out].count(in) == 0 );
+  assert( !_in_bits.Test(in, out) );
+  assert( !_out_bits.Test(out, in) );
 
-  // insert into occupied inputs set if
-  // input is currently empty
-  if ( _in_req[in].empty( ) ) {
-    _in_occ.insert(in);//输入信道in被占用
-  }
-
-  // similarly for the output
-  if ( _out_req[out].empty( ) ) {
-    _out_occ.insert(out);//输出信道out被占用
-  }
+  _in_bits.Set(in, out);
+  _out_bits.Set(out, in);
+  SetBit(&_in_occ[0], in);//输入信道in被占用
+  SetBit(&_out_occ[0], out);//输出信道out被占用
 
   sRequest req;
   req.port    = out;
@@ -335,11 +332,7 @@ void SparseAllocator::AddRequest( int in, int out, int label,
   req.in_pri  = in_pri;
   req.out_pri = out_pri;
 
-  _in_req[in][out] = req;
-
-  req.port  = in;
-
-  _out_req[out][in] = req;
+  _in_req[in].push_back(req);
 }
 
 void SparseAllocator::RemoveRequest( int in, int out, int label )
@@ -347,71 +340,70 @@ void SparseAllocator::RemoveRequest( int in, int out, int label )
   assert( ( in >= 0 ) && ( in < _inputs ) );
   assert( ( out >= 0 ) && ( out < _outputs ) ); 
   
-  assert( _in_req[in].count( out ) > 0 );
-  assert( _in_req[in][out].label == label );
-  _in_req[in].erase( out );
-
-  // remove from occupied inputs list if
-  // input is now empty
-  if ( _in_req[in].empty( ) ) {
-    _in_occ.erase(in);
+  vector<sRequest> & reqs = _in_req[in];
+  vector<sRequest>::iterator iter = reqs.begin( );
+  while ( ( iter != reqs.end( ) ) && ( iter->port != out ) ) {
+    ++iter;
   }
+  assert( iter != reqs.end( ) );
+  assert( iter->label == label );
+  reqs.erase( iter );
 
-  // similarly for the output
-  assert( _out_req[out].count( in ) > 0 );
-  assert( _out_req[out][in].label == label );
-  _out_req[out].erase( in );
+  _in_bits.Reset(in, out);
+  _out_bits.Reset(out, in);
 
-  if ( _out_req[out].empty( ) ) {
-    _out_occ.erase(out);
+  // remove from occupied inputs and outputs if they are now empty
+  if ( reqs.empty( ) ) {
+    ResetBit(&_in_occ[0], in);
+  }
+  if ( !_out_bits.Any(out) ) {
+    ResetBit(&_out_occ[0], out);
   }
 }
 
 bool SparseAllocator::InputHasRequests( int in ) const
 {
-  return _in_occ.count(in) > 0;
+  return TestBit(&_in_occ[0], in);
 }
 
 bool SparseAllocator::OutputHasRequests( int out ) const
 {
-  return _out_occ.count(out) > 0;
+  return TestBit(&_out_occ[0], out);
 }
 
 int SparseAllocator::NumInputRequests( int in ) const
 {
-  return _in_occ.count(in);
+  return _in_bits.Count(in);
 }
 
 int SparseAllocator::NumOutputRequests( int out ) const
 {
-  return _out_occ.count(out);
+  return _out_bits.Count(out);
 }
 
 void SparseAllocator::PrintRequests( ostream * os ) const
 {
-  map<int, sRequest>::const_iterator iter;
-  
   if(!os) os = &cout;
   
   *os << "Input requests = [ ";
   for ( int input = 0; input < _inputs; ++input ) {
-    if(!_in_req[input].empty()) {
+    if(_in_bits.Any(input)) {
       *os << input << " -> [ ";
-      for ( iter = _in_req[input].begin( ); 
-	    iter != _in_req[input].end( ); iter++ ) {
-	*os << iter->second.port << "@" << iter->second.in_pri << " ";
+      for ( int output = _in_bits.Next(input, 0); output >= 0;
+	    output = _in_bits.Next(input, output + 1) ) {
+	*os << output << "@" << _GetRequest(input, output).in_pri << " ";
       }
       *os << "]  ";
     }
   }
   *os << "], output requests = [ ";
   for ( int output = 0; output < _outputs; ++output ) {
-    if(!_out_req[output].empty()) {
+    if(_out_bits.Any(output)) {
       *os << output << " -> ";
       *os << "[ ";
-      for ( iter = _out_req[output].begin( ); 
-	    iter != _out_req[output].end( ); iter++ ) {
-	*os << iter->second.port << "@" << iter->second.out_pri << " ";
+      for ( int input = _out_bits.Next(output, 0); input >= 0;
+	    input = _out_bits.Next(output, input + 1) ) {
+	*os << input << "@" << _GetRequest(input, output).out_pri << " ";
       }
       *os << "]  ";
     }
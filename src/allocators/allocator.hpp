@@ -35,6 +35,9 @@
 
 #include "module.hpp"
 #include "config_utils.hpp"
+#include "bit_matrix.hpp"
+
+class Checkpoint;
 
 class Allocator : public Module {
 protected:
@@ -81,6 +84,9 @@ public:
   virtual void PrintRequests( ostream * os = NULL ) const = 0;
   void PrintGrants( ostream * os = NULL ) const;
 
+  // requests are cleared every cycle; only priority state persists
+  virtual void Serialize( Checkpoint & ckpt ) {}
+
   static Allocator *NewAllocator( Module *parent, const string& name,
 				  const string &alloc_type, 
 				  int inputs, int outputs, 
@@ -96,6 +102,10 @@ class DenseAllocator : public Allocator {
 protected:
   vector<vector<sRequest> > _request;
 
+  // which entries of _request are valid, by input and by output
+  BitMatrix _in_bits;
+  BitMatrix _out_bits;
+
 public:
   DenseAllocator( Module *parent, const string& name,
 		  int inputs, int outputs );
@@ -126,11 +136,17 @@ public:
 
 class SparseAllocator : public Allocator {
 protected:
-  set<int> _in_occ;
-  set<int> _out_occ;
-  
-  vector<map<int, sRequest> > _in_req;
-  vector<map<int, sRequest> > _out_req;
+  // requests by input and by output, plus the set of inputs and outputs
+  // that have any
+  BitMatrix _in_bits;
+  BitMatrix _out_bits;
+  vector<tBitWord> _in_occ;
+  vector<tBitWord> _out_occ;
+
+  // request details, listed per input in the order they were added
+  vector<vector<sRequest> > _in_req;
+
+  sRequest const & _GetRequest( int in, int out ) const;
 
 public:
   SparseAllocator( Module *parent, const string& name,
@@ -29,6 +29,7 @@
 #include <iostream>
 
 #include "islip.hpp"
+#include "checkpoint.hpp"
 #include "random_utils.hpp"
 
 //#define DEBUG_ISLIP
@@ -40,76 +41,56 @@ iSLIP_Sparse::iSLIP_Sparse( Module *parent, const string& name,
 {
   _gptrs.resize(_outputs, 0);
   _aptrs.resize(_inputs, 0);
+  _free_inputs.resize(BitWords(_inputs));
+  _candidates.resize(BitWords(_inputs));
+  _grants.Resize(_inputs, _outputs);
+  _granted.resize(BitWords(_inputs), 0ULL);
 }
 
 void iSLIP_Sparse::Allocate( )//修改grants的值，将output授权给input
 {
-  int input;
-  int output;
+  int const in_words = _free_inputs.size();
+  int const out_words = _out_occ.size();
 
-  int input_offset;
-  int output_offset;
-
-  map<int, sRequest>::iterator p;
-  bool wrapped;
+  _free_inputs.assign(in_words, 0ULL);
+  for ( int input = 0; input < _inputs; ++input ) {
+    if ( _inmatch[input] == -1 ) {
+      SetBit(&_free_inputs[0], input);
+    }
+  }
 
   for ( int iter = 0; iter < _iSLIP_iter; ++iter ) {
     // Grant phase
 
-    vector<int> grants(_outputs, -1);
-
-    for ( output = 0; output < _outputs; ++output ) {
+    for ( int output = NextBit(&_out_occ[0], out_words, 0); output >= 0;
+	  output = NextBit(&_out_occ[0], out_words, output + 1) ) {
 
-      // Skip loop if there are no requests
-      // or the output is already matched
-//_out_req[output]表示所有对该output的请求列表
-//第一个while找到请求列表中第一个满足input>=input_offset的请求，为方便描述，标记该请求为Q。
-//在第二个while中判断Q的input能否与output匹配，若不能匹配，遍历请求列表中Q之后的请求（不需要满足input>=input_offset），判断能否匹配；
-//若还是不能匹配，遍历Q之前的所有请求，显然这些请求也不满足	input>=input_offset，看能否匹配。
-//只要出现匹配，就把output授权给对应的input
-      if ( ( _out_req[output].empty( ) ) ||
-	   ( _outmatch[output] != -1 ) ) {//_outmach全部初始化为-1，只要_out_req不为空就不用continue
+      // Skip the output if it is already matched
+      if ( _outmatch[output] != -1 ) {
 	continue;
       }
 
-      // A round-robin arbiter between input requests
-      input_offset = _gptrs[output];//如果上一次有input请求output，那么这次的input_offset = input + 1。
-
-      p = _out_req[output].begin( );//p为该output对应的第一个request，可能有多个input请求这个output，上次分配给了input，这次分配给input + 1或大于（input + 1）的输入
-		while( ( p != _out_req[output].end( ) ) &&
-	     ( p->second.port < input_offset ) ) {
-	p++;
+      // A round-robin arbiter between requests from free inputs
+      tBitWord const * const req = _out_bits.Row(output);
+      for ( int w = 0; w < in_words; ++w ) {
+	_candidates[w] = req[w] & _free_inputs[w];
       }
+      int const input = RoundRobinBit(&_candidates[0], in_words, _gptrs[output]);
 
-      wrapped = false;
-      while( (!wrapped) || 
-	     ( ( p != _out_req[output].end( ) ) &&
-	       ( p->second.port < input_offset ) ) ) {
-	if ( p == _out_req[output].end( ) ) {//p由end回到begin就是wrapped
-	  if ( wrapped ) { break; }
-	  // p is valid here because empty lists
-	  // are skipped (above)
-	  p = _out_req[output].begin( );
-	  wrapped = true;
-	}
-
-	input = p->second.port;
-
-	// we know the output is free (above) and
-	// if the input is free, grant request
-	if ( _inmatch[input] == -1 ) {
-	  grants[output] = input;
-	  break;
-	}
-
-	p++;
-      }      
+      if ( input >= 0 ) {
+	_grants.Set(input, output);
+	SetBit(&_granted[0], input);
+      }
     }
 
 #ifdef DEBUG_ISLIP
     cout << "grants: ";
     for ( int i = 0; i < _outputs; ++i ) {
-      cout << grants[i] << " ";
+      int g = -1;
+      for ( int j = 0; j < _inputs; ++j ) {
+	if ( _grants.Test(j, i) ) g = j;
+      }
+      cout << g << " ";
     }
     cout << endl;
 
@@ -122,54 +103,25 @@ void iSLIP_Sparse::Allocate( )//修改grants的值，将output授权给input
 
     // Accept phase
 
-    for ( input = 0; input < _inputs; ++input ) {
-
-      if ( _in_req[input].empty( ) ) {
-	continue;
-      }
+    for ( int input = NextBit(&_granted[0], in_words, 0); input >= 0;
+	  input = NextBit(&_granted[0], in_words, input + 1) ) {
 
       // A round-robin arbiter between output grants
-      output_offset = _aptrs[input];
-
-      p = _in_req[input].begin( );
-      while( ( p != _in_req[input].end( ) ) &&
-	     ( p->second.port < output_offset ) ) {
-	p++;
+      int const output = _grants.RoundRobin(input, _aptrs[input]);
+      _grants.ClearRow(input);
+
+      // Accept
+      _inmatch[input]   = output;
+      _outmatch[output] = input;
+      ResetBit(&_free_inputs[0], input);
+
+      // Only update pointers if accepted during the 1st iteration
+      if ( iter == 0 ) {
+	_gptrs[output] = ( input + 1 ) % _inputs;
+	_aptrs[input]  = ( output + 1 ) % _outputs;
       }
-
-      wrapped = false;
-      while( (!wrapped) || 
-	     ( ( p != _in_req[input].end( ) ) &&
-	       ( p->second.port < output_offset ) ) ) {
-	if ( p == _in_req[input].end( ) ) {
-	  if ( wrapped ) { break; }
-	  // p is valid here because empty lists
-	  // are skipped (above)
-	  p = _in_req[input].begin( );
-	  wrapped = true;
-	}
-
-	output = p->second.port;
-
-	// we know the output is free (above) and
-	// if the input is free, grant request
-	if ( grants[output] == input ) {//前面已经将output授权给了某个input，现在只要找出这个input就可以完成匹配
-	  // Accept
-	  _inmatch[input]   = output;
-	  _outmatch[output] = input;
-
-	  // Only update pointers if accepted during the 1st iteration
-	  if ( iter == 0 ) {
-	    _gptrs[output] = ( input + 1 ) % _inputs;
-	    _aptrs[input]  = ( output + 1 ) % _outputs;
-	  }
-
-	  break;
-	}
-
-	p++;
-      } 
     }
+    _granted.assign(in_words, 0ULL);
   }
 
 #ifdef DEBUG_ISLIP
@@ -186,3 +138,9 @@ void iSLIP_Sparse::Allocate( )//修改grants的值，将output授权给input
   cout << endl;
 #endif
 }
+
+void iSLIP_Sparse::Serialize( Checkpoint & ckpt )
+{
+  ckpt.Sync( _gptrs );
+  ckpt.Sync( _aptrs );
+}
@@ -32,17 +32,25 @@
 
 #include "allocator.hpp"
 
-class iSLIP_Sparse : public SparseAllocator {
+class iSLIP_Sparse final : public SparseAllocator {
   int _iSLIP_iter;
 
   vector<int> _gptrs;
   vector<int> _aptrs;
 
+  // per-iteration scratch: inputs not yet matched, the requests an output
+  // may still grant, and the grants received by each input
+  vector<tBitWord> _free_inputs;
+  vector<tBitWord> _candidates;
+  BitMatrix _grants;
+  vector<tBitWord> _granted;
+
 public:
   iSLIP_Sparse( Module *parent, const string& name,
 		int inputs, int outputs, int iters );
 
   void Allocate( );
+  void Serialize( Checkpoint & ckpt );
 };
 
 #endif 
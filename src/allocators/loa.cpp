@@ -29,6 +29,7 @@
 #include <iostream>
 
 #include "loa.hpp"
+#include "checkpoint.hpp"
 #include "random_utils.hpp"
 
 LOA::LOA( Module *parent, const string& name,
@@ -109,4 +110,8 @@ void LOA::Allocate( )
 
 }
 
-
+void LOA::Serialize( Checkpoint & ckpt )
+{
+  ckpt.Sync( _rptr );
+  ckpt.Sync( _gptr );
+}
@@ -44,6 +44,7 @@ public:
        int inputs, int outputs );
 
   void Allocate( );
+  void Serialize( Checkpoint & ckpt );
 };
 
 #endif
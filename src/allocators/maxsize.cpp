@@ -33,6 +33,7 @@
 #include <iostream>
 
 #include "maxsize.hpp"
+#include "checkpoint.hpp"
 
 // shortest augmenting path:
 //
@@ -40,30 +41,29 @@
 //    push node onto work stack
 // end
 //
-// for all j,
-//   from[j] = undefined
-// end
+// visited = {}
 //
 // do,
 //
 //   while( !stack.empty ),
 //     
 //     nl = stack.pop
-//     for each edge (nl,j),
-//       if ( ( lmatch[nl] != j ) && ( from[j] == undefined ) ),
-//         if ( rmatch[j] == undefined ),
-//           stop // augmenting path found
-//         else
-//           from[j] = nl
-//           newstack.push( rmatch[j] ) 
-//         end
-//       end
+//     next = edges(nl) - visited - { lmatch[nl] }
+//     if ( next contains unmatched right nodes ),
+//       stop // augmenting path found, ends at the lowest one
+//     end
+//     for each j in next,
+//       from[j] = nl
+//       newstack.push( rmatch[j] ) 
 //     end
+//     visited = visited + next
 //   end
 //
 //   stack = newstack
 // end
 //
+// The sets are bit vectors over the right nodes, so each left node is
+// expanded with a few word operations.
 
 //#define DEBUG_MAXSIZE
 //#define PRINT_MATCHING
@@ -76,6 +76,13 @@ MaxSizeMatch::MaxSizeMatch( Module *parent, const string& name,
   _s    = new int [inputs];
   _ns   = new int [inputs];
   _prio = 0;
+
+  int const words = BitWords(outputs);
+  _all_out.resize(words, 0ULL);
+  for ( int j = 0; j < outputs; ++j ) {
+    SetBit(&_all_out[0], j);
+  }
+  _visited.resize(words, 0ULL);
 }
 
 MaxSizeMatch::~MaxSizeMatch( )
@@ -86,9 +93,32 @@ MaxSizeMatch::~MaxSizeMatch( )
 
 void MaxSizeMatch::Allocate( )
 {
+  int const words = _all_out.size();
+  _free_out = _all_out;
+
+  // While some unmatched input requests an unmatched output, the first
+  // such input in priority order, with its lowest such output, is the
+  // (length one) path that the search below finds first. Take all of
+  // these in a single pass before looking for longer paths.
+  for ( int k = 0; k < _inputs; ++k ) {
+    int const i = (k + _prio) % _inputs;
+    if ( _inmatch[i] != -1 ) {
+      continue;
+    }
+    tBitWord const * const row = _in_bits.Row(i);
+    for ( int w = 0; w < words; ++w ) {
+      tBitWord const free = row[w] & _free_out[w];
+      if ( free ) {
+	int const j = (w << 6) + __builtin_ctzll(free);
+	_inmatch[i] = j;
+	_outmatch[j] = i;
+	ResetBit(&_free_out[0], j);
+	break;
+      }
+    }
+  }
 
   // augment as many times as possible 
-  // (this is an O(N^3) maximum-size matching algorithm)
   while( _ShortestAugmenting( ) );
 
   // next time, start at next input to ensure fairness
@@ -101,6 +131,8 @@ bool MaxSizeMatch::_ShortestAugmenting( )
   int i, j, jn;
   int slen, nslen;
 
+  int const words = _free_out.size();
+
   // start with empty stack
   slen = 0;
 
@@ -112,34 +144,45 @@ bool MaxSizeMatch::_ShortestAugmenting( )
     }
   }
 
-  _from.assign(_inputs, -1);
+  _visited.assign(words, 0ULL);
 
-  for ( int iter = 0; iter < _inputs; iter++ ) {
+  while ( slen > 0 ) {
     nslen = 0;
 
     for ( int e = 0; e < slen; ++e ) {
       i = _s[e];
+      tBitWord const * const row = _in_bits.Row(i);
       
-      for ( j = 0; j < _outputs; ++j ) {
-	if ( ( _request[i][j].label != -1 ) && // edge (i,j) exists
-	     ( _inmatch[i] != j ) &&     // (i,j) is not contained in the current matching
-	     ( _from[j] == -1 ) ) {      // no shorter path to j exists
-	  
-	  _from[j] = i;                  // how did we get to j?
+      for ( int w = 0; w < words; ++w ) {
+	// edges (i,j) that exist, are not contained in the current
+	// matching, and lead to a j no shorter path reaches
+	tBitWord next = row[w] & ~_visited[w];
+	if ( ( _inmatch[i] != -1 ) && ( ( _inmatch[i] >> 6 ) == w ) ) {
+	  next &= ~( 1ULL << ( _inmatch[i] & 63 ) );
+	}
+	if ( !next ) {
+	  continue;
+	}
+
+	tBitWord const free = next & _free_out[w];
+	if ( free ) {                   // j is unmatched -- augmenting path found
+	  j = (w << 6) + __builtin_ctzll(free);
+	  _from[j] = i;
+	  goto found_augmenting;
+	}
+
+	_visited[w] |= next;
+	while ( next ) {                // j is matched
+	  j = (w << 6) + __builtin_ctzll(next);
+	  next &= next - 1;
+	  _from[j] = i;                 // how did we get to j?
+	  _ns[nslen] = _outmatch[j];    // add the destination of this edge to the leaf nodes
+	  nslen++;
 
 #ifdef DEBUG_MAXSIZE
 	  cout << "  got to " << j << " from " << i << endl;
+	  cout << "  adding " << _outmatch[j] << endl;
 #endif
-	  if ( _outmatch[j] == -1 ) {   // j is unmatched -- augmenting path found
-	    goto found_augmenting;
-	  } else {                      // j is matched
-	    _ns[nslen] = _outmatch[j];  // add the destination of this edge to the leaf nodes
-	    nslen++;
-	    
-#ifdef DEBUG_MAXSIZE
-	    cout << "  adding " << _outmatch[j] << endl;
-#endif
-	  }
 	}
       }
     }
@@ -161,6 +204,8 @@ bool MaxSizeMatch::_ShortestAugmenting( )
   cout << "Found path: " << j << "c <- ";
 #endif
 
+  ResetBit(&_free_out[0], j);
+
   i = _from[j];
   _outmatch[j] = i;
 
@@ -208,3 +253,8 @@ bool MaxSizeMatch::_ShortestAugmenting( )
 
   return true;
 }
+
+void MaxSizeMatch::Serialize( Checkpoint & ckpt )
+{
+  ckpt.Sync( _prio );
+}
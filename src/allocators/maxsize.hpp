@@ -37,6 +37,10 @@ class MaxSizeMatch : public DenseAllocator {
   int *_s;      // stack of leaf nodes in tree
   int *_ns;     // next stack
   int _prio;    // priority pointer to ensure fairness
+
+  vector<tBitWord> _all_out;   // every output
+  vector<tBitWord> _free_out;  // outputs not matched yet
+  vector<tBitWord> _visited;   // outputs reached by the breadth-first tree
  
   bool _ShortestAugmenting( );
 
@@ -46,6 +50,7 @@ public:
   ~MaxSizeMatch( );
   
   void Allocate( );
+  void Serialize( Checkpoint & ckpt );
 };
 
 #endif 
@@ -38,6 +38,9 @@ PIM::PIM( Module *parent, const string& name,
   DenseAllocator( parent, name, inputs, outputs ),
   _PIM_iter(iters)
 {
+  _free_inputs.resize(BitWords(_inputs));
+  _candidates.resize(BitWords(_inputs));
+  _grants.Resize(_inputs, _outputs);
 }
 
 PIM::~PIM( )
@@ -46,56 +49,56 @@ PIM::~PIM( )
 
 void PIM::Allocate( )
 {
-  int input;
-  int output;
+  int const in_words = _free_inputs.size();
 
-  int input_offset;
-  int output_offset;
+  _free_inputs.assign(in_words, 0ULL);
+  for ( int input = 0; input < _inputs; ++input ) {
+    if ( _inmatch[input] == -1 ) {
+      SetBit(&_free_inputs[0], input);
+    }
+  }
 
   for ( int iter = 0; iter < _PIM_iter; ++iter ) {
     // Grant phase --- outputs randomly choose
     // between one of their requests
 
-    vector<int> grants(_outputs, -1);
-
-    for ( output = 0; output < _outputs; ++output ) {
+    for ( int output = 0; output < _outputs; ++output ) {
       
       // A random arbiter between input requests
-      input_offset  = RandomInt( _inputs - 1 );
-      
-      for ( int i = 0; i < _inputs; ++i ) {
-	input = ( i + input_offset ) % _inputs;  
-	
-	if ( ( _request[input][output].label != -1 ) && 
-	     ( _inmatch[input] == -1 ) &&
-	     ( _outmatch[output] == -1 ) ) {
-	  
-	  // Grant
-	  grants[output] = input;
-	  break;
-	}
+      int const input_offset  = RandomInt( _inputs - 1 );
+
+      if ( _outmatch[output] != -1 ) {
+	continue;
+      }
+
+      tBitWord const * const req = _out_bits.Row(output);
+      for ( int w = 0; w < in_words; ++w ) {
+	_candidates[w] = req[w] & _free_inputs[w];
+      }
+      int const input = RoundRobinBit(&_candidates[0], in_words, input_offset);
+
+      if ( input >= 0 ) {
+	// Grant
+	_grants.Set(input, output);
       }
     }
   
     // Accept phase -- inputs randomly choose
     // between input_speedup of their grants
     
-    for ( input = 0; input < _inputs; ++input ) {
+    for ( int input = 0; input < _inputs; ++input ) {
       
       // A random arbiter between output grants
-      output_offset  = RandomInt( _outputs - 1 );
-      
-      for ( int o = 0; o < _outputs; ++o ) {
-	output = ( o + output_offset ) % _outputs;
-	
-	if ( grants[output] == input ) {
-	  
-	  // Accept
-	  _inmatch[input]   = output;
-	  _outmatch[output] = input;
-	  
-	  break;
-	}
+      int const output_offset  = RandomInt( _outputs - 1 );
+
+      int const output = _grants.RoundRobin(input, output_offset);
+
+      if ( output >= 0 ) {
+	// Accept
+	_inmatch[input]   = output;
+	_outmatch[output] = input;
+	ResetBit(&_free_inputs[0], input);
+	_grants.ClearRow(input);
       }
     }
   }
@@ -35,6 +35,11 @@
 class PIM : public DenseAllocator {
   int _PIM_iter;
 
+  // per-iteration scratch, as in iSLIP_Sparse
+  vector<tBitWord> _free_inputs;
+  vector<tBitWord> _candidates;
+  BitMatrix _grants;
+
 public:
   PIM( Module *parent, const string& name,
        int inputs, int outputs, int iters );
@@ -29,6 +29,7 @@
 #include <iostream>
 
 #include "selalloc.hpp"
+#include "checkpoint.hpp"
 #include "random_utils.hpp"
 
 //#define DEBUG_SELALLOC
@@ -42,6 +43,7 @@ SelAlloc::SelAlloc( Module *parent, const string& name,
   _gptrs.resize(outputs, 0);
   _aptrs.resize(inputs, 0);
   _outmask.resize(outputs, 0);
+  _grants.resize(outputs, -1);
 }
 
 void SelAlloc::Allocate( )
@@ -52,78 +54,63 @@ void SelAlloc::Allocate( )
   int input_offset;
   int output_offset;
 
-  map<int, sRequest>::iterator p;
-  set<int>::iterator outer_iter;
-  bool wrapped;
+  int const in_words = _in_occ.size();
+  int const out_words = _out_occ.size();
 
   int max_index;
   int max_pri;
 
-  vector<int> grants(_outputs, -1);
+  _grants.assign(_outputs, -1);
 
   for ( int iter = 0; iter < _iter; ++iter ) {
     // Grant phase
 
-    for( outer_iter = _out_occ.begin( ); 
-	 outer_iter != _out_occ.end( ); ++outer_iter ) {
-      output = *outer_iter;
+    for( output = NextBit(&_out_occ[0], out_words, 0); output >= 0;
+	 output = NextBit(&_out_occ[0], out_words, output + 1) ) {
 
-      // Skip loop if there are no requests
-      // or the output is already matched or
+      // Skip loop if the output is already matched or
       // the output is masked
-      if ( ( _out_req[output].empty( ) ) ||
-	   ( _outmatch[output] != -1 ) ||
+      if ( ( _outmatch[output] != -1 ) ||
 	   ( _outmask[output] != 0 ) ) {
 	continue;
       }
 
-      // A round-robin arbiter between input requests
+      // A round-robin arbiter between input requests: visit the
+      // requesting inputs from the pointer onwards, then wrap around
       input_offset = _gptrs[output];
 
-      p = _out_req[output].begin( );
-      while( ( p != _out_req[output].end( ) ) &&
-	     ( p->second.port < input_offset ) ) {
-	p++;
-      }
-
       max_index = -1;
       max_pri   = 0;
 
-      wrapped = false;
-      while( (!wrapped) || 
-	     ( ( p != _out_req[output].end() ) && 
-	       ( p->second.port < input_offset ) ) ) {
-	if ( p == _out_req[output].end( ) ) {
-	  if ( wrapped ) { break; }
-	  // p is valid here because empty lists
-	  // are skipped (above)
-	  p = _out_req[output].begin( );
-	  wrapped = true;
-	}
-
-	input = p->second.port;
-
-	// we know the output is free (above) and
-	// if the input is free, check if request is the
-	// highest priority so far
-	if ( ( _inmatch[input] == -1 ) &&
-	     ( ( p->second.out_pri > max_pri ) || ( max_index == -1 ) ) ) {
-	  max_pri   = p->second.out_pri;
-	  max_index = input;
+      for ( int pass = 0; pass < 2; ++pass ) {
+	int const begin = pass ? 0 : input_offset;
+	int const end = pass ? input_offset : _inputs;
+	for ( input = _out_bits.Next(output, begin); 
+	      ( input >= 0 ) && ( input < end );
+	      input = _out_bits.Next(output, input + 1) ) {
+
+	  // we know the output is free (above) and
+	  // if the input is free, check if request is the
+	  // highest priority so far
+	  if ( _inmatch[input] == -1 ) {
+	    int const pri = _GetRequest(input, output).out_pri;
+	    if ( ( pri > max_pri ) || ( max_index == -1 ) ) {
+	      max_pri   = pri;
+	      max_index = input;
+	    }
+	  }
 	}
-
-	p++;
-      }   
+      }
 
       if ( max_index != -1 ) { // grant
-	grants[output] = max_index;
+	_grants[output] = max_index;
       }
     }
 
 #ifdef DEBUG_SELALLOC
     cout << "grants: ";
     for ( int i = 0; i < _outputs; ++i ) {
-      cout << grants[i] << " ";
+      cout << _grants[i] << " ";
     }
     cout << endl;
 
@@ -136,52 +123,34 @@ void SelAlloc::Allocate( )
 
     // Accept phase
 
-    for ( outer_iter = _in_occ.begin( ); 
-	  outer_iter != _in_occ.end( ); ++outer_iter ) {
-      input = *outer_iter;
-
-      if ( _in_req[input].empty( ) ) {
-	continue;
-      }
+    for ( input = NextBit(&_in_occ[0], in_words, 0); input >= 0;
+	  input = NextBit(&_in_occ[0], in_words, input + 1) ) {
 
       // A round-robin arbiter between output grants
       output_offset = _aptrs[input];
 
-      p = _in_req[input].begin( );
-      while( ( p != _in_req[input].end( ) ) &&
-	     ( p->second.port < output_offset ) ) {
-	p++;
-      }
-
       max_index = -1;
       max_pri   = 0;
 
-      wrapped = false;
-      while( (!wrapped) || 
-	     ( ( p != _in_req[input].end() ) && 
-	       ( p->second.port < output_offset ) ) ) {
-	if ( p == _in_req[input].end( ) ) {
-	  if ( wrapped ) { break; }
-	  // p is valid here because empty lists
-	  // are skipped (above)
-	  p = _in_req[input].begin( );
-	  wrapped = true;
-	}
-
-	output = p->second.port;
-
-	// we know the output is free (above) and
-	// if the input is free, check if the highest
-	// priroity
-	if ( ( grants[output] == input ) && 
-	     ( !_out_req[output].empty( ) ) &&
-	     ( ( p->second.in_pri > max_pri ) || ( max_index == -1 ) ) ) {
-	  max_pri   = p->second.in_pri;
-	  max_index = output;
+      for ( int pass = 0; pass < 2; ++pass ) {
+	int const begin = pass ? 0 : output_offset;
+	int const end = pass ? output_offset : _outputs;
+	for ( output = _in_bits.Next(input, begin); 
+	      ( output >= 0 ) && ( output < end );
+	      output = _in_bits.Next(input, output + 1) ) {
+
+	  // we know the output is free (above) and
+	  // if the input is free, check if the highest
+	  // priroity
+	  if ( _grants[output] == input ) {
+	    int const pri = _GetRequest(input, output).in_pri;
+	    if ( ( pri > max_pri ) || ( max_index == -1 ) ) {
+	      max_pri   = pri;
+	      max_index = output;
+	    }
+	  }
 	}
-
-	p++;
-      } 
+      }
 
       if ( max_index != -1 ) {
 	// Accept
@@ -222,16 +191,14 @@ void SelAlloc::MaskOutput( int out, int mask )
 
 void SelAlloc::PrintRequests( ostream * os ) const
 {
-  map<int, sRequest>::const_iterator iter;
-  
   if(!os) os = &cout;
   
   *os << "Input requests = [ ";
   for ( int input = 0; input < _inputs; ++input ) {
     *os << input << " -> [ ";
-    for ( iter = _in_req[input].begin( ); 
-	  iter != _in_req[input].end( ); iter++ ) {
-      *os << iter->second.port << " ";
+    for ( int output = _in_bits.Next(input, 0); output >= 0;
+	  output = _in_bits.Next(input, output + 1) ) {
+      *os << output << " ";
     }
     *os << "]  ";
   }
@@ -240,9 +207,9 @@ void SelAlloc::PrintRequests( ostream * os ) const
     *os << output << " -> ";
     if ( _outmask[output] == 0 ) {
       *os << "[ ";
-      for ( iter = _out_req[output].begin( ); 
-	    iter != _out_req[output].end( ); iter++ ) {
-	*os << iter->second.port << " ";
+      for ( int input = _out_bits.Next(output, 0); input >= 0;
+	    input = _out_bits.Next(output, input + 1) ) {
+	*os << input << " ";
       }
       *os << "]  ";
     } else {
@@ -252,3 +219,9 @@ void SelAlloc::PrintRequests( ostream * os ) const
   *os << "]." << endl;
 }
 
+void SelAlloc::Serialize( Checkpoint & ckpt )
+{
+  ckpt.Sync( _aptrs );
+  ckpt.Sync( _gptrs );
+  ckpt.Sync( _outmask );
+}
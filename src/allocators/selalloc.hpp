@@ -40,11 +40,14 @@ class SelAlloc : public SparseAllocator {
 
   vector<int> _outmask;
 
+  vector<int> _grants;
+
 public:
   SelAlloc( Module *parent, const string& name,
 	    int inputs, int outputs, int iters );
 
   void Allocate( );
+  void Serialize( Checkpoint & ckpt );
 
   void MaskOutput( int out, int mask = 1 );
 
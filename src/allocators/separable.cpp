@@ -84,3 +84,12 @@ void SeparableAllocator::Clear() {
   }
   SparseAllocator::Clear();
 }
+
+void SeparableAllocator::Serialize( Checkpoint & ckpt ) {
+  for ( int i = 0 ; i < _inputs ; ++i ) {
+    _input_arb[i]->Serialize( ckpt ) ;
+  }
+  for ( int o = 0 ; o < _outputs ; ++o ) {
+    _output_arb[o]->Serialize( ckpt ) ;
+  }
+}
@@ -48,21 +48,20 @@ SeparableInputFirstAllocator( Module* parent, const string& name, int inputs,
 
 void SeparableInputFirstAllocator::Allocate() {
   
-  set<int>::const_iterator port_iter = _in_occ.begin();
-  while(port_iter != _in_occ.end()) {
-    
-    const int & input = *port_iter;
+  int const in_words = _in_occ.size();
+  int const out_words = _out_occ.size();
 
+  for(int input = NextBit(&_in_occ[0], in_words, 0); input >= 0;
+      input = NextBit(&_in_occ[0], in_words, input + 1)) {
+    
     // add requests to the input arbiter
 
-    map<int, sRequest>::const_iterator req_iter = _in_req[input].begin();
-    while(req_iter != _in_req[input].end()) {
+    for(int output = _in_bits.Next(input, 0); output >= 0;
+	output = _in_bits.Next(input, output + 1)) {
 
-      const sRequest & req = req_iter->second;
+      const sRequest & req = _GetRequest(input, output);
       
       _input_arb[input]->AddRequest(req.port, req.label, req.in_pri);
-
-      ++req_iter;
     }
 
     // Execute the input arbiters and propagate the grants to the
@@ -72,18 +71,14 @@ void SeparableInputFirstAllocator::Allocate() {
     const int output = _input_arb[input]->Arbitrate(&label, NULL);
     assert(output > -1);
 
-    const sRequest & req = _out_req[output][input]; 
-    assert((req.port == input) && (req.label == label));
+    const sRequest & req = _GetRequest(input, output); 
+    assert((req.port == output) && (req.label == label));
 
-    _output_arb[output]->AddRequest(req.port, req.label, req.out_pri);
-
-    ++port_iter;
+    _output_arb[output]->AddRequest(input, req.label, req.out_pri);
   }
 
-  port_iter = _out_occ.begin();
-  while(port_iter != _out_occ.end()) {
-
-    const int & output = *port_iter;
+  for(int output = NextBit(&_out_occ[0], out_words, 0); output >= 0;
+      output = NextBit(&_out_occ[0], out_words, output + 1)) {
 
     // Execute the output arbiters.
     
@@ -97,7 +92,5 @@ void SeparableInputFirstAllocator::Allocate() {
       _input_arb[input]->UpdateState() ;
       _output_arb[output]->UpdateState() ;
     }
-
-    ++port_iter;
   }
 }
@@ -48,21 +48,20 @@ SeparableOutputFirstAllocator( Module* parent, const string& name, int inputs,
 
 void SeparableOutputFirstAllocator::Allocate() {
   
-  set<int>::const_iterator port_iter = _out_occ.begin();
-  while(port_iter != _out_occ.end()) {
-    
-    const int & output = *port_iter;
+  int const in_words = _in_occ.size();
+  int const out_words = _out_occ.size();
 
+  for(int output = NextBit(&_out_occ[0], out_words, 0); output >= 0;
+      output = NextBit(&_out_occ[0], out_words, output + 1)) {
+    
     // add requests to the output arbiter
 
-    map<int, sRequest>::const_iterator req_iter = _out_req[output].begin();
-    while(req_iter != _out_req[output].end()) {
+    for(int input = _out_bits.Next(output, 0); input >= 0;
+	input = _out_bits.Next(output, input + 1)) {
       
-      const sRequest & req = req_iter->second;
-
-      _output_arb[output]->AddRequest(req.port, req.label, req.out_pri);
+      const sRequest & req = _GetRequest(input, output);
 
-      ++req_iter;
+      _output_arb[output]->AddRequest(input, req.label, req.out_pri);
     }
     
     // Execute the output arbiter and propagate the grants to the
@@ -72,19 +71,15 @@ void SeparableOutputFirstAllocator::Allocate() {
     const int input = _output_arb[output]->Arbitrate(&label, NULL);
     assert(input > -1);
 
-    const sRequest & req = _in_req[input][output];
+    const sRequest & req = _GetRequest(input, output);
     assert((req.port == output) && (req.label == label));
 
     _input_arb[input]->AddRequest(req.port, req.label, req.in_pri);
-
-    ++port_iter;
   }
   
-  port_iter = _in_occ.begin();
-  while(port_iter != _in_occ.end()) {
+  for(int input = NextBit(&_in_occ[0], in_words, 0); input >= 0;
+      input = NextBit(&_in_occ[0], in_words, input + 1)) {
     
-    const int & input = *port_iter;
-
     // Execute the input arbiters.
     
     const int output = _input_arb[input]->Arbitrate(NULL, NULL);
@@ -97,7 +92,5 @@ void SeparableOutputFirstAllocator::Allocate() {
       _input_arb[input]->UpdateState() ;
       _output_arb[output]->UpdateState() ;
     }
-    
-    ++port_iter;
   }
 }
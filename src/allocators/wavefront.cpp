@@ -32,7 +32,11 @@
  */
 #include "booksim.hpp"
 
+#include <algorithm>
+#include <functional>
+
 #include "wavefront.hpp"
+#include "checkpoint.hpp"
 
 Wavefront::Wavefront( Module *parent, const string& name,
 		      int inputs, int outputs, bool skip_diags ) :
@@ -40,6 +44,17 @@ Wavefront::Wavefront( Module *parent, const string& name,
   _last_in(-1), _last_out(-1), _skip_diags(skip_diags), 
   _square(max(inputs, outputs)), _pri(0), _num_requests(0)
 {
+  int const words = BitWords(_square);
+  _diags.Resize(_square, _square);
+  _all_in.resize(words, 0ULL);
+  for ( int input = 0; input < _inputs; ++input ) {
+    SetBit(&_all_in[0], ( _square - input ) % _square);
+  }
+  _all_out.resize(words, 0ULL);
+  for ( int output = 0; output < _outputs; ++output ) {
+    SetBit(&_all_out[0], output);
+  }
+  _free_in_diag.resize(words, 0ULL);
 }
 
 void Wavefront::AddRequest( int in, int out, int label, 
@@ -49,7 +64,36 @@ void Wavefront::AddRequest( int in, int out, int label,
   _num_requests++;
   _last_in = in;
   _last_out = out;
-  _priorities.insert(make_pair(out_pri, in_pri));
+}
+
+// Rotates the free inputs left by d positions within _square bits, so that
+// bit o of the result is set if input (d - o) mod _square is free.
+void Wavefront::_RotateFreeInputs( int d )
+{
+  int const words = _free_in.size();
+  int const up = d;
+  int const down = _square - d;
+  for ( int w = 0; w < words; ++w ) {
+    tBitWord left = 0ULL;
+    int const lw = w - ( up >> 6 );
+    int const lb = up & 63;
+    if ( lw >= 0 ) {
+      left = _free_in[lw] << lb;
+      if ( lb && ( lw > 0 ) ) {
+	left |= _free_in[lw - 1] >> ( 64 - lb );
+      }
+    }
+    tBitWord right = 0ULL;
+    int const rw = w + ( down >> 6 );
+    int const rb = down & 63;
+    if ( rw < words ) {
+      right = _free_in[rw] >> rb;
+      if ( rb && ( rw + 1 < words ) ) {
+	right |= _free_in[rw + 1] << ( 64 - rb );
+      }
+    }
+    _free_in_diag[w] = ( left | right ) & _all_out[w];
+  }
 }
 
 void Wavefront::Allocate( )
@@ -71,28 +115,64 @@ void Wavefront::Allocate( )
 
   } else {
 
-    // otherwise we have to loop through the diagonals of request matrix
+    // otherwise we have to loop through the diagonals of request matrix,
+    // one priority class at a time from the highest. A diagonal holds
+    // each input and output at most once, so all of its requests whose
+    // input and output are still free can be granted at once.
+
+    _classes.clear();
+    for ( int input = 0; input < _inputs; ++input ) {
+      for ( int output = _in_bits.Next(input, 0); output >= 0;
+	    output = _in_bits.Next(input, output + 1) ) {
+	sRequest const & req = _request[input][output];
+	pair<int, int> const pri(req.out_pri, req.in_pri);
+	if ( find(_classes.begin(), _classes.end(), pri) == _classes.end() ) {
+	  _classes.push_back(pri);
+	}
+      }
+    }
+    sort(_classes.begin(), _classes.end(), greater<pair<int, int> >());
+
+    _free_in = _all_in;
+    _free_out = _all_out;
+    int const words = _free_out.size();
+
+    for ( size_t c = 0; c < _classes.size(); ++c ) {
+
+      for ( int input = 0; input < _inputs; ++input ) {
+	for ( int output = _in_bits.Next(input, 0); output >= 0;
+	      output = _in_bits.Next(input, output + 1) ) {
+	  sRequest const & req = _request[input][output];
+	  if ( ( req.out_pri == _classes[c].first ) &&
+	       ( req.in_pri == _classes[c].second ) ) {
+	    _diags.Set(( input + output ) % _square, output);
+	  }
+	}
+      }
 
-    for(set<pair<int, int> >::const_reverse_iterator iter = 
-	  _priorities.rbegin();
-	iter != _priorities.rend(); ++iter) {
-      
       for ( int p = 0; p < _square; ++p ) {
-	for ( int output = 0; output < _square; ++output ) {
-	  int input = ( ( _pri + p ) + ( _square - output ) ) % _square;
-	  if ( ( input < _inputs ) && ( output < _outputs ) && 
-	       ( _inmatch[input] == -1 ) && ( _outmatch[output] == -1 ) &&
-	       ( _request[input][output].label != -1 ) &&
-	       ( _request[input][output].in_pri == iter->second ) &&
-	       ( _request[input][output].out_pri == iter->first ) ) {
-	    // Grant!
-	    _inmatch[input] = output;
-	    _outmatch[output] = input;
-	    if(first_diag < 0) {
-	      first_diag = input + output;
-	    }
+	int const d = ( _pri + p ) % _square;
+	tBitWord * const grants = _diags.Row(d);
+	if ( !AnyBit(grants, words) ) {
+	  continue;
+	}
+	_RotateFreeInputs(d);
+	for ( int w = 0; w < words; ++w ) {
+	  grants[w] &= _free_out[w] & _free_in_diag[w];
+	}
+	for ( int output = NextBit(grants, words, 0); output >= 0;
+	      output = NextBit(grants, words, output + 1) ) {
+	  int const input = ( d - output + _square ) % _square;
+	  // Grant!
+	  _inmatch[input] = output;
+	  _outmatch[output] = input;
+	  ResetBit(&_free_in[0], ( _square - input ) % _square);
+	  ResetBit(&_free_out[0], output);
+	  if(first_diag < 0) {
+	    first_diag = input + output;
 	  }
 	}
+	_diags.ClearRow(d);
       }
     }
   }
@@ -100,7 +180,6 @@ void Wavefront::Allocate( )
   _num_requests = 0;
   _last_in = -1;
   _last_out = -1;
-  _priorities.clear();
   
   assert(first_diag >= 0);
 
@@ -108,4 +187,7 @@ void Wavefront::Allocate( )
   _pri = ( ( _skip_diags ? first_diag : _pri ) + 1 ) % _square;
 }
 
-
+void Wavefront::Serialize( Checkpoint & ckpt )
+{
+  ckpt.Sync( _pri );
+}
@@ -28,7 +28,7 @@
 #ifndef _WAVEFRONT_HPP_
 #define _WAVEFRONT_HPP_
 
-#include <set>
+#include <vector>
 
 #include "allocator.hpp"
 
@@ -37,9 +37,24 @@ class Wavefront : public DenseAllocator {
 private:
   int _last_in;
   int _last_out;
-  set<pair<int, int> > _priorities;
   bool _skip_diags;
 
+  // Allocate() works on one diagonal of the (square) request matrix at a
+  // time: row d of _diags holds, by output, the requests of the current
+  // priority class on diagonal d, i.e. those with input + output = d
+  // (mod _square). Free inputs are indexed by (_square - input) % _square
+  // so that rotating them by d lines them up with the outputs of that
+  // diagonal.
+  BitMatrix _diags;
+  vector<tBitWord> _all_in;
+  vector<tBitWord> _all_out;
+  vector<tBitWord> _free_in;
+  vector<tBitWord> _free_out;
+  vector<tBitWord> _free_in_diag;
+  vector<pair<int, int> > _classes;
+
+  void _RotateFreeInputs( int d );
+
 protected:
   int _square;
   int _pri;
@@ -52,6 +67,7 @@ public:
   virtual void AddRequest( int in, int out, int label = 1, 
 			   int in_pri = 0, int out_pri = 0 );
   virtual void Allocate( );
+  virtual void Serialize( Checkpoint & ckpt );
 };
 
 #endif
@@ -43,23 +43,32 @@ using namespace std ;
 
 Arbiter::Arbiter( Module *parent, const string &name, int size )
   : Module( parent, name ),
-    _size(size), _selected(-1), _highest_pri(numeric_limits<int>::min()),
-    _best_input(-1), _num_reqs(0)
+    _size(size), _words(BitWords(size)), _selected(-1),
+    _highest_pri(numeric_limits<int>::min()), _num_reqs(0)
 {
   _request.resize(size);
-  for ( int i = 0 ; i < size ; i++ ) 
-    _request[i].valid = false ;
+  _valid.resize(_words, 0ULL);
+  _top.resize(_words, 0ULL);
 }
 
 void Arbiter::AddRequest( int input, int id, int pri )
 {
   assert( 0 <= input && input < _size ) ;
-  assert( !_request[input].valid );
+  assert( !TestBit(&_valid[0], input) );
 
   _num_reqs++ ;
-  _request[input].valid = true ;
+  SetBit(&_valid[0], input);
   _request[input].id = id ;
   _request[input].pri = pri ;
+
+  // group requests by priority: only the highest class can win
+  if ( pri > _highest_pri ) {
+    for ( int w = 0 ; w < _words ; w++ )
+      _top[w] = 0ULL ;
+    _highest_pri = pri ;
+  }
+  if ( pri == _highest_pri )
+    SetBit(&_top[0], input);
 }
 
 int Arbiter::Arbitrate( int* id, int* pri )
@@ -81,10 +90,13 @@ void Arbiter::Clear()
   if(_num_reqs > 0) {
     
     // clear the request vector
-    for ( int i = 0; i < _size ; i++ )
-      _request[i].valid = false ;
+    for ( int w = 0; w < _words ; w++ ) {
+      _valid[w] = 0ULL ;
+      _top[w] = 0ULL ;
+    }
     _num_reqs = 0 ;
     _selected = -1;
+    _highest_pri = numeric_limits<int>::min();
   }
 }
 
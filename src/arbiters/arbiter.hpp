@@ -37,13 +37,15 @@
 #include <vector>
 
 #include "module.hpp"
+#include "bit_matrix.hpp"
+
+class Checkpoint;
 
 class Arbiter : public Module {
 
 protected:
 
   typedef struct { 
-    bool valid ;
     int id ;
     int pri ;
   } entry_t ;
@@ -51,9 +53,14 @@ protected:
   vector<entry_t> _request ;
   int  _size ;
 
+  // inputs with a valid request, and the subset of them whose request
+  // has the highest priority seen so far (_highest_pri)
+  vector<tBitWord> _valid ;
+  vector<tBitWord> _top ;
+  int _words ;
+
   int  _selected ;
   int _highest_pri;
-  int _best_input;
 
 public:
   int  _num_reqs ;
@@ -75,6 +82,9 @@ public:
 
   virtual void Clear();
 
+  // saves or restores the priority state kept between arbitrations
+  virtual void Serialize( Checkpoint & ckpt ) {}
+
   inline int LastWinner() const {
     return _selected;
   }
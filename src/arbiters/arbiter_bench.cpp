@@ -0,0 +1,342 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// ----------------------------------------------------------------------
+//
+//  Arbiter microbenchmark
+//
+// ----------------------------------------------------------------------
+
+#include "arbiter_bench.hpp"
+#include "arbiter.hpp"
+#include "roundrobin_arb.hpp"
+#include "config_utils.hpp"
+#include "random_utils.hpp"
+
+#include <sys/time.h>
+#include <iostream>
+#include <limits>
+#include <algorithm>
+#include <cassert>
+
+using namespace std ;
+
+namespace {
+
+// One round-robin or matrix arbiter as it was implemented before the
+// request bitmasks: every arbitration and clear visits all inputs.
+class RefLeaf {
+
+  bool _matrix_type ;
+  int  _size ;
+
+  vector<bool> _valid ;
+  vector<int>  _id ;
+  vector<int>  _pri ;
+  int  _num_reqs ;
+
+  int  _pointer ;
+  int  _best_input ;
+  int  _highest_pri ;
+
+  vector<vector<int> > _matrix ;
+  int  _last_req ;
+
+public:
+
+  int  _selected ;
+
+  RefLeaf( bool matrix_type, int size )
+    : _matrix_type(matrix_type), _size(size), _valid(size, false),
+      _id(size), _pri(size), _num_reqs(0), _pointer(0), _best_input(-1),
+      _highest_pri(numeric_limits<int>::min()), _last_req(-1),
+      _selected(-1) {
+    if ( _matrix_type ) {
+      _matrix.resize(size, vector<int>(size, 0));
+      for ( int i = 0 ; i < size ; i++ )
+	for ( int j = 0 ; j < i ; j++ )
+	  _matrix[i][j] = 1;
+    }
+  }
+
+  void AddRequest( int input, int id, int pri ) {
+    if ( _matrix_type ) {
+      _last_req = input ;
+    } else if ( ( _num_reqs == 0 ) ||
+		RoundRobinArbiter::Supersedes(input, pri, _best_input,
+					      _highest_pri, _pointer, _size) ) {
+      _highest_pri = pri ;
+      _best_input = input ;
+    }
+    _num_reqs++ ;
+    _valid[input] = true ;
+    _id[input] = id ;
+    _pri[input] = pri ;
+  }
+
+  int Arbitrate( int * id, int * pri ) {
+    if ( !_matrix_type ) {
+      _selected = _best_input ;
+    } else if ( _num_reqs < 2 ) {
+      _selected = _last_req ;
+    } else {
+      _selected = -1 ;
+      for ( int input = 0 ; ( input < _size ) && ( _selected < 0 ) ; input++ ) {
+	if ( !_valid[input] )
+	  continue ;
+	bool grant = true ;
+	for ( int i = 0 ; i < _size ; i++ ) {
+	  if ( _valid[i] &&
+	       ( ( ( _pri[i] == _pri[input] ) && _matrix[i][input] ) ||
+		 ( _pri[i] > _pri[input] ) ) ) {
+	    grant = false ;
+	    break ;
+	  }
+	}
+	if ( grant )
+	  _selected = input ;
+      }
+    }
+    if ( _selected >= 0 ) {
+      if ( id )
+	*id = _id[_selected] ;
+      if ( pri )
+	*pri = _pri[_selected] ;
+    }
+    return _selected ;
+  }
+
+  void UpdateState( ) {
+    if ( _selected < 0 )
+      return ;
+    if ( _matrix_type ) {
+      for ( int i = 0 ; i < _size ; i++ ) {
+	if ( i != _selected ) {
+	  _matrix[_selected][i] = 0 ;
+	  _matrix[i][_selected] = 1 ;
+	}
+      }
+    } else {
+      _pointer = ( _selected + 1 ) % _size ;
+    }
+  }
+
+  void Clear( ) {
+    _highest_pri = numeric_limits<int>::min() ;
+    _best_input = -1 ;
+    _last_req = -1 ;
+    if ( _num_reqs > 0 ) {
+      for ( int i = 0 ; i < _size ; i++ )
+	_valid[i] = false ;
+      _num_reqs = 0 ;
+      _selected = -1 ;
+    }
+  }
+};
+
+// Reference for the arbiter types understood by Arbiter::NewArbiter; a
+// tree(groups,type) arbiter arbitrates within each group and then among
+// the group winners.
+class RefArbiter {
+
+  int _group_size ;
+  vector<RefLeaf> _groups ;
+  vector<int> _group_reqs ;
+  RefLeaf _global ;
+  int _selected ;
+
+  static bool _IsMatrix( string const & arb_type ) {
+    if ( arb_type == "matrix" )
+      return true ;
+    if ( arb_type != "round_robin" ) {
+      cerr << "Unsupported arbiter type for benchmark: " << arb_type << endl ;
+      exit(-1) ;
+    }
+    return false ;
+  }
+
+  static int _Groups( string const & arb_type ) {
+    if ( arb_type.substr(0, 5) != "tree(" )
+      return 1 ;
+    return atoi(arb_type.substr(5).c_str()) ;
+  }
+
+  static string _LeafType( string const & arb_type ) {
+    if ( arb_type.substr(0, 5) != "tree(" )
+      return arb_type ;
+    size_t const middle = arb_type.find_first_of(',') ;
+    size_t const right = arb_type.find_last_of(')') ;
+    return arb_type.substr(middle + 1, right - middle - 1) ;
+  }
+
+public:
+
+  RefArbiter( string const & arb_type, int size )
+    : _group_size(size / _Groups(arb_type)),
+      _groups(_Groups(arb_type),
+	      RefLeaf(_IsMatrix(_LeafType(arb_type)), size / _Groups(arb_type))),
+      _group_reqs(_Groups(arb_type), 0),
+      _global(_IsMatrix(_LeafType(arb_type)), _Groups(arb_type)),
+      _selected(-1) {
+  }
+
+  void AddRequest( int input, int id, int pri ) {
+    int const group = input / _group_size ;
+    _groups[group].AddRequest(input % _group_size, id, pri) ;
+    ++_group_reqs[group] ;
+  }
+
+  int Arbitrate( ) {
+    if ( _groups.size() == 1 )
+      return _selected = _groups[0].Arbitrate(NULL, NULL) ;
+    for ( size_t g = 0 ; g < _groups.size() ; g++ ) {
+      if ( _group_reqs[g] ) {
+	int id = -1, pri = -1 ;
+	_groups[g].Arbitrate(&id, &pri) ;
+	_global.AddRequest(g, id, pri) ;
+      }
+    }
+    int const group = _global.Arbitrate(NULL, NULL) ;
+    _selected = ( group < 0 ) ? -1 :
+      ( group * _group_size + _groups[group]._selected ) ;
+    return _selected ;
+  }
+
+  void UpdateState( ) {
+    if ( _groups.size() == 1 ) {
+      _groups[0].UpdateState() ;
+    } else if ( _selected >= 0 ) {
+      _groups[_global._selected].UpdateState() ;
+      _global.UpdateState() ;
+    }
+  }
+
+  void Clear( ) {
+    for ( size_t g = 0 ; g < _groups.size() ; g++ ) {
+      _groups[g].Clear() ;
+      _group_reqs[g] = 0 ;
+    }
+    _global.Clear() ;
+    _selected = -1 ;
+  }
+};
+
+struct sPattern {
+  vector<int> inputs ;
+  vector<int> pris ;
+};
+
+inline int Arbitrate( Arbiter * arb ) {
+  return arb->Arbitrate(NULL, NULL) ;
+}
+
+inline int Arbitrate( RefArbiter * arb ) {
+  return arb->Arbitrate() ;
+}
+
+// Runs one arbitration per pattern, cycling through them, and returns
+// the time per arbitration in nanoseconds; the winners are folded into
+// a hash so that implementations can be compared.
+template<class T>
+double TimeArbiter( T * arb, vector<sPattern> const & patterns, int rounds,
+		    unsigned long long * hash )
+{
+  struct timeval start_time, end_time;
+  unsigned long long h = 0 ;
+  gettimeofday(&start_time, NULL);
+  for ( int r = 0 ; r < rounds ; r++ ) {
+    sPattern const & p = patterns[r % patterns.size()] ;
+    for ( size_t i = 0 ; i < p.inputs.size() ; i++ )
+      arb->AddRequest(p.inputs[i], i, p.pris[i]) ;
+    int const winner = Arbitrate(arb) ;
+    h = h * 1000003ULL + (unsigned long long)(winner + 1) ;
+    arb->UpdateState() ;
+    arb->Clear() ;
+  }
+  gettimeofday(&end_time, NULL);
+  *hash = h ;
+  double const us = 1000000.0 * ( end_time.tv_sec - start_time.tv_sec ) +
+    ( end_time.tv_usec - start_time.tv_usec ) ;
+  return 1000.0 * us / rounds ;
+}
+
+}
+
+bool BenchmarkArbiters( Configuration const & config )
+{
+  int const rounds = config.GetInt("arbiter_bench") ;
+  int const size = config.GetInt("arbiter_bench_size") ;
+  int const pris = config.GetInt("arbiter_bench_pris") ;
+  if ( ( size < 4 ) || ( size % 4 ) || ( pris < 1 ) ) {
+    cerr << "arbiter_bench_size must be a positive multiple of 4 and "
+	 << "arbiter_bench_pris must be positive" << endl ;
+    return false ;
+  }
+
+  // random request patterns with a random number of requesters each
+  RandomSeed(config.GetInt("seed")) ;
+  vector<sPattern> patterns(4096) ;
+  for ( size_t p = 0 ; p < patterns.size() ; p++ ) {
+    int const density = 1 + RandomInt(99) ;
+    for ( int input = 0 ; input < size ; input++ ) {
+      if ( RandomInt(99) < density ) {
+	patterns[p].inputs.push_back(input) ;
+	patterns[p].pris.push_back(RandomInt(pris - 1)) ;
+      }
+    }
+  }
+
+  string const types[] = { "round_robin", "matrix", "tree(4,round_robin)",
+			   "tree(4,matrix)" } ;
+
+  cout << "Arbiter benchmark: " << rounds << " arbitrations, " << size
+       << " inputs, " << pris << " priority level(s)" << endl ;
+  bool result = true ;
+  for ( int t = 0 ; t < 4 ; t++ ) {
+    Arbiter * arb = Arbiter::NewArbiter(NULL, "bench", types[t], size) ;
+    RefArbiter ref(types[t], size) ;
+    // report the best of a few passes to filter out interference
+    double ns = numeric_limits<double>::max() ;
+    double ref_ns = numeric_limits<double>::max() ;
+    bool same = true ;
+    for ( int pass = 0 ; pass < 3 ; pass++ ) {
+      unsigned long long hash, ref_hash ;
+      ns = min(ns, TimeArbiter(arb, patterns, rounds, &hash)) ;
+      ref_ns = min(ref_ns, TimeArbiter(&ref, patterns, rounds, &ref_hash)) ;
+      same = same && ( hash == ref_hash ) ;
+    }
+    delete arb ;
+    cout << types[t] << ": " << ns << " ns per arbitration, reference "
+	 << ref_ns << " ns" ;
+    if ( !same ) {
+      cout << ", WINNERS DIFFER" ;
+      result = false ;
+    }
+    cout << endl ;
+  }
+  return result ;
+}
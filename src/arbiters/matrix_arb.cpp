@@ -32,16 +32,16 @@
 // ----------------------------------------------------------------------
 
 #include "matrix_arb.hpp"
+#include "checkpoint.hpp"
 #include <iostream>
 using namespace std ;
 
 MatrixArbiter::MatrixArbiter( Module *parent, const string &name, int size )
-  : Arbiter( parent, name, size ), _last_req(-1) {
-  _matrix.resize(size);
-  for ( int i = 0 ; i < size ; i++ ) {
-    _matrix[i].resize(size);
-    for ( int j = 0; j < i; j++ ) {
-      _matrix[i][j] = 1;
+  : Arbiter( parent, name, size ) {
+  _matrix.Resize(size, size);
+  for ( int j = 0 ; j < size ; j++ ) {
+    for ( int i = j + 1; i < size; i++ ) {
+      _matrix.Set(j, i);
     }
   }
 }
@@ -50,7 +50,7 @@ void MatrixArbiter::PrintState() const  {
   cout << "Priority Matrix: " << endl ;
   for ( int r = 0; r < _size ; r++ ) {
     for ( int c = 0 ; c < _size ; c++ ) {
-      cout << _matrix[r][c] << " " ;
+      cout << _matrix.Test(c, r) << " " ;
     }
     cout << endl ;
   }
@@ -58,64 +58,59 @@ void MatrixArbiter::PrintState() const  {
 }
 
 void MatrixArbiter::UpdateState() {
-  // update priority matrix using last grant
+  // update priority matrix using last grant: the winner drops below
+  // every other input
   if ( _selected > -1 ) {
-    for ( int i = 0; i < _size ; i++ ) {
-      if( _selected != i ) {
-	_matrix[_selected][i] = 0 ;
-	_matrix[i][_selected] = 1 ;
-      }
+    for ( int j = 0; j < _size ; j++ ) {
+      _matrix.Reset(j, _selected);
+    }
+    tBitWord * const row = _matrix.Row(_selected);
+    for ( int w = 0; w < _words; w++ ) {
+      row[w] = ~0ULL;
     }
+    if ( _size & 63 ) {
+      row[_words - 1] &= ( 1ULL << ( _size & 63 ) ) - 1;
+    }
+    ResetBit(row, _selected);
   }
 }
 
-void MatrixArbiter::AddRequest( int input, int id, int pri )
-{
-  _last_req = input;
-  Arbiter::AddRequest(input, id, pri);
-}
-
 int MatrixArbiter::Arbitrate( int* id, int* pri ) {
   
   // avoid running arbiter if it has not recevied at least two requests
   // (in this case, requests and grants are identical)
   if ( _num_reqs < 2 ) {
     
-    _selected = _last_req ;
+    _selected = ( _num_reqs > 0 ) ? NextBit(&_valid[0], _words, 0) : -1 ;
     
   } else {
     
     _selected = -1 ;
 
-    for ( int input = 0 ; input < _size ; input++ ) {
-      if(_request[input].valid) {
-	
-	bool grant = true;
-	for ( int i = 0 ; i < _size ; i++ ) {
-	  if ( _request[i].valid &&
-	       ( ( ( _request[i].pri == _request[input].pri ) &&
-		   _matrix[i][input]) ||
-		 ( _request[i].pri > _request[input].pri )
-		 ) ) {
-	    grant = false ;
-	    break ;
-	  }
-	}
-	
-	if ( grant ) {
-	  _selected = input ;
-	  break ; 
+    // the winner is the request in the highest priority class that no
+    // other request in that class has priority over
+    for ( int input = NextBit(&_top[0], _words, 0) ; input >= 0 ;
+	  input = NextBit(&_top[0], _words, input + 1) ) {
+      tBitWord const * const row = _matrix.Row(input);
+      bool grant = true;
+      for ( int w = 0 ; w < _words ; w++ ) {
+	if ( row[w] & _top[w] ) {
+	  grant = false ;
+	  break ;
 	}
       }
       
+      if ( grant ) {
+	_selected = input ;
+	break ; 
+      }
     }
   }
     
   return Arbiter::Arbitrate(id, pri);
 }
 
-void MatrixArbiter::Clear()
+void MatrixArbiter::Serialize( Checkpoint & ckpt )
 {
-  _last_req = -1;
-  Arbiter::Clear();
+  ckpt.Sync( _matrix );
 }
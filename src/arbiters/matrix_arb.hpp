@@ -42,10 +42,9 @@ using namespace std;
 
 class MatrixArbiter : public Arbiter {
 
-  // Priority matrix
-  vector<vector<int> > _matrix ;
-
-  int  _last_req ;
+  // Priority matrix, stored by column: row j holds the inputs that
+  // currently have priority over input j
+  BitMatrix _matrix ;
 
 public:
 
@@ -62,9 +61,7 @@ public:
   // updates pointers to metadata when valid pointers are passed
   virtual int Arbitrate( int* id = 0, int* pri = 0) ;
 
-  virtual void AddRequest( int input, int id, int pri ) ;
-
-  virtual void Clear();
+  virtual void Serialize( Checkpoint & ckpt );
 
 } ;
 
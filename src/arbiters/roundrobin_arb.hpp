@@ -56,9 +56,7 @@ public:
   // updates pointers to metadata when valid pointers are passed
   virtual int Arbitrate( int* id = 0, int* pri = 0) ;
 
-  virtual void AddRequest( int input, int id, int pri ) ;
-
-  virtual void Clear();
+  virtual void Serialize( Checkpoint & ckpt );
 
   static inline bool Supersedes(int input1, int pri1, int input2, int pri2, int offset, int size)
   {
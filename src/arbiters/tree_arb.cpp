@@ -42,7 +42,6 @@ TreeArbiter::TreeArbiter( Module *parent, const string &name,
   : Arbiter( parent, name, size ) {
   assert(size % groups == 0);
   _group_arbiters.resize(groups);
-  _group_reqs.resize(groups, 0);
   _group_size = size / groups;
   for(int i = 0; i < groups; ++i) {
     ostringstream group_arb_name;
@@ -77,12 +76,14 @@ void TreeArbiter::UpdateState() {
   }
 }
 
+// The group arbiters keep the requests and their priorities; the tree only
+// counts them, so the base class bookkeeping is skipped.
 void TreeArbiter::AddRequest( int input, int id, int pri )
 {
-  Arbiter::AddRequest(input, id, pri);
+  assert( 0 <= input && input < _size ) ;
+  _num_reqs++ ;
   int group_index = input / _group_size;
   _group_arbiters[group_index]->AddRequest( input % _group_size, id, pri );
-  ++_group_reqs[group_index];
 }
 
 int TreeArbiter::Arbitrate( int* id, int* pri ) {
@@ -90,19 +91,21 @@ int TreeArbiter::Arbitrate( int* id, int* pri ) {
     return -1;
   } 
   for(int i = 0; i < (int)_group_arbiters.size(); ++i) {
-    if(_group_reqs[i]) {
+    Arbiter * const group_arbiter = _group_arbiters[i];
+    if(group_arbiter->_num_reqs) {
       int group_id, group_pri;
-      _group_arbiters[i]->Arbitrate(&group_id, &group_pri);
+      group_arbiter->Arbitrate(&group_id, &group_pri);
       _global_arbiter->AddRequest(i, group_id, group_pri);
     }
   }
-  int group = _global_arbiter->Arbitrate(NULL, NULL);
+  // the global request of a group carries its winner's id and priority
+  int group = _global_arbiter->Arbitrate(id, pri);
   assert(group >= 0 && group < (int)_group_arbiters.size());
   int group_sel = _group_arbiters[group]->LastWinner();
   assert(group_sel >= 0 && group_sel < _group_size);
   _selected = group * _group_size + group_sel;
   assert(_selected >= 0 && _selected < _size);
-  return Arbiter::Arbitrate(id, pri);
+  return _selected;
 }
 
 void TreeArbiter::Clear()
@@ -112,8 +115,15 @@ void TreeArbiter::Clear()
   }
   for(int i = 0; i < (int)_group_arbiters.size(); ++i) {
     _group_arbiters[i]->Clear();
-    _group_reqs[i] = 0;
   }
   _global_arbiter->Clear();
-  Arbiter::Clear();
+  _num_reqs = 0;
+  _selected = -1;
+}
+
+void TreeArbiter::Serialize( Checkpoint & ckpt ) {
+  for(size_t i = 0; i < _group_arbiters.size(); ++i) {
+    _group_arbiters[i]->Serialize(ckpt);
+  }
+  _global_arbiter->Serialize(ckpt);
 }
@@ -43,8 +43,6 @@ class TreeArbiter : public Arbiter {
   vector<Arbiter *> _group_arbiters;
   Arbiter * _global_arbiter;
 
-  vector<int> _group_reqs;
-
 public:
 
   // Constructors
@@ -66,6 +64,8 @@ public:
 
   virtual void Clear();
 
+  virtual void Serialize( Checkpoint & ckpt );
+
 } ;
 
 #endif
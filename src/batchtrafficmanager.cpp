@@ -65,7 +65,7 @@ BatchTrafficManager::~BatchTrafficManager( )
 void BatchTrafficManager::_RetireFlit( Flit *f, int dest )
 {
   _last_id = f->id;
-  _last_pid = f->pid;
+  _last_pid = f->packet->pid;
   TrafficManager::_RetireFlit(f, dest);
 }
 
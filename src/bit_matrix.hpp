@@ -0,0 +1,135 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef _BIT_MATRIX_HPP_
+#define _BIT_MATRIX_HPP_
+
+#include <vector>
+
+using namespace std;
+
+// Bit vectors are stored as arrays of 64-bit words; bit i lives in word
+// i / 64. The helpers below work on a raw word array so that they apply
+// equally to a plain vector and to one row of a BitMatrix.
+typedef unsigned long long tBitWord;
+
+inline int BitWords( int bits ) {
+  return (bits + 63) / 64;
+}
+
+inline void SetBit( tBitWord * v, int i ) {
+  v[i >> 6] |= (1ULL << (i & 63));
+}
+inline void ResetBit( tBitWord * v, int i ) {
+  v[i >> 6] &= ~(1ULL << (i & 63));
+}
+inline bool TestBit( tBitWord const * v, int i ) {
+  return (v[i >> 6] >> (i & 63)) & 1ULL;
+}
+
+inline bool AnyBit( tBitWord const * v, int words ) {
+  for(int w = 0; w < words; ++w) {
+    if(v[w]) {
+      return true;
+    }
+  }
+  return false;
+}
+
+inline int CountBits( tBitWord const * v, int words ) {
+  int count = 0;
+  for(int w = 0; w < words; ++w) {
+    count += __builtin_popcountll(v[w]);
+  }
+  return count;
+}
+
+// smallest set bit >= i, or -1 if there is none
+inline int NextBit( tBitWord const * v, int words, int i ) {
+  int w = i >> 6;
+  if(w >= words) {
+    return -1;
+  }
+  tBitWord word = v[w] & (~0ULL << (i & 63));
+  while(!word) {
+    if(++w >= words) {
+      return -1;
+    }
+    word = v[w];
+  }
+  return (w << 6) + __builtin_ctzll(word);
+}
+
+// first set bit in round-robin order starting at offset, or -1
+inline int RoundRobinBit( tBitWord const * v, int words, int offset ) {
+  int const i = NextBit(v, words, offset);
+  return (i >= 0) ? i : NextBit(v, words, 0);
+}
+
+// Matrix of bits stored row by row; each row is a bit vector over the
+// columns.
+class BitMatrix {
+
+public:
+  BitMatrix( ) : _rows(0), _words(0) {}
+
+  inline void Resize( int rows, int cols ) {
+    _rows = rows;
+    _words = BitWords(cols);
+    _bits.assign(_rows * _words, 0ULL);
+  }
+
+  inline int Rows( ) const {return _rows;}
+  inline int Words( ) const {return _words;}
+
+  inline tBitWord * Row( int r ) {return &_bits[r * _words];}
+  inline tBitWord const * Row( int r ) const {return &_bits[r * _words];}
+
+  inline void Set( int r, int c ) {SetBit(Row(r), c);}
+  inline void Reset( int r, int c ) {ResetBit(Row(r), c);}
+  inline bool Test( int r, int c ) const {return TestBit(Row(r), c);}
+
+  inline bool Any( int r ) const {return AnyBit(Row(r), _words);}
+  inline int Count( int r ) const {return CountBits(Row(r), _words);}
+  inline int Next( int r, int c ) const {return NextBit(Row(r), _words, c);}
+  inline int RoundRobin( int r, int offset ) const {
+    return RoundRobinBit(Row(r), _words, offset);
+  }
+
+  inline void ClearRow( int r ) {
+    tBitWord * const row = Row(r);
+    for(int w = 0; w < _words; ++w) {
+      row[w] = 0ULL;
+    }
+  }
+
+private:
+  int _rows;
+  int _words;
+  vector<tBitWord> _bits;
+};
+
+#endif
@@ -46,6 +46,8 @@ BookSimConfig::BookSimConfig( )
 
   // Physical sub-networks
   _int_map["subnets"] = 1;
+  // step each physical sub-network on its own thread
+  _int_map["parallel_subnets"] = 0;
 
   //==== Topology options =======================
   AddStrField( "topology", "torus" );
@@ -258,6 +260,44 @@ BookSimConfig::BookSimConfig( )
 
   _int_map["sim_count"]     = 1;   // number of simulations to perform
 
+  // worker threads used to step each network; 1 steps it serially
+  _int_map["network_threads"] = 1;
+
+  // only step channels and routers that have work pending
+  _int_map["active_set"] = 1;
+
+  // jump over cycles in which the whole system is quiescent
+  _int_map["skip_idle_cycles"] = 1;
+
+  // report heap allocations per simulated cycle and flit/credit pool usage
+  // for every sample period
+  _int_map["count_allocations"] = 0;
+
+  // warm up once and fork one process per sim_count run to measure it
+  _int_map["fork_after_warmup"] = 0;
+
+  // run up to this many simulations at once in separate processes, each
+  // with its own seed; negative uses one per core
+  _int_map["parallel_sims"] = 0;
+
+  // save the simulation state once warmed up, or resume from such a file
+  AddStrField("checkpoint_out", "");
+  AddStrField("checkpoint_in", "");
+
+  // search for the saturation rate, simulating sweep_jobs rates at a time
+  _int_map["sweep"] = 0;
+  _int_map["sweep_jobs"] = 1;
+  _float_map["sweep_min_step"] = 0.001;
+
+  // time this many arbitrations of each arbiter type on random requests
+  // instead of simulating
+  _int_map["arbiter_bench"] = 0;
+  _int_map["arbiter_bench_size"] = 16;
+  _int_map["arbiter_bench_pris"] = 1;
+
+  // processes running the jobs of value lists, and where to cache results
+  _int_map["grid_jobs"] = 1;
+  AddStrField("grid_cache", "");
 
   _int_map["include_queuing"] =1; // non-zero includes source queuing latency
 
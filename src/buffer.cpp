@@ -25,11 +25,13 @@
  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
+#include <limits>
 #include <sstream>
 
 #include "globals.hpp"
 #include "booksim.hpp"
 #include "buffer.hpp"
+#include "checkpoint.hpp"
 
 Buffer::Buffer( const Configuration& config, int outputs, 
 		Module *parent, const string& name ) :
@@ -41,42 +43,268 @@ Module( parent, name ), _occupancy(0)
     _size = (num_vcs - 1) * config.GetInt( "vc_buf_size" ) + config.GetInt("duty_buf_size");
   };
 
-  _vc.resize(num_vcs);
+  _vcs = num_vcs;
+
+  // size the rings for the deepest VC the upstream buffer state allows
+  // unless buffers are shared
+  int depth = config.GetInt("buf_size");
+  if(depth > 0) {
+    depth /= num_vcs;
+  } else {
+    depth = max(config.GetInt("vc_buf_size"), config.GetInt("duty_buf_size"));
+  }
+  _vc_capacity = 1;
+  while(_vc_capacity < depth) {
+    _vc_capacity *= 2;
+  }
+  _flits.resize(num_vcs * _vc_capacity, NULL);
+  _vc_head.resize(num_vcs, 0);
+  _vc_occupancy.resize(num_vcs, 0);
+
 //duty buffer也是一条vc，vc的size在dest_buf指定，不在这里。只需要指定最后一条vc为duty buffer。
-  for(int i = 0; i < num_vcs; ++i) {
-    ostringstream vc_name;
-    vc_name << "vc_" << i;
-    _vc[i] = new VC(config, outputs, this, vc_name.str( ) );
+  _state.resize(num_vcs, VC::idle);
+  _out_port.resize(num_vcs, -1);
+  _out_vc.resize(num_vcs, -1);
+  _pri.resize(num_vcs, 0);
+  _expected_pid.resize(num_vcs, -1);
+  _last_id.resize(num_vcs, -1);
+  _last_pid.resize(num_vcs, -1);
+  _watched.resize(num_vcs, false);
+
+  _lookahead_routing = !config.GetInt("routing_delay");
+  _route_set.resize(num_vcs, NULL);
+  if(!_lookahead_routing) {
+    _vc_route_set.resize(num_vcs);
+    for(int vc = 0; vc < num_vcs; ++vc) {
+      _route_set[vc] = &_vc_route_set[vc];
+    }
+  }
+
+  string priority = config.GetStr( "priority" );
+  if ( priority == "local_age" ) {
+    _pri_type = local_age_based;
+  } else if ( priority == "queue_length" ) {
+    _pri_type = queue_length_based;
+  } else if ( priority == "hop_count" ) {
+    _pri_type = hop_count_based;
+  } else if ( priority == "none" ) {
+    _pri_type = none;
+  } else {
+    _pri_type = other;
   }
 
+  _priority_donation = config.GetInt("vc_priority_donation");
+
 #ifdef TRACK_BUFFERS
   int classes = config.GetInt("classes");
   _class_occupancy.resize(classes, 0);
 #endif
 }
 
-Buffer::~Buffer()
-{
-  for(vector<VC*>::iterator i = _vc.begin(); i != _vc.end(); ++i) {
-    delete *i;
-  }
-}
-
 void Buffer::AddFlit( int vc, Flit *f )
 {
+  assert(f);
+
   if(_occupancy >= _size) {
     Error("Flit buffer overflow.");
   }
   ++_occupancy;
-  _vc[vc]->AddFlit(f);
+
+  if(_expected_pid[vc] >= 0) {
+    if(f->packet->pid != _expected_pid[vc]) {
+      ostringstream err;
+      err << "Received flit " << f->id << " with unexpected packet ID: " << f->packet->pid 
+	  << " (expected: " << _expected_pid[vc] << ") at VC " << vc;
+      Error(err.str());
+    } else if(f->tail) {
+      _expected_pid[vc] = -1;
+    }
+  } else if(!f->tail) {
+    _expected_pid[vc] = f->packet->pid;
+  }
+    
+  // update flit priority before adding to VC buffer
+  if(_pri_type == local_age_based) {
+    f->pri = numeric_limits<int>::max() - GetSimTime();
+    assert(f->pri >= 0);
+  } else if(_pri_type == hop_count_based) {
+    f->pri = f->hops;
+    assert(f->pri >= 0);
+  }
+
+  if(_vc_occupancy[vc] == _vc_capacity) {
+    _Grow();
+  }
+  _Slot(vc, _vc_occupancy[vc]) = f;
+  ++_vc_occupancy[vc];
+  _UpdatePriority(vc);
+
+#ifdef TRACK_BUFFERS
+  ++_class_occupancy[f->packet->cl];
+#endif
+}
+
+Flit *Buffer::RemoveFlit( int vc )
+{
+  if(!_vc_occupancy[vc]) {
+    ostringstream err;
+    err << "Trying to remove flit from empty buffer at VC " << vc;
+    Error(err.str());
+  }
+  --_occupancy;
+
+  Flit * f = _Slot(vc, 0);
+  _Slot(vc, 0) = NULL;
+  _vc_head[vc] = (_vc_head[vc] + 1) & (_vc_capacity - 1);
+  --_vc_occupancy[vc];
+
+#ifdef TRACK_BUFFERS
+  int cl = f->packet->cl;
+  assert(_class_occupancy[cl] > 0);
+  --_class_occupancy[cl];
+#endif
+
+  _last_id[vc] = f->id;
+  _last_pid[vc] = f->packet->pid;
+  _UpdatePriority(vc);
+  return f;
+}
+
+// doubles the ring size of all VCs, unrolling each ring to start at its
+// first slot
+void Buffer::_Grow( )
+{
+  int const capacity = 2 * _vc_capacity;
+  vector<Flit *> flits(_vcs * capacity, NULL);
+  for(int vc = 0; vc < _vcs; ++vc) {
+    for(int i = 0; i < _vc_occupancy[vc]; ++i) {
+      flits[vc * capacity + i] = _Slot(vc, i);
+    }
+    _vc_head[vc] = 0;
+  }
+  _flits.swap(flits);
+  _vc_capacity = capacity;
+}
+
+void Buffer::SetState( int vc, VC::eVCState s )
+{
+  Flit * f = FrontFlit(vc);
+  
+  if(f && f->watch)
+    *gWatchOut << GetSimTime() << " | " << _VCName(vc) << " | "
+		<< "Changing state from " << VC::VCSTATE[_state[vc]]
+		<< " to " << VC::VCSTATE[s] << "." << endl;
+  
+  _state[vc] = s;
+}
+
+void Buffer::_UpdatePriority( int vc )
+{
+  if(!_vc_occupancy[vc]) return;
+  if(_pri_type == queue_length_based) {
+    _pri[vc] = _vc_occupancy[vc];
+  } else if(_pri_type != none) {
+    Flit * f = FrontFlit(vc);
+    if((_pri_type != local_age_based) && _priority_donation) {
+      Flit * df = f;
+      for(int i = 1; i < _vc_occupancy[vc]; ++i) {
+	Flit * bf = _Slot(vc, i);
+	if(bf->pri > df->pri) df = bf;
+      }
+      if((df != f) && (df->watch || f->watch)) {
+	*gWatchOut << GetSimTime() << " | " << _VCName(vc) << " | "
+		    << "Flit " << df->id
+		    << " donates priority to flit " << f->id
+		    << "." << endl;
+      }
+      f = df;
+    }
+    if(f->watch)
+      *gWatchOut << GetSimTime() << " | " << _VCName(vc) << " | "
+		  << "Flit " << f->id
+		  << " sets priority to " << f->pri
+		  << "." << endl;
+    _pri[vc] = f->pri;
+  }
+}
+
+void Buffer::Route( int vc, tRoutingFunction rf, const Router* router, const Flit* f, int in_channel )
+{
+  rf( router, f, in_channel, _route_set[vc], false );
+  _out_port[vc] = -1;
+  _out_vc[vc] = -1;
+}
+
+string Buffer::_VCName( int vc ) const
+{
+  ostringstream name;
+  name << FullName() << "/vc_" << vc;
+  return name.str();
+}
+
+void Buffer::Serialize( Checkpoint & ckpt )
+{
+  ckpt.Sync(_occupancy);
+  for(int vc = 0; vc < _vcs; ++vc) {
+    int n = _vc_occupancy[vc];
+    ckpt.Sync(n);
+    if(ckpt.Loading()) {
+      for(int i = 0; i < _vc_occupancy[vc]; ++i) {
+	_Slot(vc, i) = NULL;
+      }
+      _vc_head[vc] = 0;
+      _vc_occupancy[vc] = 0;
+      while(_vc_capacity < n) {
+	_Grow();
+      }
+      _vc_occupancy[vc] = n;
+    }
+    for(int i = 0; i < n; ++i) {
+      ckpt.Sync(_Slot(vc, i));
+    }
+    ckpt.SyncEnum(_state[vc]);
+    if(_lookahead_routing) {
+      // the route set is the lookahead route carried by the head flit
+      bool head_route = (_route_set[vc] && _vc_occupancy[vc] &&
+                         (_route_set[vc] == &FrontFlit(vc)->packet->la_route_set));
+      ckpt.Sync(head_route);
+      if(ckpt.Loading()) {
+        _route_set[vc] = head_route ? &FrontFlit(vc)->packet->la_route_set : NULL;
+      }
+    } else {
+      ckpt.Sync(*_route_set[vc]);
+    }
+    ckpt.Sync(_out_port[vc]);
+    ckpt.Sync(_out_vc[vc]);
+    ckpt.Sync(_pri[vc]);
+    bool watched = _watched[vc];
+    ckpt.Sync(watched);
+    _watched[vc] = watched;
+    ckpt.Sync(_expected_pid[vc]);
+    ckpt.Sync(_last_id[vc]);
+    ckpt.Sync(_last_pid[vc]);
+  }
 #ifdef TRACK_BUFFERS
-  ++_class_occupancy[f->cl];
+  ckpt.Sync(_class_occupancy);
 #endif
 }
 
 void Buffer::Display( ostream & os ) const
 {
-  for(vector<VC*>::const_iterator i = _vc.begin(); i != _vc.end(); ++i) {
-    (*i)->Display(os);
+  for(int vc = 0; vc < _vcs; ++vc) {
+    if ( _state[vc] != VC::idle ) {
+      os << _VCName(vc) << ": "
+	 << " state: " << VC::VCSTATE[_state[vc]];
+      if(_state[vc] == VC::active) {
+	os << " out_port: " << _out_port[vc]
+	   << " out_vc: " << _out_vc[vc];
+      }
+      os << " fill: " << _vc_occupancy[vc];
+      if(_vc_occupancy[vc]) {
+	os << " front: " << FrontFlit(vc)->id;
+      }
+      os << " pri: " << _pri[vc];
+      os << endl;
+    }
   }
 }
@@ -36,51 +36,89 @@
 #include "routefunc.hpp"
 #include "config_utils.hpp"
 
+class Checkpoint;
+
+// An input buffer and its virtual channels. The flits of all VCs live in
+// one block of ring buffers, and the per-VC state is kept in parallel
+// arrays so that the allocators' scans over a port's VCs stay within a few
+// cache lines.
 class Buffer : public Module {
   
   int _occupancy;
   int _size;
 
-  vector<VC*> _vc;
+  int _vcs;
+
+  // VC vc owns slots [vc * _vc_capacity, (vc + 1) * _vc_capacity) of
+  // _flits; the capacity is a power of two that covers the configured VC
+  // depth and only grows if a buffer policy lets a VC hold more
+  int _vc_capacity;
+  vector<Flit *> _flits;
+  vector<int> _vc_head;
+  vector<int> _vc_occupancy;
+
+  vector<VC::eVCState> _state;
+  vector<OutputSet *> _route_set;
+  vector<int> _out_port;
+  vector<int> _out_vc;
+  vector<int> _pri;
+  vector<int> _expected_pid;
+  vector<int> _last_id;
+  vector<int> _last_pid;
+  vector<bool> _watched;
+
+  // route sets owned by the VCs when routing is not done by lookahead
+  vector<OutputSet> _vc_route_set;
+
+  enum ePrioType { local_age_based, queue_length_based, hop_count_based, none, other };
+
+  ePrioType _pri_type;
+
+  int _priority_donation;
+
+  bool _lookahead_routing;
 
 #ifdef TRACK_BUFFERS
   vector<int> _class_occupancy;
 #endif
 
+  inline Flit * & _Slot( int vc, int i )
+  {
+    return _flits[vc * _vc_capacity + ((_vc_head[vc] + i) & (_vc_capacity - 1))];
+  }
+  inline Flit * _Slot( int vc, int i ) const
+  {
+    return _flits[vc * _vc_capacity + ((_vc_head[vc] + i) & (_vc_capacity - 1))];
+  }
+
+  void _Grow( );
+  void _UpdatePriority( int vc );
+  string _VCName( int vc ) const;
+
 public:
   
   Buffer( const Configuration& config, int outputs,
 	  Module *parent, const string& name );
-  ~Buffer();
 
   void AddFlit( int vc, Flit *f );
 
-  inline Flit *RemoveFlit( int vc )
-  {
-    --_occupancy;
-#ifdef TRACK_BUFFERS
-    int cl = _vc[vc]->FrontFlit()->cl;
-    assert(_class_occupancy[cl] > 0);
-    --_class_occupancy[cl];
-#endif
-    return _vc[vc]->RemoveFlit( );
-  }
+  Flit *RemoveFlit( int vc );
   
   inline Flit *FrontFlit( int vc ) const
   {
-    return _vc[vc]->FrontFlit( );
+    return _vc_occupancy[vc] ? _flits[vc * _vc_capacity + _vc_head[vc]] : NULL;
   }
   
   inline bool Empty( int vc ) const
   {
-    return _vc[vc]->Empty( );
+    return _vc_occupancy[vc] == 0;
   }
 //DB是一直都在运行中的，所以只要DB之前的vc都为idle，就可以power off了
   inline bool BufferIdle() {
     int i = 0;
     while(GetState(i) == VC::idle){
       ++i;
-      if(i == _vc.size() - 1)
+      if(i == _vcs - 1)
         return true;
     }
     return false;
@@ -93,59 +131,56 @@ public:
 
   inline VC::eVCState GetState( int vc ) const
   {
-    return _vc[vc]->GetState( );
+    return _state[vc];
   }
 
-  inline void SetState( int vc, VC::eVCState s )
-  {
-    _vc[vc]->SetState(s);
-  }
+  void SetState( int vc, VC::eVCState s );
 
   inline const OutputSet *GetRouteSet( int vc ) const
   {
-    return _vc[vc]->GetRouteSet( );
+    return _route_set[vc];
   }
 
   inline void SetRouteSet( int vc, OutputSet * output_set )
   {
-    _vc[vc]->SetRouteSet(output_set);
+    _route_set[vc] = output_set;
+    _out_port[vc] = -1;
+    _out_vc[vc] = -1;
   }
 
   inline void SetOutput( int vc, int out_port, int out_vc )
   {
-    _vc[vc]->SetOutput(out_port, out_vc);
+    _out_port[vc] = out_port;
+    _out_vc[vc] = out_vc;
   }
 
   inline int GetOutputPort( int vc ) const
   {
-    return _vc[vc]->GetOutputPort( );
+    return _out_port[vc];
   }
 
   inline int GetOutputVC( int vc ) const
   {
-    return _vc[vc]->GetOutputVC( );
+    return _out_vc[vc];
   }
 
   inline int GetPriority( int vc ) const
   {
-    return _vc[vc]->GetPriority( );
+    return _pri[vc];
   }
 
-  inline void Route( int vc, tRoutingFunction rf, const Router* router, const Flit* f, int in_channel )
-  {
-    _vc[vc]->Route(rf, router, f, in_channel);
-  }
+  void Route( int vc, tRoutingFunction rf, const Router* router, const Flit* f, int in_channel );
 
   // ==== Debug functions ====
 
   inline void SetWatch( int vc, bool watch = true )
   {
-    _vc[vc]->SetWatch(watch);
+    _watched[vc] = watch;
   }
 
   inline bool IsWatched( int vc ) const
   {
-    return _vc[vc]->IsWatched( );
+    return _watched[vc];
   }
 
   inline int GetOccupancy( ) const
@@ -155,7 +190,7 @@ public:
 
   inline int GetOccupancy( int vc ) const
   {
-    return _vc[vc]->GetOccupancy( );
+    return _vc_occupancy[vc];
   }
 
 //将当前buffer转换为上一个节点的dest buffer
@@ -181,6 +216,8 @@ public:
   }
 #endif
 
+  void Serialize( Checkpoint & ckpt );
+
   void Display( ostream & os = cout ) const;
 };
 
@@ -41,6 +41,7 @@
 #include "buffer_state.hpp"
 #include "random_utils.hpp"
 #include "globals.hpp"
+#include "checkpoint.hpp"
 
 //#define DEBUG_FEEDBACK
 //#define DEBUG_SIMPLEFEEDBACK
@@ -255,6 +256,13 @@ void BufferState::SharedBufferPolicy::FreeSlotFor(int vc)
   }
 }
 
+void BufferState::SharedBufferPolicy::Serialize(Checkpoint & ckpt)
+{
+  ckpt.Sync(_private_buf_occupancy);
+  ckpt.Sync(_shared_buf_occupancy);
+  ckpt.Sync(_reserved_slots);
+}
+
 bool BufferState::SharedBufferPolicy::IsFullFor(int vc) const
 {
   int i = _private_buf_vc_map[vc];
@@ -306,6 +314,13 @@ void BufferState::LimitedSharedBufferPolicy::SendingFlit(Flit const * const f)
   }
 }
 
+void BufferState::LimitedSharedBufferPolicy::Serialize(Checkpoint & ckpt)
+{
+  SharedBufferPolicy::Serialize(ckpt);
+  ckpt.Sync(_active_vcs);
+  ckpt.Sync(_max_held_slots);
+}
+
 bool BufferState::LimitedSharedBufferPolicy::IsFullFor(int vc) const
 {
   return (SharedBufferPolicy::IsFullFor(vc) ||
@@ -486,6 +501,15 @@ void BufferState::FeedbackSharedBufferPolicy::FreeSlotFor(int vc)
 #endif
 }
 
+void BufferState::FeedbackSharedBufferPolicy::Serialize(Checkpoint & ckpt)
+{
+  SharedBufferPolicy::Serialize(ckpt);
+  ckpt.Sync(_occupancy_limit);
+  ckpt.Sync(_round_trip_time);
+  ckpt.Sync(_flit_sent_time);
+  ckpt.Sync(_min_latency);
+}
+
 bool BufferState::FeedbackSharedBufferPolicy::IsFullFor(int vc) const
 {
   if(SharedBufferPolicy::IsFullFor(vc)) {
@@ -552,6 +576,12 @@ void BufferState::SimpleFeedbackSharedBufferPolicy::FreeSlotFor(int vc)
   SharedBufferPolicy::FreeSlotFor(vc);
 }
 
+void BufferState::SimpleFeedbackSharedBufferPolicy::Serialize(Checkpoint & ckpt)
+{
+  FeedbackSharedBufferPolicy::Serialize(ckpt);
+  ckpt.Sync(_pending_credits);
+}
+
 BufferState::BufferState( const Configuration& config, Module *parent, const string& name ) : 
   Module( parent, name ), _occupancy(0), _state(idle), _wakingup_time(0), _idle_time(0)
 {
@@ -589,10 +619,7 @@ void BufferState::ProcessCredit( Credit const * const c )
 {
   assert( c );
 
-  set<int>::iterator iter = c->vc.begin();
-  while(iter != c->vc.end()) {
-
-    int const vc = *iter;
+  for(int vc = c->vc.First(); vc >= 0; vc = c->vc.Next(vc)) {
 
     assert( ( vc >= 0 ) && ( vc < _vcs ) );
 
@@ -627,8 +654,6 @@ void BufferState::ProcessCredit( Credit const * const c )
 #endif
 
     _buffer_policy->FreeSlotFor(vc);
-
-    ++iter;
   }
 }
 
@@ -645,8 +670,8 @@ void BufferState::SendingFlit( Flit const * const f )
   _buffer_policy->SendingFlit(f);//判断虚拟信道vc被占用的缓存是否超过了虚拟信道的缓存
   
 #ifdef TRACK_BUFFERS
-  _outstanding_classes[vc].push(f->cl);
-  ++_class_occupancy[f->cl];
+  _outstanding_classes[vc].push(f->packet->cl);
+  ++_class_occupancy[f->packet->cl];
 #endif
 
   if ( f->tail ) {
@@ -658,7 +683,7 @@ void BufferState::SendingFlit( Flit const * const f )
     }
   }
   _last_id[vc] = f->id;//当前节点虚拟信道vc所服务的flit ID和packet ID
-  _last_pid[vc] = f->pid;
+  _last_pid[vc] = f->packet->pid;
 }
 
 void BufferState::TakeBuffer( int vc, int tag )//tag表示当前flit所在的vc对应的switch端口，vc表示flit的目的vc
@@ -675,6 +700,25 @@ void BufferState::TakeBuffer( int vc, int tag )//tag表示当前flit所在的vc
   _buffer_policy->TakeBuffer(vc);
 }
 
+void BufferState::Serialize( Checkpoint & ckpt )
+{
+  ckpt.Sync(_occupancy);
+  ckpt.Sync(_vc_occupancy);
+  _buffer_policy->Serialize(ckpt);
+  ckpt.Sync(_in_use_by);
+  ckpt.Sync(_tail_sent);
+  ckpt.Sync(_last_id);
+  ckpt.Sync(_last_pid);
+#ifdef TRACK_BUFFERS
+  ckpt.Sync(_outstanding_classes);
+  ckpt.Sync(_class_occupancy);
+#endif
+  ckpt.Sync(dutyVC);
+  ckpt.SyncEnum(_state);
+  ckpt.Sync(_wakingup_time);
+  ckpt.Sync(_idle_time);
+}
+
 void BufferState::Display( ostream & os ) const
 {
   os << FullName() << " :" << endl;
@@ -36,6 +36,8 @@
 #include "credit.hpp"
 #include "config_utils.hpp"
 
+class Checkpoint;
+
 class BufferState : public Module {
   
   class BufferPolicy : public Module {
@@ -51,6 +53,7 @@ class BufferState : public Module {
     virtual bool IsFullFor(int vc = 0) const = 0;
     virtual int AvailableFor(int vc = 0) const = 0;
     virtual int LimitFor(int vc = 0) const = 0;
+    virtual void Serialize(Checkpoint & ckpt) {}
 
     static BufferPolicy * New(Configuration const & config, 
 			      BufferState * parent, const string & name);
@@ -87,6 +90,7 @@ class BufferState : public Module {
     virtual bool IsFullFor(int vc = 0) const;
     virtual int AvailableFor(int vc = 0) const;
     virtual int LimitFor(int vc = 0) const;
+    virtual void Serialize(Checkpoint & ckpt);
   };
 
   class LimitedSharedBufferPolicy : public SharedBufferPolicy {
@@ -103,6 +107,7 @@ class BufferState : public Module {
     virtual bool IsFullFor(int vc = 0) const;
     virtual int AvailableFor(int vc = 0) const;
     virtual int LimitFor(int vc = 0) const;
+    virtual void Serialize(Checkpoint & ckpt);
   };
     
   class DynamicLimitedSharedBufferPolicy : public LimitedSharedBufferPolicy {
@@ -145,6 +150,7 @@ class BufferState : public Module {
     virtual bool IsFullFor(int vc = 0) const;
     virtual int AvailableFor(int vc = 0) const;
     virtual int LimitFor(int vc = 0) const;
+    virtual void Serialize(Checkpoint & ckpt);
   };
   
   class SimpleFeedbackSharedBufferPolicy : public FeedbackSharedBufferPolicy {
@@ -155,6 +161,7 @@ class BufferState : public Module {
 				     BufferState * parent, const string & name);
     virtual void SendingFlit(Flit const * const f);
     virtual void FreeSlotFor(int vc = 0);
+    virtual void Serialize(Checkpoint & ckpt);
   };
   
   bool _wait_for_tail_credit;
@@ -339,6 +346,8 @@ public:
   }
 #endif
 
+  void Serialize( Checkpoint & ckpt );
+
   void Display( ostream & os = cout ) const;
 };
 
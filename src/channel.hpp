@@ -37,12 +37,13 @@
 #ifndef _CHANNEL_HPP
 #define _CHANNEL_HPP
 
-#include <queue>
+#include <vector>
 #include <cassert>
 
 #include "globals.hpp"
 #include "module.hpp"
 #include "timed_module.hpp"
+#include "checkpoint.hpp"
 
 class TrafficManager;
 
@@ -58,6 +59,10 @@ public:
   void SetLatency(int cycles);
   int GetLatency() const { return _delay ; }
   
+  // Module that reads this channel's output and needs waking when data
+  // arrives
+  void SetReceiver(TimedModule * receiver) { _receiver = receiver; }
+
   // Send data 
   virtual void Send(T * data);
   
@@ -68,17 +73,35 @@ public:
   void Evaluate(int subnet, TrafficManager * trafficManager) {}
   virtual void WriteOutputs();
 
+  // The phases for a given cycle, without the virtual call or the time
+  // lookup; the network's stepping loops call these directly.
+  inline void ReadInputsAt(int time);
+  inline void WriteOutputsAt(int time);
+
+  bool Idle() const { return !_input && !_output && !_in_flight; }
+
+  virtual void Serialize(Checkpoint & ckpt);
+
 protected:
   int _delay;
   T * _input;
   T * _output;
-  queue<pair<int, T *> > _wait_queue;
+  TimedModule * _receiver;
+
+  // A channel accepts at most one item per cycle and delivers it exactly
+  // _delay - 1 cycles after ReadInputs(), so items in flight are kept in a
+  // ring indexed by the cycle in which they are due. The ring size is the
+  // smallest power of two not below _delay.
+  vector<T *> _ring;
+  int _ring_mask;
+  int _in_flight;
 
 };
 
 template<typename T>
 Channel<T>::Channel(Module * parent, string const & name)
-  : TimedModule(parent, name), _delay(1), _input(0), _output(0) {
+  : TimedModule(parent, name), _delay(1), _input(0), _output(0), _receiver(0),
+    _ring(1, (T *)0), _ring_mask(0), _in_flight(0) {
 }
 
 template<typename T>
@@ -86,12 +109,22 @@ void Channel<T>::SetLatency(int cycles) {
   if(cycles <= 0) {
     Error("Channel must have positive delay.");
   }
+  assert(!_in_flight);
   _delay = cycles ;
+  int size = 1;
+  while(size < _delay) {
+    size *= 2;
+  }
+  _ring.assign(size, (T *)0);
+  _ring_mask = size - 1;
 }
 
 template<typename T>
 void Channel<T>::Send(T * data) {
   _input = data;
+  if(data) {
+    Wake();
+  }
 }
 
 template<typename T>
@@ -101,27 +134,70 @@ T * Channel<T>::Receive() {
 
 template<typename T>
 void Channel<T>::ReadInputs() {
+  ReadInputsAt(GetSimTime());
+}
+
+template<typename T>
+inline void Channel<T>::ReadInputsAt(int time) {
   if(_input) {
-    _wait_queue.push(make_pair(GetSimTime() + _delay - 1, _input));
+    T * & slot = _ring[(time + _delay - 1) & _ring_mask];
+    assert(!slot);
+    slot = _input;
+    ++_in_flight;
     _input = 0;
   }
 }
 
 template<typename T>
 void Channel<T>::WriteOutputs() {
+  WriteOutputsAt(GetSimTime());
+}
+
+template<typename T>
+inline void Channel<T>::WriteOutputsAt(int time) {
   _output = 0;
-  if(_wait_queue.empty()) {
+  if(!_in_flight) {
     return;
   }
-  pair<int, T *> const & item = _wait_queue.front();
-  int const & time = item.first;
-  if(GetSimTime() < time) {
+  T * & slot = _ring[time & _ring_mask];
+  if(!slot) {
     return;
   }
-  assert(GetSimTime() == time);
-  _output = item.second;
-  assert(_output);
-  _wait_queue.pop();
+  _output = slot;
+  slot = 0;
+  --_in_flight;
+  if(_receiver) {
+    _receiver->Wake();
+  }
+}
+
+// items in flight are stored as (due cycle, item) pairs in delivery order
+template<typename T>
+void Channel<T>::Serialize(Checkpoint & ckpt) {
+  ckpt.Sync(_input);
+  ckpt.Sync(_output);
+  int const now = GetSimTime();
+  int n = _in_flight;
+  ckpt.Sync(n);
+  if(ckpt.Loading()) {
+    _ring.assign(_ring.size(), (T *)0);
+    _in_flight = n;
+    for(int i = 0; i < n; ++i) {
+      int time;
+      ckpt.Sync(time);
+      assert((time >= now) && (time < now + (int)_ring.size()));
+      ckpt.Sync(_ring[time & _ring_mask]);
+    }
+  } else {
+    for(int time = now; time < now + (int)_ring.size(); ++time) {
+      T * & slot = _ring[time & _ring_mask];
+      if(slot) {
+        int t = time;
+        ckpt.Sync(t);
+        ckpt.Sync(slot);
+      }
+    }
+  }
 }
 
 #endif
@@ -0,0 +1,363 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "booksim.hpp"
+#include "checkpoint.hpp"
+#include "flit.hpp"
+#include "credit.hpp"
+#include "outputset.hpp"
+#include "packet_reply_info.hpp"
+#include "bit_matrix.hpp"
+
+static int const CHECKPOINT_MAGIC = 0x424b5331; // "BKS1"
+
+Checkpoint::Checkpoint( string const & filename, bool load )
+  : _load(load), _file(NULL), _data(NULL), _size(0), _pos(0)
+{
+  if(_load) {
+    // map the whole file; restoring then only touches the pages it reads
+    int fd = open(filename.c_str(), O_RDONLY);
+    if(fd < 0) {
+      _Error("Unable to open checkpoint " + filename);
+    }
+    struct stat st;
+    if(fstat(fd, &st) < 0) {
+      _Error("Unable to stat checkpoint " + filename);
+    }
+    _size = st.st_size;
+    if(_size > 0) {
+      void * data = mmap(NULL, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if(data == MAP_FAILED) {
+        _Error("Unable to map checkpoint " + filename);
+      }
+      _data = (char const *)data;
+    }
+    close(fd);
+  } else {
+    _file = fopen(filename.c_str(), "wb");
+    if(!_file) {
+      _Error("Unable to create checkpoint " + filename);
+    }
+  }
+  Check(CHECKPOINT_MAGIC, "file format");
+}
+
+Checkpoint::~Checkpoint( )
+{
+  if(_data) {
+    munmap((void *)_data, _size);
+  }
+  if(_file) {
+    if(fclose(_file) != 0) {
+      _Error("Unable to write checkpoint");
+    }
+  }
+}
+
+void Checkpoint::_Error( string const & msg ) const
+{
+  cout << "Error: " << msg << endl;
+  exit(-1);
+}
+
+void Checkpoint::_Raw( void * p, size_t n )
+{
+  if(_load) {
+    if(_pos + n > _size) {
+      _Error("Checkpoint is truncated");
+    }
+    memcpy(p, _data + _pos, n);
+    _pos += n;
+  } else if(fwrite(p, 1, n, _file) != n) {
+    _Error("Unable to write checkpoint");
+  }
+}
+
+int Checkpoint::_SyncSize( size_t n )
+{
+  int size = (int)n;
+  Sync(size);
+  if(size < 0) {
+    _Error("Checkpoint is corrupt");
+  }
+  return size;
+}
+
+void Checkpoint::Check( int value, string const & what )
+{
+  int saved = value;
+  Sync(saved);
+  if(saved != value) {
+    _Error("Checkpoint does not match this configuration (" + what + ")");
+  }
+}
+
+void Checkpoint::Sync( int & v )
+{
+  _Raw(&v, sizeof(v));
+}
+
+void Checkpoint::Sync( long & v )
+{
+  _Raw(&v, sizeof(v));
+}
+
+void Checkpoint::Sync( bool & v )
+{
+  char c = v ? 1 : 0;
+  _Raw(&c, sizeof(c));
+  v = (c != 0);
+}
+
+void Checkpoint::Sync( double & v )
+{
+  _Raw(&v, sizeof(v));
+}
+
+void Checkpoint::Sync( vector<bool> & v )
+{
+  int n = _SyncSize(v.size());
+  v.resize(n);
+  for(int i = 0; i < n; ++i) {
+    bool b = v[i];
+    Sync(b);
+    v[i] = b;
+  }
+}
+
+void Checkpoint::Sync( BitMatrix & m )
+{
+  int const words = m.Rows() * m.Words();
+  Check(words, "bit matrix size");
+  if(words > 0) {
+    _Raw(m.Row(0), words * sizeof(tBitWord));
+  }
+}
+
+void Checkpoint::Sync( Flit *& f )
+{
+  int id = -1;
+  if(_load) {
+    Sync(id);
+    if(id < 0) {
+      f = NULL;
+      return;
+    }
+    if(id < (int)_flits.size()) {
+      f = _flits[id];
+      return;
+    }
+    if(id != (int)_flits.size()) {
+      _Error("Checkpoint is corrupt");
+    }
+    f = Flit::New(NULL);
+    _flits.push_back(f);
+  } else {
+    if(f) {
+      map<Flit *, int>::const_iterator iter = _flit_ids.find(f);
+      if(iter != _flit_ids.end()) {
+        id = iter->second;
+        Sync(id);
+        return;
+      }
+      id = _flit_ids.size();
+      _flit_ids[f] = id;
+    }
+    Sync(id);
+    if(id < 0) {
+      return;
+    }
+  }
+
+  Sync(f->packet);
+  if(_load) {
+    ++f->packet->flits;
+  }
+  Sync(f->vc);
+  Sync(f->head);
+  Sync(f->tail);
+  Sync(f->itime);
+  Sync(f->atime);
+  Sync(f->id);
+  Sync(f->pri);
+  Sync(f->hops);
+  Sync(f->watch);
+}
+
+// the flit count is rebuilt as the flits referencing the packet are loaded
+void Checkpoint::Sync( Packet *& p )
+{
+  int id = -1;
+  if(_load) {
+    Sync(id);
+    if(id < 0) {
+      p = NULL;
+      return;
+    }
+    if(id < (int)_packets.size()) {
+      p = _packets[id];
+      return;
+    }
+    if(id != (int)_packets.size()) {
+      _Error("Checkpoint is corrupt");
+    }
+    p = Packet::New();
+    _packets.push_back(p);
+  } else {
+    if(p) {
+      map<Packet *, int>::const_iterator iter = _packet_ids.find(p);
+      if(iter != _packet_ids.end()) {
+        id = iter->second;
+        Sync(id);
+        return;
+      }
+      id = _packet_ids.size();
+      _packet_ids[p] = id;
+    }
+    Sync(id);
+    if(id < 0) {
+      return;
+    }
+  }
+
+  SyncEnum(p->type);
+  Sync(p->cl);
+  Sync(p->ctime);
+  Sync(p->pid);
+  Sync(p->record);
+  Sync(p->src);
+  Sync(p->dest);
+  Sync(p->subnetwork);
+  Sync(p->intm);
+  Sync(p->ph);
+  Sync(p->la_route_set);
+  Sync(p->head_itime);
+  Sync(p->head_atime);
+  Sync(p->head_id);
+}
+
+void Checkpoint::Sync( Credit *& c )
+{
+  int id = -1;
+  if(_load) {
+    Sync(id);
+    if(id < 0) {
+      c = NULL;
+      return;
+    }
+    if(id < (int)_credits.size()) {
+      c = _credits[id];
+      return;
+    }
+    if(id != (int)_credits.size()) {
+      _Error("Checkpoint is corrupt");
+    }
+    c = Credit::New();
+    _credits.push_back(c);
+  } else {
+    if(c) {
+      map<Credit *, int>::const_iterator iter = _credit_ids.find(c);
+      if(iter != _credit_ids.end()) {
+        id = iter->second;
+        Sync(id);
+        return;
+      }
+      id = _credit_ids.size();
+      _credit_ids[c] = id;
+    }
+    Sync(id);
+    if(id < 0) {
+      return;
+    }
+  }
+
+  Sync(c->vc);
+  Sync(c->head);
+  Sync(c->tail);
+  Sync(c->id);
+}
+
+void Checkpoint::Sync( VCMask & m )
+{
+  int n = _SyncSize(m.Size());
+  if(_load) {
+    m.Clear();
+    for(int i = 0; i < n; ++i) {
+      int vc;
+      Sync(vc);
+      m.Insert(vc);
+    }
+  } else {
+    for(int vc = m.First(); vc >= 0; vc = m.Next(vc)) {
+      Sync(vc);
+    }
+  }
+}
+
+void Checkpoint::Sync( PacketReplyInfo *& r )
+{
+  // pending replies are owned by exactly one queue
+  if(_load) {
+    r = PacketReplyInfo::New();
+  }
+  Sync(r->source);
+  Sync(r->time);
+  Sync(r->record);
+  SyncEnum(r->type);
+}
+
+void Checkpoint::Sync( OutputSet & s )
+{
+  // re-adding the elements in their stored order rebuilds an identical set
+  vector<OutputSet::sSetElement> elements;
+  if(!_load) {
+    elements.assign(s.GetSet().begin(), s.GetSet().end());
+  }
+  int n = _SyncSize(elements.size());
+  elements.resize(n);
+  for(int i = 0; i < n; ++i) {
+    Sync(elements[i].vc_start);
+    Sync(elements[i].vc_end);
+    Sync(elements[i].pri);
+    Sync(elements[i].output_port);
+  }
+  if(_load) {
+    s.Clear();
+    for(int i = 0; i < n; ++i) {
+      s.AddRange(elements[i].output_port, elements[i].vc_start,
+                 elements[i].vc_end, elements[i].pri);
+    }
+  }
+}
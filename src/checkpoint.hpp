@@ -0,0 +1,191 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef _CHECKPOINT_HPP_
+#define _CHECKPOINT_HPP_
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <deque>
+#include <list>
+#include <queue>
+#include <map>
+#include <set>
+
+using namespace std;
+
+class Flit;
+class Packet;
+class Credit;
+class VCMask;
+class OutputSet;
+class PacketReplyInfo;
+class BitMatrix;
+template<class T> class RingQueue;
+
+// A binary snapshot of the simulation state. The same Serialize() code is
+// used in both directions: when saving, Sync() appends each value to the
+// file; when loading, it overwrites the value with the next one read from
+// the (memory-mapped) file. Flits, packets and credits may be referenced
+// from several places and are stored once, on first reference, so that pointer
+// identity is preserved across a restore.
+class Checkpoint {
+
+public:
+  Checkpoint( string const & filename, bool load );
+  ~Checkpoint( );
+
+  inline bool Loading( ) const {return _load;}
+
+  // records a value on save and fails the restore if it differs on load;
+  // used to reject checkpoints taken with a different configuration
+  void Check( int value, string const & what );
+
+  void Sync( int & v );
+  void Sync( long & v );
+  void Sync( bool & v );
+  void Sync( double & v );
+  void Sync( Flit *& f );
+  void Sync( Packet *& p );
+  void Sync( Credit *& c );
+  void Sync( VCMask & m );
+  void Sync( PacketReplyInfo *& r );
+  void Sync( OutputSet & s );
+  void Sync( vector<bool> & v );
+  void Sync( BitMatrix & m );
+
+  template<class T> void SyncEnum( T & v ) {
+    int i = (int)v;
+    Sync(i);
+    v = (T)i;
+  }
+
+  template<class A, class B> void Sync( pair<A, B> & p ) {
+    Sync(p.first);
+    Sync(p.second);
+  }
+
+  template<class T> void Sync( vector<T> & v ) {
+    int n = _SyncSize(v.size());
+    v.resize(n);
+    for(int i = 0; i < n; ++i) {
+      Sync(v[i]);
+    }
+  }
+
+  template<class T> void Sync( deque<T> & d ) {
+    int n = _SyncSize(d.size());
+    d.resize(n);
+    for(int i = 0; i < n; ++i) {
+      Sync(d[i]);
+    }
+  }
+
+  template<class T> void Sync( RingQueue<T> & q ) {
+    int n = _SyncSize(q.size());
+    q.resize(n);
+    for(int i = 0; i < n; ++i) {
+      Sync(q[i]);
+    }
+  }
+
+  template<class T, class A> void Sync( list<T, A> & l ) {
+    int n = _SyncSize(l.size());
+    l.resize(n);
+    for(typename list<T, A>::iterator iter = l.begin(); iter != l.end(); ++iter) {
+      Sync(*iter);
+    }
+  }
+
+  template<class T> void Sync( queue<T> & q ) {
+    deque<T> items;
+    if(!_load) {
+      for(queue<T> copy = q; !copy.empty(); copy.pop()) {
+        items.push_back(copy.front());
+      }
+    }
+    Sync(items);
+    q = queue<T>(items);
+  }
+
+  template<class T, class C, class A> void Sync( set<T, C, A> & s ) {
+    int n = _SyncSize(s.size());
+    if(_load) {
+      s.clear();
+      for(int i = 0; i < n; ++i) {
+        T value;
+        Sync(value);
+        s.insert(value);
+      }
+    } else {
+      for(typename set<T, C, A>::iterator iter = s.begin(); iter != s.end(); ++iter) {
+        T value = *iter;
+        Sync(value);
+      }
+    }
+  }
+
+  template<class K, class V, class C, class A> void Sync( map<K, V, C, A> & m ) {
+    int n = _SyncSize(m.size());
+    if(_load) {
+      m.clear();
+      for(int i = 0; i < n; ++i) {
+        K key;
+        Sync(key);
+        Sync(m[key]);
+      }
+    } else {
+      for(typename map<K, V, C, A>::iterator iter = m.begin(); iter != m.end(); ++iter) {
+        K key = iter->first;
+        Sync(key);
+        Sync(iter->second);
+      }
+    }
+  }
+
+private:
+  bool _load;
+
+  FILE * _file;
+  char const * _data;
+  size_t _size;
+  size_t _pos;
+
+  map<Flit *, int> _flit_ids;
+  vector<Flit *> _flits;
+  map<Packet *, int> _packet_ids;
+  vector<Packet *> _packets;
+  map<Credit *, int> _credit_ids;
+  vector<Credit *> _credits;
+
+  void _Raw( void * p, size_t n );
+  int  _SyncSize( size_t n );
+  void _Error( string const & msg ) const;
+};
+
+#endif
@@ -5,6 +5,10 @@ void yyerror(char * msg);
 void config_assign_string( char const * field, char const * value );
 void config_assign_int( char const * field, int value );
 void config_assign_float( char const * field, double value );
+void config_assign_list( char const * field );
+void config_add_list_string( char const * value );
+void config_add_list_number( double value );
+void config_add_list_range( double start, double step, double end );
 
 #ifdef _WIN32
 #pragma warning ( disable : 4102 )
@@ -23,6 +27,8 @@ void config_assign_float( char const * field, double value );
 %token <num>  NUM
 %token <fnum> FNUM
 
+%type <fnum> number
+
 %%
 
 commands : commands command
@@ -32,6 +38,22 @@ commands : commands command
 command : STR '=' STR ';'   { config_assign_string( $1, $3 ); free( $1 ); free( $3 ); }
         | STR '=' NUM ';'   { config_assign_int( $1, $3 ); free( $1 ); }
         | STR '=' FNUM ';'  { config_assign_float( $1, $3 ); free( $1 ); }
+        | STR '=' '[' values ']' ';' { config_assign_list( $1 ); free( $1 ); }
+;
+
+values : values value
+       | values ',' value
+       | value
+;
+
+value : STR                           { config_add_list_string( $1 ); free( $1 ); }
+      | number                        { config_add_list_number( $1 ); }
+      | number ':' number             { config_add_list_range( $1, 1.0, $3 ); }
+      | number ':' number ':' number  { config_add_list_range( $1, $3, $5 ); }
+;
+
+number : NUM   { $$ = $1; }
+       | FNUM  { $$ = $1; }
 ;
 
 %%
@@ -88,6 +88,119 @@ void Configuration::Assign(string const & field, double value)
   }
 }
 
+// Adds a list element; unbraced commas separate elements, so both
+// "[a,b]" and "[a b]" give two values.
+void Configuration::AddListValue(string const & value)
+{
+  size_t start = 0;
+  int nested = 0;
+  for(size_t curr = 0; curr <= value.size(); ++curr) {
+    if(curr == value.size() || (value[curr] == ',' && !nested)) {
+      if(curr > start) {
+        _list.push_back(value.substr(start, curr - start));
+      }
+      start = curr + 1;
+    } else if(value[curr] == '{' || value[curr] == '(') {
+      ++nested;
+    } else if(value[curr] == '}' || value[curr] == ')') {
+      --nested;
+    }
+  }
+}
+
+void Configuration::AddListRange(double start, double step, double end)
+{
+  if(step <= 0.0 || end < start) {
+    ParseError("Invalid range in value list");
+  }
+  int const count = int((end - start) / step + 1e-9) + 1;
+  for(int i = 0; i < count; ++i) {
+    ostringstream value;
+    value.precision(15);
+    value << start + i * step;
+    _list.push_back(value.str());
+  }
+}
+
+void Configuration::AssignList(string const & field)
+{
+  if(_str_map.count(field) == 0 && _int_map.count(field) == 0 &&
+     _float_map.count(field) == 0) {
+    ParseError("Unknown field: " + field);
+  }
+  ClearList(field);
+  _grid.push_back(make_pair(field, _list));
+  _list.clear();
+}
+
+void Configuration::ClearList(string const & field)
+{
+  for(size_t i = 0; i < _grid.size(); ++i) {
+    if(_grid[i].first == field) {
+      _grid.erase(_grid.begin() + i);
+      return;
+    }
+  }
+}
+
+// Number of combinations of all value lists.
+int Configuration::GridSize() const
+{
+  int size = 1;
+  for(size_t i = 0; i < _grid.size(); ++i) {
+    size *= _grid[i].second.size();
+  }
+  return size;
+}
+
+// Assigns the values of one combination; the first list varies slowest.
+// Numeric values go to the integer or float field of that name (clearing
+// any vector specification), anything else to the string field.
+void Configuration::AssignGridPoint(int point)
+{
+  for(int i = _grid.size() - 1; i >= 0; --i) {
+    string const & field = _grid[i].first;
+    vector<string> const & values = _grid[i].second;
+    string const & value = values[point % values.size()];
+    point /= values.size();
+
+    char * end;
+    double const number = strtod(value.c_str(), &end);
+    bool const numeric = (*end == '\0');
+    if(numeric && _int_map.count(field)) {
+      if(number != (double)(int)number) {
+        ParseError("Non-integer value for integer field: " + field);
+      }
+      _int_map[field] = (int)number;
+      if(_str_map.count(field)) {
+        _str_map[field] = "";
+      }
+    } else if(numeric && _float_map.count(field)) {
+      _float_map[field] = number;
+      if(_str_map.count(field)) {
+        _str_map[field] = "";
+      }
+    } else {
+      Assign(field, value);
+    }
+  }
+}
+
+string Configuration::GridPointName(int point) const
+{
+  vector<string> names(_grid.size());
+  for(int i = _grid.size() - 1; i >= 0; --i) {
+    vector<string> const & values = _grid[i].second;
+    names[i] = _grid[i].first + " = " + values[point % values.size()] + ";";
+    point /= values.size();
+  }
+  string name;
+  for(size_t i = 0; i < names.size(); ++i) {
+    name += (i ? " " : "") + names[i];
+  }
+  return name;
+}
+
 string Configuration::GetStr(string const & field) const
 {
   map<string, string>::const_iterator match;
@@ -206,19 +319,45 @@ extern "C" void config_error( char const * msg, int lineno )
 
 extern "C" void config_assign_string( char const * field, char const * value )
 {
+  Configuration::GetTheConfig()->ClearList(field);
   Configuration::GetTheConfig()->Assign(field, value);
 }
 
 extern "C" void config_assign_int( char const * field, int value )
 {
+  Configuration::GetTheConfig()->ClearList(field);
   Configuration::GetTheConfig()->Assign(field, value);
 }
 
 extern "C" void config_assign_float( char const * field, double value )
 {
+  Configuration::GetTheConfig()->ClearList(field);
   Configuration::GetTheConfig()->Assign(field, value);
 }
 
+extern "C" void config_assign_list( char const * field )
+{
+  Configuration::GetTheConfig()->AssignList(field);
+}
+
+extern "C" void config_add_list_string( char const * value )
+{
+  Configuration::GetTheConfig()->AddListValue(value);
+}
+
+extern "C" void config_add_list_number( double value )
+{
+  ostringstream os;
+  os.precision(15);
+  os << value;
+  Configuration::GetTheConfig()->AddListValue(os.str());
+}
+
+extern "C" void config_add_list_range( double start, double step, double end )
+{
+  Configuration::GetTheConfig()->AddListRange(start, step, end);
+}
+
 extern "C" int config_input(char * line, int max_size)
 {
   return Configuration::GetTheConfig()->Input(line, max_size);
@@ -46,6 +46,10 @@ protected:
   map<string,string> _str_map;
   map<string,int>    _int_map;
   map<string,double> _float_map;
+
+  // value lists given as "field = [a b c];", in order of appearance
+  vector<pair<string, vector<string> > > _grid;
+  vector<string> _list;
   
 public:
   Configuration();
@@ -56,6 +60,18 @@ public:
   void Assign(string const & field, int value);
   void Assign(string const & field, double value);
 
+  void AddListValue(string const & value);
+  void AddListRange(double start, double step, double end);
+  void AssignList(string const & field);
+  void ClearList(string const & field);
+
+  inline bool HasGrid() const {
+    return !_grid.empty();
+  }
+  int GridSize() const;
+  void AssignGridPoint(int point);
+  string GridPointName(int point) const;
+
   string GetStr(string const & field) const;
   int GetInt(string const & field) const;
   double GetFloat(string const & field) const;
@@ -33,8 +33,36 @@
 #include "booksim.hpp"
 #include "credit.hpp"
 
-stack<Credit *> Credit::_all;
-stack<Credit *> Credit::_free;
+int VCMask::_extra_words = 0;
+
+void VCMask::SetVCs( int vcs )
+{
+  _extra_words = (vcs > 64) ? ((vcs - 1) >> 6) : 0;
+}
+
+void VCMask::_ClearMore( )
+{
+  if(_more_words < _extra_words) {
+    delete [] _more;
+    _more = new unsigned long long[_extra_words];
+    _more_words = _extra_words;
+  }
+  for(int i = 0; i < _extra_words; ++i) {
+    _more[i] = 0;
+  }
+}
+
+int VCMask::_FindMore( int vc ) const
+{
+  int i = (vc >> 6) - 1;
+  if(i >= _extra_words) return -1;
+  unsigned long long w = _more[i] & (~0ULL << (vc & 63));
+  while(!w) {
+    if(++i >= _extra_words) return -1;
+    w = _more[i];
+  }
+  return ((i + 1) << 6) + __builtin_ctzll(w);
+}
 
 Credit::Credit()
 {
@@ -43,37 +71,29 @@ Credit::Credit()
 
 void Credit::Reset()
 {
-  vc.clear();
+  vc.Clear();
   head = false;
   tail = false;
   id   = -1;
 }
 
+// routers allocate and free credits while the network is being stepped by
+// several threads; the pool keeps a free list per thread
 Credit * Credit::New() {
-  Credit * c;
-  if(_free.empty()) {
-    c = new Credit();
-    _all.push(c);
-  } else {
-    c = _free.top();
-    c->Reset();
-    _free.pop();
-  }
+  Credit * c = SlabPool<Credit>::New();
+  c->Reset();
   return c;
 }
 
 void Credit::Free() {
-  _free.push(this);
+  SlabPool<Credit>::Free(this);
 }
 
 void Credit::FreeAll() {
-  while(!_all.empty()) {
-    delete _all.top();
-    _all.pop();
-  }
+  SlabPool<Credit>::FreeAll();
 }
 
 
 int Credit::OutStanding(){
-  return _all.size()-_free.size();
+  return SlabPool<Credit>::Live();
 }
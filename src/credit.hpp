@@ -28,14 +28,88 @@
 #ifndef _CREDIT_HPP_
 #define _CREDIT_HPP_
 
-#include <set>
-#include <stack>
+#include "slab_pool.hpp"
+
+// Set of VCs returned by a credit. Credits are created and processed every
+// cycle, so the set is a bitmask stored in the credit itself. The first 64
+// VCs live in a single inline word; with more VCs (see SetVCs), each mask
+// keeps the rest in an array that is allocated the first time the credit
+// object is used and then reused along with it.
+class VCMask {
+
+public:
+  VCMask( ) : _bits(0), _more(0), _more_words(0) { }
+  ~VCMask( ) { delete [] _more; }
+
+  // number of VCs the masks must be able to hold
+  static void SetVCs( int vcs );
+
+  inline void Clear( ) {
+    _bits = 0;
+    if(_extra_words) {
+      _ClearMore( );
+    }
+  }
+  inline void Insert( int vc ) {
+    if(vc < 64) {
+      _bits |= 1ULL << vc;
+    } else {
+      _more[(vc >> 6) - 1] |= 1ULL << (vc & 63);
+    }
+  }
+  inline bool Contains( int vc ) const {
+    if(vc < 64) {
+      return (_bits >> vc) & 1;
+    }
+    return (_more[(vc >> 6) - 1] >> (vc & 63)) & 1;
+  }
+  inline bool Empty( ) const {
+    if(_bits) return false;
+    for(int i = 0; i < _extra_words; ++i) if(_more[i]) return false;
+    return true;
+  }
+  inline int Size( ) const {
+    int n = __builtin_popcountll(_bits);
+    for(int i = 0; i < _extra_words; ++i) n += __builtin_popcountll(_more[i]);
+    return n;
+  }
+
+  // iterate in ascending order:
+  //   for(int vc = m.First(); vc >= 0; vc = m.Next(vc))
+  inline int First( ) const { return _Find(0); }
+  inline int Next( int vc ) const { return _Find(vc + 1); }
+
+private:
+  // words needed beyond the inline one, for all masks
+  static int _extra_words;
+
+  unsigned long long _bits;
+  unsigned long long * _more;
+  int _more_words;
+
+  // masks are stored inside credits and never copied
+  VCMask( VCMask const & );
+  VCMask & operator=( VCMask const & );
+
+  void _ClearMore( );
+  int _FindMore( int vc ) const;
+
+  inline int _Find( int vc ) const {
+    if(vc < 64) {
+      unsigned long long const w = _bits & (~0ULL << vc);
+      if(w) return __builtin_ctzll(w);
+      if(!_extra_words) return -1;
+      vc = 64;
+    }
+    return _FindMore(vc);
+  }
+};
 
 class Credit {
 
 public:
 
-  set<int> vc;
+  VCMask vc;
 
   // these are only used by the event router
   bool head, tail;
@@ -49,8 +123,7 @@ public:
   static int OutStanding();
 private:
 
-  static stack<Credit *> _all;
-  static stack<Credit *> _free;
+  friend class SlabPool<Credit>;
 
   Credit();
   ~Credit() {}
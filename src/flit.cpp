@@ -37,18 +37,16 @@
 #include "booksim.hpp"
 #include "flit.hpp"
 
-stack<Flit *> Flit::_all;
-stack<Flit *> Flit::_free;
-
 ostream& operator<<( ostream& os, const Flit& f )
 {
+  Packet const * p = f.packet;
   os << "  Flit ID: " << f.id << " (" << &f << ")" 
-     << " Packet ID: " << f.pid
-     << " Type: " << f.type 
+     << " Packet ID: " << p->pid
+     << " Type: " << p->type 
      << " Head: " << f.head
      << " Tail: " << f.tail << endl;
-  os << "  Source: " << f.src << "  Dest: " << f.dest << " Intm: "<<f.intm<<endl;
-  os << "  Creation time: " << f.ctime << " Injection time: " << f.itime << " Arrival time: " << f.atime << " Phase: "<<f.ph<< endl;
+  os << "  Source: " << p->src << "  Dest: " << p->dest << " Intm: "<<p->intm<<endl;
+  os << "  Creation time: " << p->ctime << " Injection time: " << f.itime << " Arrival time: " << f.atime << " Phase: "<<p->ph<< endl;
   os << "  VC: " << f.vc << endl;
   return os;
 }
@@ -60,48 +58,74 @@ Flit::Flit()
 
 void Flit::Reset() 
 {  
-  type      = ANY_TYPE ;
+  packet    = 0 ;
   vc        = -1 ;
-  cl        = -1 ;
   head      = false ;
   tail      = false ;
-  ctime     = -1 ;
   itime     = -1 ;
   atime     = -1 ;
   id        = -1 ;
-  pid       = -1 ;
   hops      = 0 ;
   watch     = false ;
-  record    = false ;
-  intm = 0;
-  src = -1;
-  dest = -1;
   pri = 0;
-  intm =-1;
-  ph = -1;
   data = 0;
 }  
 
-Flit * Flit::New() {
-  Flit * f;
-  if(_free.empty()) {
-    f = new Flit;
-    _all.push(f);
-  } else {
-    f = _free.top();
-    f->Reset();
-    _free.pop();
+Flit * Flit::New(Packet * packet) {
+  Flit * f = SlabPool<Flit>::New();
+  f->Reset();
+  f->packet = packet;
+  if(packet) {
+    ++packet->flits;
   }
   return f;
 }
 
 void Flit::Free() {
-  _free.push(this);
+  if(packet && (--packet->flits == 0)) {
+    packet->Free();
+  }
+  SlabPool<Flit>::Free(this);
 }
 
 void Flit::FreeAll() {
-  while(!_all.empty()) {
-    delete _all.top();
-    _all.pop();
-  }
+  SlabPool<Flit>::FreeAll();
+}
+
+Packet::Packet()
+{
+  Reset();
+}
+
+void Packet::Reset()
+{
+  type      = Flit::ANY_TYPE ;
+  cl        = -1 ;
+  ctime     = -1 ;
+  pid       = -1 ;
+  record    = false ;
+  src = -1;
+  dest = -1;
+  subnetwork = -1;
+  intm =-1;
+  ph = -1;
+  la_route_set.Clear();
+  head_itime = -1;
+  head_atime = -1;
+  head_id = -1;
+  flits = 0;
+}
+
+Packet * Packet::New() {
+  Packet * p = SlabPool<Packet>::New();
+  p->Reset();
+  return p;
+}
+
+void Packet::Free() {
+  SlabPool<Packet>::Free(this);
+}
+
+void Packet::FreeAll() {
+  SlabPool<Packet>::FreeAll();
 }
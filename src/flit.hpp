@@ -29,10 +29,12 @@
 #define _FLIT_HPP_
 
 #include <iostream>
-#include <stack>
 
 #include "booksim.hpp"
 #include "outputset.hpp"
+#include "slab_pool.hpp"
+
+class Packet;
 
 class Flit {
 
@@ -44,20 +46,56 @@ public:
 		  WRITE_REQUEST = 2,
 		  WRITE_REPLY   = 3,
                   ANY_TYPE      = 4 };
-  FlitType type;
 
-  int vc;
+  // state shared by all flits of the packet
+  Packet * packet;
 
-  int cl;
+  int vc;
 
   bool head;
   bool tail;
+  bool watch;
   
-  int  ctime;
   int  itime;
   int  atime;
 
   int  id;
+
+  int  pri;
+
+  int  hops;
+
+  // Fields for arbitrary data
+  void* data ;
+
+  void Reset();
+
+  static Flit * New(Packet * packet);
+  void Free();
+  static void FreeAll();
+
+private:
+
+  friend class SlabPool<Flit>;
+
+  Flit();
+  ~Flit() {}
+
+};
+
+// Per-packet state, referenced by every flit of the packet and freed along
+// with the last of them. Only the head flit is routed, so the routing
+// fields are only meaningful while the head is in the network.
+class Packet {
+
+public:
+
+  Flit::FlitType type;
+
+  int cl;
+
+  int  ctime;
+
   int  pid;
 
   bool record;
@@ -65,37 +103,38 @@ public:
   int  src;
   int  dest;
 
-  int  pri;
-
-  int  hops;
-  bool watch;
   int  subnetwork;
-  
+
   // intermediate destination (if any)
-  mutable int intm;
+  int intm;
 
   // phase in multi-phase algorithms
-  mutable int ph;
-
-  // Fields for arbitrary data
-  void* data ;
+  int ph;
 
   // Lookahead route info
   OutputSet la_route_set;
 
+  // injection and arrival time and ID of the head flit, recorded when the
+  // head is retired so the tail can compute packet statistics
+  int  head_itime;
+  int  head_atime;
+  int  head_id;
+
+  // flits still referencing this packet
+  int  flits;
+
   void Reset();
 
-  static Flit * New();
+  static Packet * New();
   void Free();
   static void FreeAll();
 
 private:
 
-  Flit();
-  ~Flit() {}
+  friend class SlabPool<Packet>;
 
-  static stack<Flit *> _all;
-  static stack<Flit *> _free;
+  Packet();
+  ~Packet() {}
 
 };
 
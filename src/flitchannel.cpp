@@ -63,7 +63,7 @@ void FlitChannel::SetSink(Router const * const router, int port) {
 
 void FlitChannel::Send(Flit * f) {
   if(f) {
-    ++_active[f->cl];
+    ++_active[f->packet->cl];
   } else {
     ++_idle;
   }
@@ -71,21 +71,28 @@ void FlitChannel::Send(Flit * f) {
 }
 
 void FlitChannel::ReadInputs() {
-  Flit const * const & f = _input;
-  if(f && f->watch) {
-    *gWatchOut << GetSimTime() << " | " << FullName() << " | "
-	       << "Beginning channel traversal for flit " << f->id
-	       << " with delay " << _delay
-	       << "." << endl;
-  }
-  Channel<Flit>::ReadInputs();
+  ReadInputsAt(GetSimTime());
 }
 
 void FlitChannel::WriteOutputs() {
-  Channel<Flit>::WriteOutputs();
-  if(_output && _output->watch) {
-    *gWatchOut << GetSimTime() << " | " << FullName() << " | "
-	       << "Completed channel traversal for flit " << _output->id
-	       << "." << endl;
-  }
+  WriteOutputsAt(GetSimTime());
+}
+
+void FlitChannel::_WatchBegin(int time) const {
+  *gWatchOut << time << " | " << FullName() << " | "
+	     << "Beginning channel traversal for flit " << _input->id
+	     << " with delay " << _delay
+	     << "." << endl;
+}
+
+void FlitChannel::_WatchEnd(int time) const {
+  *gWatchOut << time << " | " << FullName() << " | "
+	     << "Completed channel traversal for flit " << _output->id
+	     << "." << endl;
+}
+
+void FlitChannel::Serialize(Checkpoint & ckpt) {
+  Channel<Flit>::Serialize(ckpt);
+  ckpt.Sync(_active);
+  ckpt.Sync(_idle);
 }
@@ -78,7 +78,25 @@ public:
   virtual void ReadInputs();
   virtual void WriteOutputs();
 
+  inline void ReadInputsAt(int time) {
+    if(_input && _input->watch) {
+      _WatchBegin(time);
+    }
+    Channel<Flit>::ReadInputsAt(time);
+  }
+  inline void WriteOutputsAt(int time) {
+    Channel<Flit>::WriteOutputsAt(time);
+    if(_output && _output->watch) {
+      _WatchEnd(time);
+    }
+  }
+
+  virtual void Serialize(Checkpoint & ckpt);
+
 private:
+
+  void _WatchBegin(int time) const;
+  void _WatchEnd(int time) const;
   
   ////////////////////////////////////////
   //
@@ -31,6 +31,7 @@
 #include <limits>
 #include "random_utils.hpp"
 #include "injection.hpp"
+#include "checkpoint.hpp"
 
 using namespace std;
 
@@ -188,3 +189,8 @@ bool OnOffInjectionProcess::test(int source)
   // generate packet
   return _state[source] && (RandomFloat() < _r1);
 }
+
+void OnOffInjectionProcess::Serialize(Checkpoint & ckpt)
+{
+  ckpt.Sync(_state);
+}
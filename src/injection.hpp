@@ -32,6 +32,8 @@
 
 using namespace std;
 
+class Checkpoint;
+
 class InjectionProcess {
 protected:
   int _nodes;
@@ -41,6 +43,7 @@ public:
   virtual ~InjectionProcess() {}
   virtual bool test(int source) = 0;
   virtual void reset();
+  virtual void Serialize(Checkpoint & ckpt) {}
   static InjectionProcess * New(string const & inject, int nodes, double load, 
 				Configuration const * const config = NULL);
 };
@@ -63,6 +66,7 @@ public:
 			double r1, vector<int> initial);
   virtual void reset();
   virtual bool test(int source);
+  virtual void Serialize(Checkpoint & ckpt);
 };
 
 #endif 
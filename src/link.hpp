@@ -0,0 +1,82 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// ----------------------------------------------------------------------
+//
+//  Link: pairs a flit channel with the credit channel that runs in the
+//        opposite direction so the network steps both as one module.
+//        The channels keep their own source/sink ports and latencies;
+//        the link only forwards the per-cycle phases to them.
+//
+// ----------------------------------------------------------------------
+
+#ifndef _LINK_HPP_
+#define _LINK_HPP_
+
+#include "timed_module.hpp"
+#include "flitchannel.hpp"
+#include "channel.hpp"
+#include "credit.hpp"
+
+typedef Channel<Credit> CreditChannel;
+
+class Link : public TimedModule {
+
+public:
+  Link(Module * parent, string const & name,
+       FlitChannel * flits, CreditChannel * credits);
+
+  FlitChannel * GetFlitChannel() const { return _flits; }
+  CreditChannel * GetCreditChannel() const { return _credits; }
+
+  void ReadInputs() { ReadInputsAt(GetSimTime()); }
+  void Evaluate(int, TrafficManager*) {}
+  void WriteOutputs() { WriteOutputsAt(GetSimTime()); }
+
+  inline void ReadInputsAt(int time) {
+    _flits->ReadInputsAt(time);
+    _credits->ReadInputsAt(time);
+  }
+  inline void WriteOutputsAt(int time) {
+    _flits->WriteOutputsAt(time);
+    _credits->WriteOutputsAt(time);
+  }
+
+  bool Idle() const {
+    return _flits->Channel<Flit>::Idle() && _credits->CreditChannel::Idle();
+  }
+
+  void SetWakeSet(ActiveSet * s, int index);
+
+  void Serialize(Checkpoint & ckpt);
+
+private:
+  FlitChannel * _flits;
+  CreditChannel * _credits;
+};
+
+#endif
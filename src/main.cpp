@@ -35,11 +35,19 @@
  *
  */
 #include <sys/time.h>
+#include <sys/wait.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <poll.h>
 
 #include <string>
 #include <cstdlib>
 #include <iostream>
 #include <fstream>
+#include <map>
+#include <cstdio>
+#include <cerrno>
+#include <iterator>
 
 
 
@@ -53,6 +61,7 @@
 #include "network.hpp"
 #include "injection.hpp"
 #include "power_module.hpp"
+#include "arbiter_bench.hpp"
 
 
 
@@ -94,6 +103,198 @@ ostream * gWatchOut;
 
 /////////////////////////////////////////////////////////////////////////////
 
+struct SweepPoint {
+  pid_t pid;
+  int fd;
+  bool stable;
+  string csv;
+};
+
+// Runs a single injection rate in a child process. The parent never steps
+// the networks, so every child starts from the same freshly built state
+// and produces exactly what a standalone run at that rate would.
+static void StartSweepPoint( BookSimConfig const & config, vector<Network *> const & net,
+                             double rate, SweepPoint & point )
+{
+  int fd[2];
+  if(pipe(fd) < 0) {
+    cerr << "Unable to create pipe for sweep child" << endl;
+    exit(-1);
+  }
+  cout.flush();
+  pid_t pid = fork();
+  if(pid < 0) {
+    cerr << "Unable to fork sweep child" << endl;
+    exit(-1);
+  }
+  if(pid == 0) {
+    close(fd[0]);
+    BookSimConfig point_config = config;
+    point_config.Assign("injection_rate", rate);
+    point_config.Assign("injection_rate", string(""));
+    ostringstream log;
+    cout.rdbuf(log.rdbuf());
+    trafficManager = TrafficManager::New( point_config, net );
+    bool stable = trafficManager->Run();
+    string result(1, stable ? 1 : 0);
+    if(stable) {
+      ostringstream csv;
+      trafficManager->DisplayOverallStatsCSV(csv);
+      result += csv.str();
+    }
+    char const * p = result.data();
+    size_t left = result.size();
+    while(left > 0) {
+      ssize_t n = write(fd[1], p, left);
+      if(n < 0) {
+        _exit(1);
+      }
+      p += n;
+      left -= n;
+    }
+    _exit(0);
+  }
+  close(fd[1]);
+  point.pid = pid;
+  point.fd = fd[0];
+}
+
+static void FinishSweepPoint( SweepPoint & point )
+{
+  string result;
+  char buf[4096];
+  ssize_t n;
+  while((n = read(point.fd, buf, sizeof(buf))) != 0) {
+    if(n < 0) {
+      cerr << "Unable to read from sweep child" << endl;
+      exit(-1);
+    }
+    result.append(buf, n);
+  }
+  close(point.fd);
+  int status;
+  waitpid(point.pid, &status, 0);
+  if(result.empty()) {
+    cerr << "Sweep child exited unexpectedly" << endl;
+    exit(-1);
+  }
+  point.stable = result[0];
+  point.csv = result.substr(1);
+}
+
+// Latency field of a results line, the one utils/sweep.sh reports.
+static double SweepLatency( string const & csv )
+{
+  size_t pos = 0;
+  for(int i = 0; i < 5; ++i) {
+    pos = csv.find(',', pos) + 1;
+  }
+  return atof(csv.c_str() + pos);
+}
+
+// Searches for the saturation rate between sweep_min_step and 1. Each round
+// simulates sweep_jobs evenly spaced rates in the current bracket
+// concurrently and narrows the bracket to the gap between the highest
+// stable and the lowest unstable rate, until it is below sweep_min_step.
+// Until a rate turns out unstable, the top of the bracket is simulated too.
+bool Sweep( BookSimConfig const & config, vector<Network *> const & net )
+{
+  int const jobs = config.GetInt("sweep_jobs");
+  double const min_step = config.GetFloat("sweep_min_step");
+  if(jobs < 1) {
+    cerr << "sweep_jobs must be positive" << endl;
+    return false;
+  }
+  if(min_step <= 0.0 || min_step >= 1.0) {
+    cerr << "sweep_min_step must be between 0 and 1" << endl;
+    return false;
+  }
+
+  BookSimConfig sweep_config = config;
+  if((config.GetStr("stats_out") != "") ||
+     (config.GetStr("checkpoint_out") != "") ||
+     (config.GetStr("checkpoint_in") != "")) {
+    cout << "WARNING: Statistics and checkpoint files are not written in sweep mode." << endl;
+    sweep_config.Assign("stats_out", "");
+    sweep_config.Assign("checkpoint_out", "");
+    sweep_config.Assign("checkpoint_in", "");
+  }
+
+  map<double, SweepPoint> points;
+  double lo = 0.0;
+  double hi = 1.0;
+  bool hi_known = false;
+
+  // the lowest rate of the first round also measures zero-load latency
+  vector<double> rates;
+  rates.push_back(min_step);
+  for(int i = 1; i < jobs; ++i) {
+    rates.push_back((double)i / (double)jobs);
+  }
+
+  while(!rates.empty()) {
+    for(size_t i = 0; i < rates.size(); i += jobs) {
+      size_t const end = min(rates.size(), i + jobs);
+      for(size_t j = i; j < end; ++j) {
+        cout << "SWEEP: Simulating injection rate " << rates[j] << "..." << endl;
+        StartSweepPoint(sweep_config, net, rates[j], points[rates[j]]);
+      }
+      for(size_t j = i; j < end; ++j) {
+        SweepPoint & point = points[rates[j]];
+        FinishSweepPoint(point);
+        cout << "SWEEP: Injection rate " << rates[j] << " is "
+             << (point.stable ? "stable" : "unstable") << "." << endl;
+      }
+    }
+
+    // rates past the first unstable one are treated as unstable too
+    for(map<double, SweepPoint>::const_iterator iter = points.begin();
+        iter != points.end(); ++iter) {
+      if(!iter->second.stable) {
+        hi = iter->first;
+        hi_known = true;
+        break;
+      }
+      lo = iter->first;
+    }
+
+    rates.clear();
+    if(hi_known ? (hi - lo <= min_step) : (lo >= hi)) {
+      break;
+    }
+    int const slots = hi_known ? (jobs + 1) : jobs;
+    double const step = max((hi - lo) / (double)slots, min_step);
+    for(double rate = lo + step; rate < hi - 0.5 * min_step; rate += step) {
+      rates.push_back(rate);
+    }
+    if(!hi_known) {
+      rates.push_back(hi);
+    } else if(rates.empty()) {
+      // the bracket is too narrow for another step, so split it
+      rates.push_back(0.5 * (lo + hi));
+    }
+  }
+
+  cout << "SWEEP: Latency-throughput curve:" << endl;
+  for(map<double, SweepPoint>::const_iterator iter = points.begin();
+      iter != points.end() && iter->second.stable; ++iter) {
+    cout << iter->second.csv;
+  }
+
+  SweepPoint const & zero_load = points[min_step];
+  if(!zero_load.stable) {
+    cout << "SWEEP: Zero-load simulation is unstable." << endl;
+    return false;
+  }
+  cout << "SWEEP: Zero-load latency is " << SweepLatency(zero_load.csv) << "." << endl;
+  if(hi_known) {
+    cout << "SWEEP: Saturation throughput is between " << lo << " and " << hi << "." << endl;
+  } else {
+    cout << "SWEEP: Network does not saturate." << endl;
+  }
+  return true;
+}
+
 bool Simulate( BookSimConfig const & config )
 {
   vector<Network *> net;
@@ -114,7 +315,6 @@ bool Simulate( BookSimConfig const & config )
    */
 
   assert(trafficManager == NULL);
-  trafficManager = TrafficManager::New( config, net ) ;
 
   /*Start the simulation run
    */
@@ -124,7 +324,14 @@ bool Simulate( BookSimConfig const & config )
   total_time = 0.0;
   gettimeofday(&start_time, NULL);
 
-  bool result = trafficManager->Run() ;
+  bool const sweep = (config.GetInt("sweep") > 0);
+  bool result;
+  if(sweep) {
+    result = Sweep( config, net );
+  } else {
+    trafficManager = TrafficManager::New( config, net ) ;
+    result = trafficManager->Run() ;
+  }
 
 
   gettimeofday(&end_time, NULL);
@@ -136,7 +343,7 @@ bool Simulate( BookSimConfig const & config )
   for (int i=0; i<subnets; ++i) {
 
     ///Power analysis
-    if(config.GetInt("sim_power") > 0){
+    if(!sweep && (config.GetInt("sim_power") > 0)){
       Power_Module pnet(net[i], config);
       pnet.run();
     }
@@ -150,20 +357,8 @@ bool Simulate( BookSimConfig const & config )
   return result;
 }
 
-//在debug模式下，CLion可以配置程序运行的参数（Edit configurations->program arguments），通过运行参数可指定booksim的配置文件
-//写配置文件相对路径时要注意程序的默认路径为可执行文件"booksim2"所在的路径（即argv[0]）
-int main( int argc, char **argv )
+static void Initialize( BookSimConfig const & config )
 {
-//调用BookSimConfig类的构造函数实例化对象config，构造函数位于booksim_config.cpp
-  BookSimConfig config;
-
-
-  if ( !ParseArgs( &config, argc, argv ) ) {
-    cerr << "Usage: " << argv[0] << " configfile... [param=value...]" << endl;
-    return 0;
- } 
-
-  
   /*initialize routing, traffic, injection functions
    */
   InitializeRoutingMap( config );
@@ -179,7 +374,282 @@ int main( int argc, char **argv )
   } else {
     gWatchOut = new ofstream(watch_out_file.c_str());
   }
+}
+
+struct GridJob {
+  string name;
+  string key;
+  pid_t pid;
+  int fd;
+  bool done;
+  bool cached;
+  bool result;
+  string output;
+};
+
+// The resolved configuration a job's results depend on; empty if they are
+// not reproducible.
+static string GridKey( BookSimConfig const & config )
+{
+  if(config.GetStr("seed") == "time") {
+    return "";
+  }
+  ostringstream key;
+  key.precision(17);
+  map<string, string> const & str_map = config.GetStrMap();
+  for(map<string, string>::const_iterator iter = str_map.begin();
+      iter != str_map.end(); ++iter) {
+    if(iter->first != "grid_cache") {
+      key << iter->first << " = " << iter->second << ";" << endl;
+    }
+  }
+  map<string, int> const & int_map = config.GetIntMap();
+  for(map<string, int>::const_iterator iter = int_map.begin();
+      iter != int_map.end(); ++iter) {
+    if(iter->first != "grid_jobs") {
+      key << iter->first << " = " << iter->second << ";" << endl;
+    }
+  }
+  map<string, double> const & float_map = config.GetFloatMap();
+  for(map<string, double>::const_iterator iter = float_map.begin();
+      iter != float_map.end(); ++iter) {
+    key << iter->first << " = " << iter->second << ";" << endl;
+  }
+  return key.str();
+}
+
+// Cache entries are named by a 64-bit FNV-1a hash of the key and hold the
+// key itself, followed by the job's result and output.
+static string GridCacheFile( string const & cache, string const & key )
+{
+  unsigned long long hash = 14695981039346656037ULL;
+  for(size_t i = 0; i < key.size(); ++i) {
+    hash ^= (unsigned char)key[i];
+    hash *= 1099511628211ULL;
+  }
+  char name[17];
+  sprintf(name, "%016llx", hash);
+  return cache + "/" + name;
+}
+
+static bool ReadGridCache( string const & cache, GridJob & job )
+{
+  ifstream in(GridCacheFile(cache, job.key).c_str(), ios::binary);
+  if(!in) {
+    return false;
+  }
+  string entry((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+  if(entry.size() <= job.key.size() + 1 ||
+     entry.compare(0, job.key.size() + 1, job.key + '\0') != 0) {
+    return false;
+  }
+  job.result = (entry[job.key.size() + 1] != 0);
+  job.output = entry.substr(job.key.size() + 2);
+  return true;
+}
+
+static void WriteGridCache( string const & cache, GridJob const & job )
+{
+  string const file = GridCacheFile(cache, job.key);
+  ostringstream temp;
+  temp << file << ".tmp." << getpid();
+  {
+    ofstream out(temp.str().c_str(), ios::binary);
+    out << job.key << '\0' << (char)(job.result ? 1 : 0) << job.output;
+    if(!out) {
+      cout << "WARNING: Unable to write grid cache entry " << file << endl;
+      return;
+    }
+  }
+  rename(temp.str().c_str(), file.c_str());
+}
+
+// Runs one combination of the value lists in a child process and sends its
+// result and output back through a pipe.
+static void StartGridJob( BookSimConfig & config, BookSimConfig const & base,
+                          int point, GridJob & job )
+{
+  int fd[2];
+  if(pipe(fd) < 0) {
+    cerr << "Unable to create pipe for grid job" << endl;
+    exit(-1);
+  }
+  cout.flush();
+  pid_t pid = fork();
+  if(pid < 0) {
+    cerr << "Unable to fork grid job" << endl;
+    exit(-1);
+  }
+  if(pid == 0) {
+    close(fd[0]);
+    config = base;
+    config.AssignGridPoint(point);
+    ostringstream log;
+    cout.rdbuf(log.rdbuf());
+    Initialize( config );
+    string result(1, Simulate( config ) ? 1 : 0);
+    result += log.str();
+    char const * p = result.data();
+    size_t left = result.size();
+    while(left > 0) {
+      ssize_t n = write(fd[1], p, left);
+      if(n < 0) {
+        _exit(1);
+      }
+      p += n;
+      left -= n;
+    }
+    _exit(0);
+  }
+  close(fd[1]);
+  job.pid = pid;
+  job.fd = fd[0];
+}
+
+// Expands the value lists into one job per combination and runs them on up
+// to grid_jobs processes, printing each job's output in order. With
+// grid_cache set, results of previously simulated configurations are
+// replayed from that directory instead.
+bool RunGrid( BookSimConfig & config )
+{
+  int const max_jobs = config.GetInt("grid_jobs");
+  string const cache = config.GetStr("grid_cache");
+  if(max_jobs < 1) {
+    cerr << "grid_jobs must be positive" << endl;
+    exit(-1);
+  }
+  if((cache != "") && (mkdir(cache.c_str(), 0777) < 0) && (errno != EEXIST)) {
+    cerr << "Unable to create grid cache directory " << cache << endl;
+    exit(-1);
+  }
+
+  BookSimConfig const base = config;
+  int const size = config.GridSize();
+  vector<GridJob> jobs(size);
+  int cached = 0;
+  for(int i = 0; i < size; ++i) {
+    GridJob & job = jobs[i];
+    job.name = base.GridPointName(i);
+    job.done = false;
+    job.cached = false;
+    if(cache != "") {
+      config = base;
+      config.AssignGridPoint(i);
+      job.key = GridKey(config);
+      if((job.key != "") && ReadGridCache(cache, job)) {
+        job.done = true;
+        job.cached = true;
+        ++cached;
+      }
+    }
+  }
+  config = base;
+
+  int next = 0;
+  int printed = 0;
+  vector<int> running;
+  while(printed < size) {
+    while(((int)running.size() < max_jobs) && (next < size)) {
+      if(!jobs[next].done) {
+        StartGridJob(config, base, next, jobs[next]);
+        running.push_back(next);
+      }
+      ++next;
+    }
+
+    while((printed < size) && jobs[printed].done) {
+      GridJob const & job = jobs[printed];
+      cout << "GRID: Job " << printed + 1 << " of " << size << ": " << job.name
+           << (job.cached ? " (cached)" : "") << endl
+           << job.output;
+      if(job.output.empty()) {
+        cout << "GRID: Job failed." << endl;
+      }
+      ++printed;
+    }
+    if(running.empty()) {
+      continue;
+    }
+
+    vector<pollfd> fds(running.size());
+    for(size_t i = 0; i < running.size(); ++i) {
+      fds[i].fd = jobs[running[i]].fd;
+      fds[i].events = POLLIN;
+    }
+    if(poll(&fds[0], fds.size(), -1) < 0) {
+      if(errno == EINTR) {
+        continue;
+      }
+      cerr << "Unable to wait for grid jobs" << endl;
+      exit(-1);
+    }
+    for(int i = running.size() - 1; i >= 0; --i) {
+      if(!fds[i].revents) {
+        continue;
+      }
+      GridJob & job = jobs[running[i]];
+      char buf[4096];
+      ssize_t n = read(job.fd, buf, sizeof(buf));
+      if(n < 0) {
+        cerr << "Unable to read from grid job" << endl;
+        exit(-1);
+      }
+      if(n > 0) {
+        job.output.append(buf, n);
+        continue;
+      }
+      close(job.fd);
+      int status;
+      waitpid(job.pid, &status, 0);
+      job.done = true;
+      if(job.output.empty()) {
+        job.result = false;
+      } else {
+        job.result = (job.output[0] != 0);
+        job.output.erase(0, 1);
+        if((cache != "") && (job.key != "")) {
+          WriteGridCache(cache, job);
+        }
+      }
+      running.erase(running.begin() + i);
+    }
+  }
+
+  bool result = true;
+  for(int i = 0; i < size; ++i) {
+    result = result && jobs[i].result;
+  }
+  cout << "GRID: Ran " << size - cached << " of " << size << " jobs, "
+       << cached << " from cache." << endl;
+  return result;
+}
+
+//在debug模式下，CLion可以配置程序运行的参数（Edit configurations->program arguments），通过运行参数可指定booksim的配置文件
+//写配置文件相对路径时要注意程序的默认路径为可执行文件"booksim2"所在的路径（即argv[0]）
+int main( int argc, char **argv )
+{
+//调用BookSimConfig类的构造函数实例化对象config，构造函数位于booksim_config.cpp
+  BookSimConfig config;
+
+
+  if ( !ParseArgs( &config, argc, argv ) ) {
+    cerr << "Usage: " << argv[0] << " configfile... [param=value...]" << endl;
+    return 0;
+ } 
+
   
+  if(config.GetInt("arbiter_bench") > 0) {
+    return BenchmarkArbiters( config ) ? 0 : -1;
+  }
+
+  /*expand value lists into a set of jobs
+   */
+  if(config.HasGrid()) {
+    bool result = RunGrid( config );
+    return result ? -1 : 0;
+  }
+
+  Initialize( config );
 
   /*configure and run the simulator
    */
@@ -50,3 +50,22 @@ int log_two( int x )
 
   return r;
 }
+
+// two-sided 95% critical value of Student's t distribution
+double student_t95( int dof )
+{
+  static double const t[30] = {
+    12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+    2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+    2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+  };
+
+  if ( dof < 1 ) {
+    return 0.0;
+  } else if ( dof <= 30 ) {
+    return t[dof - 1];
+  } else if ( dof <= 60 ) {
+    return 2.000 + ( 2.042 - 2.000 ) * ( 60 - dof ) / 30.0;
+  }
+  return 1.960;
+}
@@ -30,5 +30,6 @@
 
 int log_two( int x );
 int powi( int x, int y );
+double student_t95( int dof );
 
 #endif 
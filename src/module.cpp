@@ -34,55 +34,72 @@
 
 #include <iostream>
 #include <cstdlib>
+#include <set>
 
 #include "booksim.hpp"
 #include "module.hpp"
 
-Module::Module( Module *parent, const string& name )
+static string const * _InternName( const string& name )
 {
-  _name = name;
+  static set<string> names;
+  return &*names.insert( name ).first;
+}
 
+Module::Module( Module *parent, const string& name )
+  : _name( _InternName( name ) ), _parent( parent ), _first_child( NULL ),
+    _next_sibling( NULL )
+{
   if ( parent ) { 
     parent->_AddChild( this );
-    _fullname = parent->_fullname + "/" + name;
-  } else {
-    _fullname = name;
   }
 }
 
+// children are kept newest first
 void Module::_AddChild( Module *child )
 {
-  _children.push_back( child );
+  child->_next_sibling = _first_child;
+  _first_child = child;
+}
+
+string Module::FullName( ) const
+{
+  if ( !_parent ) {
+    return *_name;
+  }
+  return _parent->FullName( ) + "/" + *_name;
 }
 
 void Module::DisplayHierarchy( int level, ostream & os ) const
 {
-  vector<Module *>::const_iterator mod_iter;
+  vector<Module *> children;
+  for ( Module * child = _first_child; child; child = child->_next_sibling ) {
+    children.push_back( child );
+  }
 
   for ( int l = 0; l < level; l++ ) {
     os << "  ";  
   }
 
-  os << _name << endl;
+  os << *_name << endl;
 
-  for ( mod_iter = _children.begin( );
-	mod_iter != _children.end( ); mod_iter++ ) {
+  for ( vector<Module *>::reverse_iterator mod_iter = children.rbegin( );
+	mod_iter != children.rend( ); mod_iter++ ) {
     (*mod_iter)->DisplayHierarchy( level + 1 );
   }
 }
 
 void Module::Error( const string& msg ) const
 {
-  cout << "Error in " << _fullname << " : " << msg << endl;
+  cout << "Error in " << FullName( ) << " : " << msg << endl;
   exit( -1 );
 }
 
 void Module::Debug( const string& msg ) const
 {
-  cout << "Debug (" << _fullname << ") : " << msg << endl;
+  cout << "Debug (" << FullName( ) << ") : " << msg << endl;
 }
 
 void Module::Display( ostream & os ) const 
 {
-  os << "Display method not implemented for " << _fullname << endl;
+  os << "Display method not implemented for " << FullName( ) << endl;
 }
@@ -36,10 +36,14 @@
 
 class Module {
 private:
-  string _name;
-  string _fullname;
+  // Names are interned, since most of them (buffer, arbiter, allocator
+  // names) repeat in every router; the full name is built from the parent
+  // chain only when it is asked for.
+  string const * _name;
 
-  vector<Module *> _children;
+  Module * _parent;
+  Module * _first_child;
+  Module * _next_sibling;
 
 protected:
   void _AddChild( Module *child );
@@ -48,8 +52,8 @@ public:
   Module( Module *parent, const string& name );
   virtual ~Module( ) { }
   
-  inline const string & Name() const { return _name; }
-  inline const string & FullName() const { return _fullname; }
+  inline const string & Name() const { return *_name; }
+  string FullName() const;
 
   void DisplayHierarchy( int level = 0, ostream & os = cout ) const;
 
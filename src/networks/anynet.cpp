@@ -215,22 +215,22 @@ void min_anynet( const Router *r, const Flit *f, int in_channel,
 		 OutputSet *outputs, bool inject ){
   int out_port=-1;
   if(!inject){
-    assert(global_routing_table[r->GetID()].count(f->dest)!=0);
-    out_port=global_routing_table[r->GetID()][f->dest];
+    assert(global_routing_table[r->GetID()].count(f->packet->dest)!=0);
+    out_port=global_routing_table[r->GetID()][f->packet->dest];
   }
  
 
   int vcBegin = 0, vcEnd = gNumVCs-1;
-  if ( f->type == Flit::READ_REQUEST ) {
+  if ( f->packet->type == Flit::READ_REQUEST ) {
     vcBegin = gReadReqBeginVC;
     vcEnd   = gReadReqEndVC;
-  } else if ( f->type == Flit::WRITE_REQUEST ) {
+  } else if ( f->packet->type == Flit::WRITE_REQUEST ) {
     vcBegin = gWriteReqBeginVC;
     vcEnd   = gWriteReqEndVC;
-  } else if ( f->type ==  Flit::READ_REPLY ) {
+  } else if ( f->packet->type ==  Flit::READ_REPLY ) {
     vcBegin = gReadReplyBeginVC;
     vcEnd   = gReadReplyEndVC;
-  } else if ( f->type ==  Flit::WRITE_REPLY ) {
+  } else if ( f->packet->type ==  Flit::WRITE_REPLY ) {
     vcBegin = gWriteReplyBeginVC;
     vcEnd   = gWriteReplyEndVC;
   }
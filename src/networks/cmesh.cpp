@@ -458,16 +458,16 @@ void xy_yx_cmesh( const Router *r, const Flit *f, int in_channel,
 
   // ( Traffic Class , Routing Order ) -> Virtual Channel Range
   int vcBegin = 0, vcEnd = gNumVCs-1;
-  if ( f->type == Flit::READ_REQUEST ) {
+  if ( f->packet->type == Flit::READ_REQUEST ) {
     vcBegin = gReadReqBeginVC;
     vcEnd = gReadReqEndVC;
-  } else if ( f->type == Flit::WRITE_REQUEST ) {
+  } else if ( f->packet->type == Flit::WRITE_REQUEST ) {
     vcBegin = gWriteReqBeginVC;
     vcEnd = gWriteReqEndVC;
-  } else if ( f->type ==  Flit::READ_REPLY ) {
+  } else if ( f->packet->type ==  Flit::READ_REPLY ) {
     vcBegin = gReadReplyBeginVC;
     vcEnd = gReadReplyEndVC;
-  } else if ( f->type ==  Flit::WRITE_REPLY ) {
+  } else if ( f->packet->type ==  Flit::WRITE_REPLY ) {
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
@@ -485,12 +485,12 @@ void xy_yx_cmesh( const Router *r, const Flit *f, int in_channel,
     int cur_router = r->GetID();
 
     // Destination Router
-    int dest_router = CMesh::NodeToRouter( f->dest ) ;  
+    int dest_router = CMesh::NodeToRouter( f->packet->dest ) ;  
 
     if (dest_router == cur_router) {
 
       // Forward to processing element
-      out_port = CMesh::NodeToPort( f->dest );      
+      out_port = CMesh::NodeToPort( f->packet->dest );      
 
     } else {
 
@@ -598,16 +598,16 @@ void xy_yx_no_express_cmesh( const Router *r, const Flit *f, int in_channel,
 {
   // ( Traffic Class , Routing Order ) -> Virtual Channel Range
   int vcBegin = 0, vcEnd = gNumVCs-1;
-  if ( f->type == Flit::READ_REQUEST ) {
+  if ( f->packet->type == Flit::READ_REQUEST ) {
     vcBegin = gReadReqBeginVC;
     vcEnd = gReadReqEndVC;
-  } else if ( f->type == Flit::WRITE_REQUEST ) {
+  } else if ( f->packet->type == Flit::WRITE_REQUEST ) {
     vcBegin = gWriteReqBeginVC;
     vcEnd = gWriteReqEndVC;
-  } else if ( f->type ==  Flit::READ_REPLY ) {
+  } else if ( f->packet->type ==  Flit::READ_REPLY ) {
     vcBegin = gReadReplyBeginVC;
     vcEnd = gReadReplyEndVC;
-  } else if ( f->type ==  Flit::WRITE_REPLY ) {
+  } else if ( f->packet->type ==  Flit::WRITE_REPLY ) {
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
@@ -625,12 +625,12 @@ void xy_yx_no_express_cmesh( const Router *r, const Flit *f, int in_channel,
     int cur_router = r->GetID();
 
     // Destination Router
-    int dest_router = CMesh::NodeToRouter( f->dest );  
+    int dest_router = CMesh::NodeToRouter( f->packet->dest );  
 
     if (dest_router == cur_router) {
 
       // Forward to processing element
-      out_port = CMesh::NodeToPort( f->dest );
+      out_port = CMesh::NodeToPort( f->packet->dest );
 
     } else {
 
@@ -725,16 +725,16 @@ void dor_cmesh( const Router *r, const Flit *f, int in_channel,
 {
   // ( Traffic Class , Routing Order ) -> Virtual Channel Range
   int vcBegin = 0, vcEnd = gNumVCs-1;
-  if ( f->type == Flit::READ_REQUEST ) {
+  if ( f->packet->type == Flit::READ_REQUEST ) {
     vcBegin = gReadReqBeginVC;
     vcEnd = gReadReqEndVC;
-  } else if ( f->type == Flit::WRITE_REQUEST ) {
+  } else if ( f->packet->type == Flit::WRITE_REQUEST ) {
     vcBegin = gWriteReqBeginVC;
     vcEnd = gWriteReqEndVC;
-  } else if ( f->type ==  Flit::READ_REPLY ) {
+  } else if ( f->packet->type ==  Flit::READ_REPLY ) {
     vcBegin = gReadReplyBeginVC;
     vcEnd = gReadReplyEndVC;
-  } else if ( f->type ==  Flit::WRITE_REPLY ) {
+  } else if ( f->packet->type ==  Flit::WRITE_REPLY ) {
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
@@ -752,12 +752,12 @@ void dor_cmesh( const Router *r, const Flit *f, int in_channel,
     int cur_router = r->GetID();
 
     // Destination Router
-    int dest_router = CMesh::NodeToRouter( f->dest ) ;  
+    int dest_router = CMesh::NodeToRouter( f->packet->dest ) ;  
   
     if (dest_router == cur_router) {
 
       // Forward to processing element
-      out_port = CMesh::NodeToPort( f->dest ) ;
+      out_port = CMesh::NodeToPort( f->packet->dest ) ;
 
     } else {
 
@@ -809,16 +809,16 @@ void dor_no_express_cmesh( const Router *r, const Flit *f, int in_channel,
 {
   // ( Traffic Class , Routing Order ) -> Virtual Channel Range
   int vcBegin = 0, vcEnd = gNumVCs-1;
-  if ( f->type == Flit::READ_REQUEST ) {
+  if ( f->packet->type == Flit::READ_REQUEST ) {
     vcBegin = gReadReqBeginVC;
     vcEnd = gReadReqEndVC;
-  } else if ( f->type == Flit::WRITE_REQUEST ) {
+  } else if ( f->packet->type == Flit::WRITE_REQUEST ) {
     vcBegin = gWriteReqBeginVC;
     vcEnd = gWriteReqEndVC;
-  } else if ( f->type ==  Flit::READ_REPLY ) {
+  } else if ( f->packet->type ==  Flit::READ_REPLY ) {
     vcBegin = gReadReplyBeginVC;
     vcEnd = gReadReplyEndVC;
-  } else if ( f->type ==  Flit::WRITE_REPLY ) {
+  } else if ( f->packet->type ==  Flit::WRITE_REPLY ) {
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
@@ -836,12 +836,12 @@ void dor_no_express_cmesh( const Router *r, const Flit *f, int in_channel,
     int cur_router = r->GetID();
 
     // Destination Router
-    int dest_router = CMesh::NodeToRouter( f->dest ) ;  
+    int dest_router = CMesh::NodeToRouter( f->packet->dest ) ;  
   
     if (dest_router == cur_router) {
 
       // Forward to processing element
-      out_port = CMesh::NodeToPort( f->dest );
+      out_port = CMesh::NodeToPort( f->packet->dest );
 
     } else {
 
@@ -420,7 +420,7 @@ void min_dragonflynew( const Router *r, const Flit *f, int in_channel,
 
   int _grp_num_routers= gA;
 
-  int dest  = f->dest;
+  int dest  = f->packet->dest;
   int rID =  r->GetID(); 
 
   int grp_ID = int(rID / _grp_num_routers); 
@@ -431,21 +431,21 @@ void min_dragonflynew( const Router *r, const Flit *f, int in_channel,
 
   if ( in_channel < gP ) {
     out_vc = 0;
-    f->ph = 0;
+    f->packet->ph = 0;
     if (dest_grp_ID == grp_ID) {
-      f->ph = 1;
+      f->packet->ph = 1;
     }
   } 
 
 
-  out_port = dragonfly_port(rID, f->src, dest);
+  out_port = dragonfly_port(rID, f->packet->src, dest);
 
   //optical dateline
   if (out_port >=gP + (gA-1)) {
-    f->ph = 1;
+    f->packet->ph = 1;
   }  
   
-  out_vc = f->ph;
+  out_vc = f->packet->ph;
   if (debug)
     *gWatchOut << GetSimTime() << " | " << r->FullName() << " | "
 	       << "	through output port : " << out_port 
@@ -477,7 +477,7 @@ void ugal_dragonflynew( const Router *r, const Flit *f, int in_channel,
   int _network_size =  gA * gP * gG;
 
  
-  int dest  = f->dest;
+  int dest  = f->packet->dest;
   int rID =  r->GetID(); 
   int grp_ID = (int) (rID / _grp_num_routers);
   int dest_grp_ID = int(dest/_grp_num_nodes);
@@ -499,64 +499,64 @@ void ugal_dragonflynew( const Router *r, const Flit *f, int in_channel,
   if ( in_channel < gP )   {
     //dest are in the same group, only use minimum routing
     if (dest_grp_ID == grp_ID) {
-      f->ph = 2;
+      f->packet->ph = 2;
     } else {
       //select a random node
-      f->intm =RandomInt(_network_size - 1);
-      intm_grp_ID = (int)(f->intm/_grp_num_nodes);
+      f->packet->intm =RandomInt(_network_size - 1);
+      intm_grp_ID = (int)(f->packet->intm/_grp_num_nodes);
       if (debug){
-	cout<<"Intermediate node "<<f->intm<<" grp id "<<intm_grp_ID<<endl;
+	cout<<"Intermediate node "<<f->packet->intm<<" grp id "<<intm_grp_ID<<endl;
       }
       
       //random intermediate are in the same group, use minimum routing
       if(grp_ID == intm_grp_ID){
-	f->ph = 1;
+	f->packet->ph = 1;
       } else {
 	//congestion metrics using queue length, obtained by GetUsedCredit()
-	min_router_output = dragonfly_port(rID, f->src, f->dest); 
+	min_router_output = dragonfly_port(rID, f->packet->src, f->packet->dest); 
       	min_queue_size = max(r->GetUsedCredit(min_router_output), 0) ; 
 
       
-	nonmin_router_output = dragonfly_port(rID, f->src, f->intm);
+	nonmin_router_output = dragonfly_port(rID, f->packet->src, f->packet->intm);
 	nonmin_queue_size = max(r->GetUsedCredit(nonmin_router_output), 0);
 
 	//congestion comparison, could use hopcnt instead of 1 and 2
 	if ((1 * min_queue_size ) <= (2 * nonmin_queue_size)+adaptive_threshold ) {	  
 	  if (debug)  cout << " MINIMAL routing " << endl;
-	  f->ph = 1;
+	  f->packet->ph = 1;
 	} else {
-	  f->ph = 0;
+	  f->packet->ph = 0;
 	}
       }
     }
   }
 
   //transition from nonminimal phase to minimal
-  if(f->ph==0){
-    intm_rID= (int)(f->intm/gP);
+  if(f->packet->ph==0){
+    intm_rID= (int)(f->packet->intm/gP);
     if( rID == intm_rID){
-      f->ph = 1;
+      f->packet->ph = 1;
     }
   }
 
   //port assignement based on the phase
-  if(f->ph == 0){
-    out_port = dragonfly_port(rID, f->src, f->intm);
-  } else if(f->ph == 1){
-    out_port = dragonfly_port(rID, f->src, f->dest);
-  } else if(f->ph == 2){
-    out_port = dragonfly_port(rID, f->src, f->dest);
+  if(f->packet->ph == 0){
+    out_port = dragonfly_port(rID, f->packet->src, f->packet->intm);
+  } else if(f->packet->ph == 1){
+    out_port = dragonfly_port(rID, f->packet->src, f->packet->dest);
+  } else if(f->packet->ph == 2){
+    out_port = dragonfly_port(rID, f->packet->src, f->packet->dest);
   } else {
     assert(false);
   }
 
   //optical dateline
-  if (f->ph == 1 && out_port >=gP + (gA-1)) {
-    f->ph = 2;
+  if (f->packet->ph == 1 && out_port >=gP + (gA-1)) {
+    f->packet->ph = 2;
   }  
 
   //vc assignemnt based on phase
-  out_vc = f->ph;
+  out_vc = f->packet->ph;
 
   outputs->AddRange( out_port, out_vc, out_vc );
 }
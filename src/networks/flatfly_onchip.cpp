@@ -334,16 +334,16 @@ void adaptive_xyyx_flatfly( const Router *r, const Flit *f, int in_channel,
 { 
   // ( Traffic Class , Routing Order ) -> Virtual Channel Range
   int vcBegin = 0, vcEnd = gNumVCs-1;
-  if ( f->type == Flit::READ_REQUEST ) {
+  if ( f->packet->type == Flit::READ_REQUEST ) {
     vcBegin = gReadReqBeginVC;
     vcEnd = gReadReqEndVC;
-  } else if ( f->type == Flit::WRITE_REQUEST ) {
+  } else if ( f->packet->type == Flit::WRITE_REQUEST ) {
     vcBegin = gWriteReqBeginVC;
     vcEnd = gWriteReqEndVC;
-  } else if ( f->type ==  Flit::READ_REPLY ) {
+  } else if ( f->packet->type ==  Flit::READ_REPLY ) {
     vcBegin = gReadReplyBeginVC;
     vcEnd = gReadReplyEndVC;
-  } else if ( f->type ==  Flit::WRITE_REPLY ) {
+  } else if ( f->packet->type ==  Flit::WRITE_REPLY ) {
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
@@ -357,7 +357,7 @@ void adaptive_xyyx_flatfly( const Router *r, const Flit *f, int in_channel,
 
   } else {
 
-    int dest = flatfly_transformation(f->dest);
+    int dest = flatfly_transformation(f->packet->dest);
     int targetr = (int)(dest/gC);
 
     if(targetr==r->GetID()){ //if we are at the final router, yay, output to client
@@ -411,16 +411,16 @@ void xyyx_flatfly( const Router *r, const Flit *f, int in_channel,
 { 
   // ( Traffic Class , Routing Order ) -> Virtual Channel Range
   int vcBegin = 0, vcEnd = gNumVCs-1;
-  if ( f->type == Flit::READ_REQUEST ) {
+  if ( f->packet->type == Flit::READ_REQUEST ) {
     vcBegin = gReadReqBeginVC;
     vcEnd = gReadReqEndVC;
-  } else if ( f->type == Flit::WRITE_REQUEST ) {
+  } else if ( f->packet->type == Flit::WRITE_REQUEST ) {
     vcBegin = gWriteReqBeginVC;
     vcEnd = gWriteReqEndVC;
-  } else if ( f->type ==  Flit::READ_REPLY ) {
+  } else if ( f->packet->type ==  Flit::READ_REPLY ) {
     vcBegin = gReadReplyBeginVC;
     vcEnd = gReadReplyEndVC;
-  } else if ( f->type ==  Flit::WRITE_REPLY ) {
+  } else if ( f->packet->type ==  Flit::WRITE_REPLY ) {
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
@@ -434,7 +434,7 @@ void xyyx_flatfly( const Router *r, const Flit *f, int in_channel,
 
   } else {
 
-    int dest = flatfly_transformation(f->dest);
+    int dest = flatfly_transformation(f->packet->dest);
     int targetr = (int)(dest/gC);
 
     if(targetr==r->GetID()){ //if we are at the final router, yay, output to client
@@ -504,16 +504,16 @@ void valiant_flatfly( const Router *r, const Flit *f, int in_channel,
 {
   // ( Traffic Class , Routing Order ) -> Virtual Channel Range
   int vcBegin = 0, vcEnd = gNumVCs-1;
-  if ( f->type == Flit::READ_REQUEST ) {
+  if ( f->packet->type == Flit::READ_REQUEST ) {
     vcBegin = gReadReqBeginVC;
     vcEnd = gReadReqEndVC;
-  } else if ( f->type == Flit::WRITE_REQUEST ) {
+  } else if ( f->packet->type == Flit::WRITE_REQUEST ) {
     vcBegin = gWriteReqBeginVC;
     vcEnd = gWriteReqEndVC;
-  } else if ( f->type ==  Flit::READ_REPLY ) {
+  } else if ( f->packet->type ==  Flit::READ_REPLY ) {
     vcBegin = gReadReplyBeginVC;
     vcEnd = gReadReplyEndVC;
-  } else if ( f->type ==  Flit::WRITE_REPLY ) {
+  } else if ( f->packet->type ==  Flit::WRITE_REPLY ) {
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
@@ -528,21 +528,21 @@ void valiant_flatfly( const Router *r, const Flit *f, int in_channel,
   } else {
 
     if ( in_channel < gC ){
-      f->ph = 0;
-      f->intm = RandomInt( powi( gK, gN )*gC-1);
+      f->packet->ph = 0;
+      f->packet->intm = RandomInt( powi( gK, gN )*gC-1);
     }
 
-    int intm = flatfly_transformation(f->intm);
-    int dest = flatfly_transformation(f->dest);
+    int intm = flatfly_transformation(f->packet->intm);
+    int dest = flatfly_transformation(f->packet->dest);
 
     if((int)(intm/gC) == r->GetID() || (int)(dest/gC)== r->GetID()){
-      f->ph = 1;
+      f->packet->ph = 1;
     }
 
-    if(f->ph == 0) {
+    if(f->packet->ph == 0) {
       out_port = flatfly_outport(intm, r->GetID());
     } else {
-      assert(f->ph == 1);
+      assert(f->packet->ph == 1);
       out_port = flatfly_outport(dest, r->GetID());
     }
 
@@ -552,11 +552,11 @@ void valiant_flatfly( const Router *r, const Flit *f, int in_channel,
       int const available_vcs = (vcEnd - vcBegin + 1) / 2;
       assert(available_vcs > 0);
 
-      if(f->ph == 0) {
+      if(f->packet->ph == 0) {
 	vcEnd -= available_vcs;
       } else {
 	// If routing to final destination use the second half of the VCs.
-	assert(f->ph == 1);
+	assert(f->packet->ph == 1);
 	vcBegin += available_vcs;
       }
     }
@@ -573,16 +573,16 @@ void min_flatfly( const Router *r, const Flit *f, int in_channel,
 {
   // ( Traffic Class , Routing Order ) -> Virtual Channel Range
   int vcBegin = 0, vcEnd = gNumVCs-1;
-  if ( f->type == Flit::READ_REQUEST ) {
+  if ( f->packet->type == Flit::READ_REQUEST ) {
     vcBegin = gReadReqBeginVC;
     vcEnd = gReadReqEndVC;
-  } else if ( f->type == Flit::WRITE_REQUEST ) {
+  } else if ( f->packet->type == Flit::WRITE_REQUEST ) {
     vcBegin = gWriteReqBeginVC;
     vcEnd = gWriteReqEndVC;
-  } else if ( f->type ==  Flit::READ_REPLY ) {
+  } else if ( f->packet->type ==  Flit::READ_REPLY ) {
     vcBegin = gReadReplyBeginVC;
     vcEnd = gReadReplyEndVC;
-  } else if ( f->type ==  Flit::WRITE_REPLY ) {
+  } else if ( f->packet->type ==  Flit::WRITE_REPLY ) {
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
@@ -596,7 +596,7 @@ void min_flatfly( const Router *r, const Flit *f, int in_channel,
 
   } else {
 
-    int dest  = flatfly_transformation(f->dest);
+    int dest  = flatfly_transformation(f->packet->dest);
     int targetr= (int)(dest/gC);
     //int xdest = ((int)(dest/gC)) % gK;
     //int xcurr = ((r->GetID())) % gK;
@@ -628,16 +628,16 @@ void ugal_xyyx_flatfly_onchip( const Router *r, const Flit *f, int in_channel,
 {
   // ( Traffic Class , Routing Order ) -> Virtual Channel Range
   int vcBegin = 0, vcEnd = gNumVCs-1;
-  if ( f->type == Flit::READ_REQUEST ) {
+  if ( f->packet->type == Flit::READ_REQUEST ) {
     vcBegin = gReadReqBeginVC;
     vcEnd = gReadReqEndVC;
-  } else if ( f->type == Flit::WRITE_REQUEST ) {
+  } else if ( f->packet->type == Flit::WRITE_REQUEST ) {
     vcBegin = gWriteReqBeginVC;
     vcEnd = gWriteReqEndVC;
-  } else if ( f->type ==  Flit::READ_REPLY ) {
+  } else if ( f->packet->type ==  Flit::READ_REPLY ) {
     vcBegin = gReadReplyBeginVC;
     vcEnd = gReadReplyEndVC;
-  } else if ( f->type ==  Flit::WRITE_REPLY ) {
+  } else if ( f->packet->type ==  Flit::WRITE_REPLY ) {
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
@@ -651,7 +651,7 @@ void ugal_xyyx_flatfly_onchip( const Router *r, const Flit *f, int in_channel,
 
   } else {
 
-    int dest  = flatfly_transformation(f->dest);
+    int dest  = flatfly_transformation(f->packet->dest);
 
     int rID =  r->GetID();
     int _concentration = gC;
@@ -664,9 +664,9 @@ void ugal_xyyx_flatfly_onchip( const Router *r, const Flit *f, int in_channel,
 
     if ( in_channel < gC ){
       if(gTrace){
-	cout<<"New Flit "<<f->src<<endl;
+	cout<<"New Flit "<<f->packet->src<<endl;
       }
-      f->ph   = 0;
+      f->packet->ph   = 0;
     }
 
     if(gTrace){
@@ -679,22 +679,22 @@ void ugal_xyyx_flatfly_onchip( const Router *r, const Flit *f, int in_channel,
     }
 
     if (debug){
-      cout << " FLIT ID: " << f->id << " Router: " << rID << " routing from src : " << f->src <<  " to dest : " << dest << " f->ph: " <<f->ph << " intm: " << f->intm <<  endl;
+      cout << " FLIT ID: " << f->id << " Router: " << rID << " routing from src : " << f->packet->src <<  " to dest : " << dest << " f->packet->ph: " <<f->packet->ph << " intm: " << f->packet->intm <<  endl;
     }
-    // f->ph == 0  ==> make initial global adaptive decision
-    // f->ph == 1  ==> route nonminimaly to random intermediate node
-    // f->ph == 2  ==> route minimally to destination
+    // f->packet->ph == 0  ==> make initial global adaptive decision
+    // f->packet->ph == 1  ==> route nonminimaly to random intermediate node
+    // f->packet->ph == 2  ==> route minimally to destination
 
     found = 0;
 
-    if (f->ph == 1){
-      dest = f->intm;
+    if (f->packet->ph == 1){
+      dest = f->packet->intm;
     }
 
     if (dest >= rID*_concentration && dest < (rID+1)*_concentration) {
-      if (f->ph == 1) {
-	f->ph = 2;
-	dest = flatfly_transformation(f->dest);
+      if (f->packet->ph == 1) {
+	f->packet->ph = 2;
+	dest = flatfly_transformation(f->packet->dest);
 	if (debug)   cout << "      done routing to intermediate ";
       }
       else  {
@@ -714,9 +714,9 @@ void ugal_xyyx_flatfly_onchip( const Router *r, const Flit *f, int in_channel,
 		       (RandomInt(1) > 0) : 
 		       (f->vc < (vcBegin + xy_available_vcs)));
 
-      if (f->ph == 0) {
+      if (f->packet->ph == 0) {
 	//find the min port and min distance
-	_min_hop = find_distance(flatfly_transformation(f->src),dest);
+	_min_hop = find_distance(flatfly_transformation(f->packet->src),dest);
 	if(x_then_y){
 	  tmp_out_port =  flatfly_outport(dest, rID);
 	} else {
@@ -729,8 +729,8 @@ void ugal_xyyx_flatfly_onchip( const Router *r, const Flit *f, int in_channel,
 	_min_queucnt =   r->GetUsedCredit(tmp_out_port);
 
 	//find the nonmin router, nonmin port, nonmin count
-	_ran_intm = find_ran_intm(flatfly_transformation(f->src), dest);
-	_nonmin_hop = find_distance(flatfly_transformation(f->src),_ran_intm) +    find_distance(_ran_intm, dest);
+	_ran_intm = find_ran_intm(flatfly_transformation(f->packet->src), dest);
+	_nonmin_hop = find_distance(flatfly_transformation(f->packet->src),_ran_intm) +    find_distance(_ran_intm, dest);
 	if(x_then_y){
 	  tmp_out_port =  flatfly_outport(_ran_intm, rID);
 	} else {
@@ -753,16 +753,16 @@ void ugal_xyyx_flatfly_onchip( const Router *r, const Flit *f, int in_channel,
 	if (_min_hop * _min_queucnt   <= _nonmin_hop * _nonmin_queucnt +threshold) {
 
 	  if (debug) cout << " Route MINIMALLY " << endl;
-	  f->ph = 2;
+	  f->packet->ph = 2;
 	} else {
 	  // route non-minimally
 	  if (debug)  { cout << " Route NONMINIMALLY int node: " <<_ran_intm << endl; }
-	  f->ph = 1;
-	  f->intm = _ran_intm;
-	  dest = f->intm;
+	  f->packet->ph = 1;
+	  f->packet->intm = _ran_intm;
+	  dest = f->packet->intm;
 	  if (dest >= rID*_concentration && dest < (rID+1)*_concentration) {
-	    f->ph = 2;
-	    dest = flatfly_transformation(f->dest);
+	    f->packet->ph = 2;
+	    dest = flatfly_transformation(f->packet->dest);
 	  }
 	}
       }
@@ -786,10 +786,10 @@ void ugal_xyyx_flatfly_onchip( const Router *r, const Flit *f, int in_channel,
 	int const ph_available_vcs = xy_available_vcs / 2;
 	assert(ph_available_vcs > 0);
 
-	if(f->ph == 1) {
+	if(f->packet->ph == 1) {
 	  vcEnd -= ph_available_vcs;
 	} else {
-	  assert(f->ph == 2);
+	  assert(f->packet->ph == 2);
 	  vcBegin += ph_available_vcs;
 	}
       }
@@ -827,16 +827,16 @@ void ugal_flatfly_onchip( const Router *r, const Flit *f, int in_channel,
 {
   // ( Traffic Class , Routing Order ) -> Virtual Channel Range
   int vcBegin = 0, vcEnd = gNumVCs-1;
-  if ( f->type == Flit::READ_REQUEST ) {
+  if ( f->packet->type == Flit::READ_REQUEST ) {
     vcBegin = gReadReqBeginVC;
     vcEnd = gReadReqEndVC;
-  } else if ( f->type == Flit::WRITE_REQUEST ) {
+  } else if ( f->packet->type == Flit::WRITE_REQUEST ) {
     vcBegin = gWriteReqBeginVC;
     vcEnd = gWriteReqEndVC;
-  } else if ( f->type ==  Flit::READ_REPLY ) {
+  } else if ( f->packet->type ==  Flit::READ_REPLY ) {
     vcBegin = gReadReplyBeginVC;
     vcEnd = gReadReplyEndVC;
-  } else if ( f->type ==  Flit::WRITE_REPLY ) {
+  } else if ( f->packet->type ==  Flit::WRITE_REPLY ) {
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
@@ -850,7 +850,7 @@ void ugal_flatfly_onchip( const Router *r, const Flit *f, int in_channel,
 
   } else {
 
-    int dest  = flatfly_transformation(f->dest);
+    int dest  = flatfly_transformation(f->packet->dest);
 
     int rID =  r->GetID();
     int _concentration = gC;
@@ -862,9 +862,9 @@ void ugal_flatfly_onchip( const Router *r, const Flit *f, int in_channel,
 
     if ( in_channel < gC ){
       if(gTrace){
-	cout<<"New Flit "<<f->src<<endl;
+	cout<<"New Flit "<<f->packet->src<<endl;
       }
-      f->ph   = 0;
+      f->packet->ph   = 0;
     }
 
     if(gTrace){
@@ -877,24 +877,24 @@ void ugal_flatfly_onchip( const Router *r, const Flit *f, int in_channel,
     }
 
     if (debug){
-      cout << " FLIT ID: " << f->id << " Router: " << rID << " routing from src : " << f->src <<  " to dest : " << dest << " f->ph: " <<f->ph << " intm: " << f->intm <<  endl;
+      cout << " FLIT ID: " << f->id << " Router: " << rID << " routing from src : " << f->packet->src <<  " to dest : " << dest << " f->packet->ph: " <<f->packet->ph << " intm: " << f->packet->intm <<  endl;
     }
-    // f->ph == 0  ==> make initial global adaptive decision
-    // f->ph == 1  ==> route nonminimaly to random intermediate node
-    // f->ph == 2  ==> route minimally to destination
+    // f->packet->ph == 0  ==> make initial global adaptive decision
+    // f->packet->ph == 1  ==> route nonminimaly to random intermediate node
+    // f->packet->ph == 2  ==> route minimally to destination
 
     found = 0;
 
-    if (f->ph == 1){
-      dest = f->intm;
+    if (f->packet->ph == 1){
+      dest = f->packet->intm;
     }
 
 
     if (dest >= rID*_concentration && dest < (rID+1)*_concentration) {
 
-      if (f->ph == 1) {
-	f->ph = 2;
-	dest = flatfly_transformation(f->dest);
+      if (f->packet->ph == 1) {
+	f->packet->ph = 2;
+	dest = flatfly_transformation(f->packet->dest);
 	if (debug)   cout << "      done routing to intermediate ";
       }
       else  {
@@ -906,9 +906,9 @@ void ugal_flatfly_onchip( const Router *r, const Flit *f, int in_channel,
 
     if (!found) {
 
-      if (f->ph == 0) {
-	_min_hop = find_distance(flatfly_transformation(f->src),dest);
-	_ran_intm = find_ran_intm(flatfly_transformation(f->src), dest);
+      if (f->packet->ph == 0) {
+	_min_hop = find_distance(flatfly_transformation(f->packet->src),dest);
+	_ran_intm = find_ran_intm(flatfly_transformation(f->packet->src), dest);
 	tmp_out_port =  flatfly_outport(dest, rID);
 	if (f->watch){
 	  *gWatchOut << GetSimTime() << " | " << r->FullName() << " | "
@@ -917,7 +917,7 @@ void ugal_flatfly_onchip( const Router *r, const Flit *f, int in_channel,
 
 	_min_queucnt =   r->GetUsedCredit(tmp_out_port);
 
-	_nonmin_hop = find_distance(flatfly_transformation(f->src),_ran_intm) +    find_distance(_ran_intm, dest);
+	_nonmin_hop = find_distance(flatfly_transformation(f->packet->src),_ran_intm) +    find_distance(_ran_intm, dest);
 	tmp_out_port =  flatfly_outport(_ran_intm, rID);
 
 	if (f->watch){
@@ -937,16 +937,16 @@ void ugal_flatfly_onchip( const Router *r, const Flit *f, int in_channel,
 	if (_min_hop * _min_queucnt   <= _nonmin_hop * _nonmin_queucnt +threshold) {
 
 	  if (debug) cout << " Route MINIMALLY " << endl;
-	  f->ph = 2;
+	  f->packet->ph = 2;
 	} else {
 	  // route non-minimally
 	  if (debug)  { cout << " Route NONMINIMALLY int node: " <<_ran_intm << endl; }
-	  f->ph = 1;
-	  f->intm = _ran_intm;
-	  dest = f->intm;
+	  f->packet->ph = 1;
+	  f->packet->intm = _ran_intm;
+	  dest = f->packet->intm;
 	  if (dest >= rID*_concentration && dest < (rID+1)*_concentration) {
-	    f->ph = 2;
-	    dest = flatfly_transformation(f->dest);
+	    f->packet->ph = 2;
+	    dest = flatfly_transformation(f->packet->dest);
 	  }
 	}
       }
@@ -958,10 +958,10 @@ void ugal_flatfly_onchip( const Router *r, const Flit *f, int in_channel,
       if(out_port >= gC) {
 	int const available_vcs = (vcEnd - vcBegin + 1) / 2;
 	assert(available_vcs > 0);
-	if(f->ph == 1) {
+	if(f->packet->ph == 1) {
 	  vcEnd -= available_vcs;
 	} else {
-	  assert(f->ph == 2);
+	  assert(f->packet->ph == 2);
 	  vcBegin += available_vcs;
 	}
       }
@@ -1000,16 +1000,16 @@ void ugal_pni_flatfly_onchip( const Router *r, const Flit *f, int in_channel,
 {
   // ( Traffic Class , Routing Order ) -> Virtual Channel Range
   int vcBegin = 0, vcEnd = gNumVCs-1;
-  if ( f->type == Flit::READ_REQUEST ) {
+  if ( f->packet->type == Flit::READ_REQUEST ) {
     vcBegin = gReadReqBeginVC;
     vcEnd = gReadReqEndVC;
-  } else if ( f->type == Flit::WRITE_REQUEST ) {
+  } else if ( f->packet->type == Flit::WRITE_REQUEST ) {
     vcBegin = gWriteReqBeginVC;
     vcEnd = gWriteReqEndVC;
-  } else if ( f->type ==  Flit::READ_REPLY ) {
+  } else if ( f->packet->type ==  Flit::READ_REPLY ) {
     vcBegin = gReadReplyBeginVC;
     vcEnd = gReadReplyEndVC;
-  } else if ( f->type ==  Flit::WRITE_REPLY ) {
+  } else if ( f->packet->type ==  Flit::WRITE_REPLY ) {
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
@@ -1023,7 +1023,7 @@ void ugal_pni_flatfly_onchip( const Router *r, const Flit *f, int in_channel,
 
   } else {
 
-    int dest  = flatfly_transformation(f->dest);
+    int dest  = flatfly_transformation(f->packet->dest);
 
     int rID =  r->GetID();
     int _concentration = gC;
@@ -1035,9 +1035,9 @@ void ugal_pni_flatfly_onchip( const Router *r, const Flit *f, int in_channel,
 
     if ( in_channel < gC ){
       if(gTrace){
-	cout<<"New Flit "<<f->src<<endl;
+	cout<<"New Flit "<<f->packet->src<<endl;
       }
-      f->ph   = 0;
+      f->packet->ph   = 0;
     }
 
     if(gTrace){
@@ -1050,24 +1050,24 @@ void ugal_pni_flatfly_onchip( const Router *r, const Flit *f, int in_channel,
     }
 
     if (debug){
-      cout << " FLIT ID: " << f->id << " Router: " << rID << " routing from src : " << f->src <<  " to dest : " << dest << " f->ph: " <<f->ph << " intm: " << f->intm <<  endl;
+      cout << " FLIT ID: " << f->id << " Router: " << rID << " routing from src : " << f->packet->src <<  " to dest : " << dest << " f->packet->ph: " <<f->packet->ph << " intm: " << f->packet->intm <<  endl;
     }
-    // f->ph == 0  ==> make initial global adaptive decision
-    // f->ph == 1  ==> route nonminimaly to random intermediate node
-    // f->ph == 2  ==> route minimally to destination
+    // f->packet->ph == 0  ==> make initial global adaptive decision
+    // f->packet->ph == 1  ==> route nonminimaly to random intermediate node
+    // f->packet->ph == 2  ==> route minimally to destination
 
     found = 0;
 
-    if (f->ph == 1){
-      dest = f->intm;
+    if (f->packet->ph == 1){
+      dest = f->packet->intm;
     }
 
 
     if (dest >= rID*_concentration && dest < (rID+1)*_concentration) {
 
-      if (f->ph == 1) {
-	f->ph = 2;
-	dest = flatfly_transformation(f->dest);
+      if (f->packet->ph == 1) {
+	f->packet->ph = 2;
+	dest = flatfly_transformation(f->packet->dest);
 	if (debug)   cout << "      done routing to intermediate ";
       }
       else  {
@@ -1079,9 +1079,9 @@ void ugal_pni_flatfly_onchip( const Router *r, const Flit *f, int in_channel,
 
     if (!found) {
 
-      if (f->ph == 0) {
-	_min_hop = find_distance(flatfly_transformation(f->src),dest);
-	_ran_intm = find_ran_intm(flatfly_transformation(f->src), dest);
+      if (f->packet->ph == 0) {
+	_min_hop = find_distance(flatfly_transformation(f->packet->src),dest);
+	_ran_intm = find_ran_intm(flatfly_transformation(f->packet->src), dest);
 	tmp_out_port =  flatfly_outport(dest, rID);
 	if (f->watch){
 	  *gWatchOut << GetSimTime() << " | " << r->FullName() << " | "
@@ -1090,7 +1090,7 @@ void ugal_pni_flatfly_onchip( const Router *r, const Flit *f, int in_channel,
 
 	_min_queucnt =   r->GetUsedCredit(tmp_out_port);
 
-	_nonmin_hop = find_distance(flatfly_transformation(f->src),_ran_intm) +    find_distance(_ran_intm, dest);
+	_nonmin_hop = find_distance(flatfly_transformation(f->packet->src),_ran_intm) +    find_distance(_ran_intm, dest);
 	tmp_out_port =  flatfly_outport(_ran_intm, rID);
 
 	if (f->watch){
@@ -1110,16 +1110,16 @@ void ugal_pni_flatfly_onchip( const Router *r, const Flit *f, int in_channel,
 	if (_min_hop * _min_queucnt   <= _nonmin_hop * _nonmin_queucnt +threshold) {
 
 	  if (debug) cout << " Route MINIMALLY " << endl;
-	  f->ph = 2;
+	  f->packet->ph = 2;
 	} else {
 	  // route non-minimally
 	  if (debug)  { cout << " Route NONMINIMALLY int node: " <<_ran_intm << endl; }
-	  f->ph = 1;
-	  f->intm = _ran_intm;
-	  dest = f->intm;
+	  f->packet->ph = 1;
+	  f->packet->intm = _ran_intm;
+	  dest = f->packet->intm;
 	  if (dest >= rID*_concentration && dest < (rID+1)*_concentration) {
-	    f->ph = 2;
-	    dest = flatfly_transformation(f->dest);
+	    f->packet->ph = 2;
+	    dest = flatfly_transformation(f->packet->dest);
 	  }
 	}
       }
@@ -1131,10 +1131,10 @@ void ugal_pni_flatfly_onchip( const Router *r, const Flit *f, int in_channel,
       if(out_port >= gC) {
 	int const available_vcs = (vcEnd - vcBegin + 1) / 2;
 	assert(available_vcs > 0);
-	if(f->ph == 1) {
+	if(f->packet->ph == 1) {
 	  vcEnd -= available_vcs;
 	} else {
-	  assert(f->ph == 2);
+	  assert(f->packet->ph == 2);
 	  vcBegin += available_vcs;
 	}
       }
@@ -1167,9 +1167,9 @@ void ugal_pni_flatfly_onchip( const Router *r, const Flit *f, int in_channel,
     // derived from flattening an actual butterfly), gK and gC are the same!
     assert(gK == gC);
 
-    assert(inject ? (f->ph == -1) : (f->ph == 1 || f->ph == 2));
+    assert(inject ? (f->packet->ph == -1) : (f->packet->ph == 1 || f->packet->ph == 2));
 
-    int next_coord = flatfly_transformation(f->dest);
+    int next_coord = flatfly_transformation(f->packet->dest);
     if(inject) {
       next_coord /= gC;
       next_coord %= gK;
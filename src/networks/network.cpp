@@ -34,9 +34,13 @@
 
 #include <cassert>
 #include <sstream>
+#include <map>
+#include <set>
 
 #include "booksim.hpp"
 #include "network.hpp"
+#include "checkpoint.hpp"
+#include "iq_router.hpp"
 
 #include "kncube.hpp"
 #include "fly.hpp"
@@ -49,13 +53,59 @@
 #include "dragonfly.hpp"
 
 
+// Routing functions that never draw from the global random number
+// generator once a packet is inside the network. Anything else makes the
+// outcome of a parallel evaluate phase depend on thread interleaving.
+static char const * const gDeterministicRoutingFunctions[] = {
+  "dor_mesh", "dim_order_mesh", "dim_order_ni_mesh", "dim_order_pni_mesh",
+  "oddeven_mesh", "nca_qtree", "dest_tag_fly"
+};
+
+bool Network::ParallelSteppingSafe( const Configuration &config )
+{
+  // other router models and watch output are not safe to step concurrently
+  return ( ( config.GetStr("router") == "iq" ) && 
+	   ( config.GetStr("watch_out") == "" ) );
+}
+
+bool Network::ParallelEvaluateSafe( const Configuration &config )
+{
+  string const rf = config.GetStr("routing_function") + "_" + config.GetStr("topology");
+  bool found = false;
+  int const count = sizeof(gDeterministicRoutingFunctions) / sizeof(gDeterministicRoutingFunctions[0]);
+  for ( int i = 0; i < count; ++i ) {
+    if ( rf == gDeterministicRoutingFunctions[i] ) {
+      found = true;
+      break;
+    }
+  }
+  // pim is the only allocator that uses random priorities
+  return ( found &&
+	   ( config.GetStr("vc_allocator") != "pim" ) &&
+	   ( config.GetStr("sw_allocator") != "pim" ) &&
+	   ( config.GetStr("spec_sw_allocator") != "pim" ) );
+}
+
 Network::Network( const Configuration &config, const string & name ) :
-  TimedModule( 0, name )
+  TimedModule( 0, name ), _step_lists_built( false ), _pool( NULL ),
+  _eval_done( NULL ), _eval_epoch( 0 )
 {
   _size     = -1; 
   _nodes    = -1; 
   _channels = -1;
   _classes  = config.GetInt("classes");
+
+  _threads = config.GetInt("network_threads");
+  if ( _threads < 1 ) {
+    Error( "network_threads must be at least one." );
+  }
+  if ( ( _threads > 1 ) && !ParallelSteppingSafe( config ) ) {
+    cout << "WARNING: network_threads ignored for this configuration, stepping serially." << endl;
+    _threads = 1;
+  }
+  _parallel_evaluate = ( _threads > 1 ) && ParallelEvaluateSafe( config );
+  _use_active_set = ( _threads == 1 ) && config.GetInt("active_set");
+  _job.net = this;
 }
 
 Network::~Network( )
@@ -75,6 +125,11 @@ Network::~Network( )
     if ( _chan[c] ) delete _chan[c];
     if ( _chan_cred[c] ) delete _chan_cred[c];
   }
+  for ( size_t l = 0; l < _links.size(); ++l ) {
+    delete _links[l];
+  }
+  if ( _pool ) delete _pool;
+  if ( _eval_done ) delete [] _eval_done;
 }
 
 Network * Network::New(const Configuration & config, const string & name)
@@ -146,11 +201,13 @@ void Network::_Alloc( )
     name << Name() << "_fchan_ingress" << s;
     _inject[s] = new FlitChannel(this, name.str(), _classes);
     _inject[s]->SetSource(NULL, s);//inject是PE注入网络流量所使用的信道，所以inject信道的source为PE，不是路由器。source端口为PE端口，PE端口就是PE id
-    _timed_modules.push_back(_inject[s]);
     name.str("");
     name << Name() << "_cchan_ingress" << s;
     _inject_cred[s] = new CreditChannel(this, name.str());
-    _timed_modules.push_back(_inject_cred[s]);
+    name.str("");
+    name << Name() << "_link_ingress" << s;
+    _links.push_back(new Link(this, name.str(), _inject[s], _inject_cred[s]));
+    _timed_modules.push_back(_links.back());
   }
   _eject.resize(_nodes);
   _eject_cred.resize(_nodes);
@@ -159,11 +216,13 @@ void Network::_Alloc( )
     name << Name() << "_fchan_egress" << d;
     _eject[d] = new FlitChannel(this, name.str(), _classes);
     _eject[d]->SetSink(NULL, d);//eject是router到PE使用的信道，所以eject信道的sink是PE，sink端口为PE端口。
-    _timed_modules.push_back(_eject[d]);
     name.str("");
     name << Name() << "_cchan_egress" << d;
     _eject_cred[d] = new CreditChannel(this, name.str());
-    _timed_modules.push_back(_eject_cred[d]);
+    name.str("");
+    name << Name() << "_link_egress" << d;
+    _links.push_back(new Link(this, name.str(), _eject[d], _eject_cred[d]));
+    _timed_modules.push_back(_links.back());
   }
   _chan.resize(_channels);
   _chan_cred.resize(_channels);
@@ -171,38 +230,358 @@ void Network::_Alloc( )
     ostringstream name;
     name << Name() << "_fchan_" << c;
     _chan[c] = new FlitChannel(this, name.str(), _classes);
-    _timed_modules.push_back(_chan[c]);
     name.str("");
     name << Name() << "_cchan_" << c;
     _chan_cred[c] = new CreditChannel(this, name.str());
-    _timed_modules.push_back(_chan_cred[c]);
+    name.str("");
+    name << Name() << "_link_" << c;
+    _links.push_back(new Link(this, name.str(), _chan[c], _chan_cred[c]));
+    _timed_modules.push_back(_links.back());
   }
 }
 
-void Network::ReadInputs( )
+void Network::_BuildSchedule( )
 {
+  _thread_modules.assign(_threads, vector<TimedModule *>());
+  _eval_schedule.assign(_threads, vector<int>());
+
+  set<TimedModule *> const routers(_routers.begin(), _routers.end());
+  set<TimedModule *> const links(_links.begin(), _links.end());
+  map<TimedModule *, int> position;
+  vector<TimedModule *> others;
+  _eval_modules.clear();
   for(deque<TimedModule *>::const_iterator iter = _timed_modules.begin();
       iter != _timed_modules.end();
       ++iter) {
-    (*iter)->ReadInputs( );
+    if(routers.count(*iter)) {
+      position[*iter] = _eval_modules.size();
+      _eval_modules.push_back(*iter);
+    } else if(!links.count(*iter)) {
+      others.push_back(*iter);
+    }
+  }
+
+  // reading inputs and writing outputs only touch the module itself and the
+  // channel ends it owns, so any partition works; links are split evenly in
+  // _ExecutePhase, routers and anything else are split here
+  int const n = _eval_modules.size();
+  int const m = others.size();
+  for(int t = 0; t < _threads; ++t) {
+    for(int i = t * m / _threads; i < (t + 1) * m / _threads; ++i) {
+      _thread_modules[t].push_back(others[i]);
+    }
+    for(int i = t * n / _threads; i < (t + 1) * n / _threads; ++i) {
+      _thread_modules[t].push_back(_eval_modules[i]);
+    }
+  }
+
+  if(!_parallel_evaluate) {
+    return;
+  }
+
+  // During evaluation a router that drains an input buffer marks the
+  // corresponding output buffer state of the upstream router idle (see
+  // IQRouter::_SWAllocUpdate). A router and its upstream neighbours must
+  // therefore be evaluated in the same relative order as the serial loop;
+  // all other router pairs are independent.
+  vector<set<int> > adj(n);
+  map<pair<int, int>, vector<int> > writers;
+  for(int i = 0; i < n; ++i) {
+    Router * const r = static_cast<Router *>(_eval_modules[i]);
+    int const inputs = min(r->NumInputs(), 4);
+    for(int input = 0; input < inputs; ++input) {
+      int const last = r->GetLastID(input);
+      if((last < 0) || (last >= _size) || !_routers[last]) {
+	continue;
+      }
+      int const j = position[_routers[last]];
+      if(j != i) {
+	adj[i].insert(j);
+	adj[j].insert(i);
+      }
+      writers[make_pair(j, r->GetLastOutport(input))].push_back(i);
+    }
+  }
+  for(map<pair<int, int>, vector<int> >::const_iterator iter = writers.begin();
+      iter != writers.end();
+      ++iter) {
+    vector<int> const & w = iter->second;
+    for(size_t a = 0; a < w.size(); ++a) {
+      for(size_t b = a + 1; b < w.size(); ++b) {
+	if(w[a] != w[b]) {
+	  adj[w[a]].insert(w[b]);
+	  adj[w[b]].insert(w[a]);
+	}
+      }
+    }
+  }
+
+  // group routers into wavefronts (anti-diagonals on a mesh); each thread
+  // walks its share of every wavefront in order and only waits on the
+  // earlier neighbours of the router it is about to evaluate
+  _eval_deps.assign(n, vector<int>());
+  vector<int> level(n, 0);
+  int levels = 0;
+  for(int i = 0; i < n; ++i) {
+    for(set<int>::const_iterator iter = adj[i].begin();
+	(iter != adj[i].end()) && (*iter < i);
+	++iter) {
+      _eval_deps[i].push_back(*iter);
+      level[i] = max(level[i], level[*iter] + 1);
+    }
+    levels = max(levels, level[i] + 1);
+  }
+  vector<vector<int> > waves(levels);
+  for(int i = 0; i < n; ++i) {
+    waves[level[i]].push_back(i);
+  }
+  for(int l = 0; l < levels; ++l) {
+    int const size = waves[l].size();
+    for(int t = 0; t < _threads; ++t) {
+      for(int k = t * size / _threads; k < (t + 1) * size / _threads; ++k) {
+	_eval_schedule[t].push_back(waves[l][k]);
+      }
+    }
+  }
+
+  _eval_done = new atomic<int>[n];
+  for(int i = 0; i < n; ++i) {
+    _eval_done[i].store(_eval_epoch);
   }
 }
 
-void Network::Evaluate(int subnet, TrafficManager * trafficManager )
+void Network::_RunPhase( ePhase phase, int subnet, TrafficManager * trafficManager )
+{
+  if(!_pool) {
+    _BuildSchedule( );
+    _pool = new WorkerPool(_threads);
+  }
+  _phase = phase;
+  _phase_subnet = subnet;
+  _phase_tm = trafficManager;
+  if(phase == evaluate) {
+    ++_eval_epoch;
+  }
+  _pool->Run(&_job);
+}
+
+void Network::_ExecutePhase( int thread )
+{
+  if(_phase == evaluate) {
+    vector<int> const & schedule = _eval_schedule[thread];
+    for(vector<int>::const_iterator iter = schedule.begin();
+	iter != schedule.end();
+	++iter) {
+      int const i = *iter;
+      vector<int> const & deps = _eval_deps[i];
+      for(vector<int>::const_iterator dep = deps.begin(); dep != deps.end(); ++dep) {
+	int spins = 0;
+	while(_eval_done[*dep].load(memory_order_acquire) != _eval_epoch) {
+	  WorkerPool::Pause(spins);
+	}
+      }
+      _eval_modules[i]->Evaluate(_phase_subnet, _phase_tm);
+      _eval_done[i].store(_eval_epoch, memory_order_release);
+    }
+    return;
+  }
+  int const time = GetSimTime( );
+  int const l = _links.size();
+  int const begin = thread * l / _threads;
+  int const end = ( thread + 1 ) * l / _threads;
+  vector<TimedModule *> const & modules = _thread_modules[thread];
+  if(_phase == read_inputs) {
+    for(int i = begin; i < end; ++i) {
+      _links[i]->ReadInputsAt(time);
+    }
+    for(vector<TimedModule *>::const_iterator iter = modules.begin();
+	iter != modules.end();
+	++iter) {
+      (*iter)->ReadInputs( );
+    }
+  } else {
+    for(int i = begin; i < end; ++i) {
+      _links[i]->WriteOutputsAt(time);
+    }
+    for(vector<TimedModule *>::const_iterator iter = modules.begin();
+	iter != modules.end();
+	++iter) {
+      (*iter)->WriteOutputs( );
+    }
+  }
+}
+
+void Network::_BuildStepLists( )
 {
+  set<TimedModule *> const links(_links.begin(), _links.end());
+  _iq_routers.clear();
+  _other_modules.clear();
   for(deque<TimedModule *>::const_iterator iter = _timed_modules.begin();
       iter != _timed_modules.end();
       ++iter) {
+    if(links.count(*iter)) {
+      continue;
+    }
+    // IQRouter pipeline variants only specialize _InternalStep, which 
+    // Evaluate still dispatches virtually
+    IQRouter * const r = dynamic_cast<IQRouter *>(*iter);
+    if(r) {
+      _iq_routers.push_back(r);
+    } else {
+      _other_modules.push_back(*iter);
+    }
+  }
+  _step_lists_built = true;
+}
+
+void Network::_InitActiveSet( )
+{
+  _module_list.assign(_links.begin(), _links.end());
+  _module_list.insert(_module_list.end(), _iq_routers.begin(), _iq_routers.end());
+  _module_list.insert(_module_list.end(), _other_modules.begin(), _other_modules.end());
+  _awake.Resize(_module_list.size());
+  for(size_t i = 0; i < _module_list.size(); ++i) {
+    _module_list[i]->SetWakeSet(&_awake, i);
+    _awake.Insert(i);
+  }
+}
+
+void Network::ReadInputs( )
+{
+  if(!_step_lists_built) {
+    _BuildStepLists( );
+  }
+  if(_threads > 1) {
+    _RunPhase(read_inputs);
+    return;
+  }
+  int const time = GetSimTime( );
+  int const l = _links.size();
+  int const r = _iq_routers.size();
+  if(_use_active_set) {
+    if(_module_list.empty()) {
+      _InitActiveSet( );
+    }
+    int i = _awake.Next(0);
+    for(; ( i >= 0 ) && ( i < l ); i = _awake.Next(i + 1)) {
+      _links[i]->ReadInputsAt(time);
+    }
+    for(; ( i >= 0 ) && ( i < l + r ); i = _awake.Next(i + 1)) {
+      _iq_routers[i - l]->IQRouter::ReadInputs( );
+    }
+    for(; i >= 0; i = _awake.Next(i + 1)) {
+      _other_modules[i - l - r]->ReadInputs( );
+    }
+    return;
+  }
+  for(int i = 0; i < l; ++i) {
+    _links[i]->ReadInputsAt(time);
+  }
+  for(int i = 0; i < r; ++i) {
+    _iq_routers[i]->IQRouter::ReadInputs( );
+  }
+  for(vector<TimedModule *>::const_iterator iter = _other_modules.begin();
+      iter != _other_modules.end();
+      ++iter) {
+    (*iter)->ReadInputs( );
+  }
+}
+
+void Network::Evaluate(int subnet, TrafficManager * trafficManager )
+{
+  // links have nothing to evaluate, so the parallel schedule only covers
+  // the routers
+  if(_parallel_evaluate) {
+    _RunPhase(evaluate, subnet, trafficManager);
+    return;
+  }
+  int const l = _links.size();
+  int const r = _iq_routers.size();
+  if(_use_active_set) {
+    // routers woken further down the list are still evaluated this cycle,
+    // just as they would be by a full sweep
+    int i = _awake.Next(l);
+    for(; ( i >= 0 ) && ( i < l + r ); i = _awake.Next(i + 1)) {
+      _iq_routers[i - l]->IQRouter::Evaluate(subnet, trafficManager);
+    }
+    for(; i >= 0; i = _awake.Next(i + 1)) {
+      _other_modules[i - l - r]->Evaluate(subnet, trafficManager);
+    }
+    return;
+  }
+  for(int i = 0; i < r; ++i) {
+    _iq_routers[i]->IQRouter::Evaluate(subnet, trafficManager);
+  }
+  for(vector<TimedModule *>::const_iterator iter = _other_modules.begin();
+      iter != _other_modules.end();
+      ++iter) {
     (*iter)->Evaluate(subnet, trafficManager);
   }
 }
 
 void Network::WriteOutputs( )
 {
+  if(_threads > 1) {
+    _RunPhase(write_outputs);
+    return;
+  }
+  int const time = GetSimTime( );
+  int const l = _links.size();
+  int const r = _iq_routers.size();
+  if(_use_active_set) {
+    int i = _awake.Next(0);
+    for(; ( i >= 0 ) && ( i < l ); i = _awake.Next(i + 1)) {
+      Link * const link = _links[i];
+      link->WriteOutputsAt(time);
+      if(link->Link::Idle( )) {
+	_awake.Erase(i);
+      }
+    }
+    for(; ( i >= 0 ) && ( i < l + r ); i = _awake.Next(i + 1)) {
+      IQRouter * const router = _iq_routers[i - l];
+      router->IQRouter::WriteOutputs( );
+      if(router->IQRouter::Idle( )) {
+	_awake.Erase(i);
+      }
+    }
+    for(; i >= 0; i = _awake.Next(i + 1)) {
+      TimedModule * const m = _other_modules[i - l - r];
+      m->WriteOutputs( );
+      if(m->Idle( )) {
+	_awake.Erase(i);
+      }
+    }
+    return;
+  }
+  for(int i = 0; i < l; ++i) {
+    _links[i]->WriteOutputsAt(time);
+  }
+  for(int i = 0; i < r; ++i) {
+    _iq_routers[i]->IQRouter::WriteOutputs( );
+  }
+  for(vector<TimedModule *>::const_iterator iter = _other_modules.begin();
+      iter != _other_modules.end();
+      ++iter) {
+    (*iter)->WriteOutputs( );
+  }
+}
+
+bool Network::Idle( ) const
+{
+  return ( _use_active_set && !_module_list.empty() && ( _awake.Next(0) < 0 ) );
+}
+
+void Network::Serialize( Checkpoint & ckpt )
+{
+  ckpt.Check(_timed_modules.size(), "network modules");
   for(deque<TimedModule *>::const_iterator iter = _timed_modules.begin();
       iter != _timed_modules.end();
       ++iter) {
-    (*iter)->WriteOutputs( );
+    (*iter)->Serialize( ckpt );
+  }
+  if(ckpt.Loading() && !_module_list.empty()) {
+    // restored modules may have work pending; let them go back to sleep
+    _InitActiveSet( );
   }
 }
 
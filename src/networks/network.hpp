@@ -30,6 +30,7 @@
 
 #include <vector>
 #include <deque>
+#include <atomic>
 
 #include "module.hpp"
 #include "flit.hpp"
@@ -39,13 +40,18 @@
 #include "timed_module.hpp"
 #include "flitchannel.hpp"
 #include "channel.hpp"
+#include "link.hpp"
 #include "config_utils.hpp"
 #include "globals.hpp"
+#include "worker_pool.hpp"
+#include "active_set.hpp"
 
 class TrafficManager;
 
 typedef Channel<Credit> CreditChannel;
 
+class IQRouter;
+
 
 class Network : public TimedModule {
 protected:
@@ -66,19 +72,73 @@ protected:
   vector<FlitChannel *> _chan;
   vector<CreditChannel *> _chan_cred;
 
+  // each flit channel and its credit channel are stepped as one link
+  vector<Link *> _links;
+
   deque<TimedModule *> _timed_modules;
 
+  // Stepping core: the timed modules grouped by type so that links and
+  // input-queued routers are stepped by loops of direct calls; modules of
+  // any other type go through the TimedModule interface. Within each group
+  // modules keep their _timed_modules order.
+  bool _step_lists_built;
+  vector<IQRouter *> _iq_routers;
+  vector<TimedModule *> _other_modules;
+
+  void _BuildStepLists( );
+
+  // active-set scheduling (serial stepping only): modules are indexed
+  // links first, then IQ routers, then the rest, and are only visited
+  // while they are awake
+  bool _use_active_set;
+  ActiveSet _awake;
+  vector<TimedModule *> _module_list;
+
+  void _InitActiveSet( );
+
+  // parallel stepping (network_threads > 1)
+  enum ePhase { read_inputs, evaluate, write_outputs };
+
+  class PhaseJob : public WorkerPool::Job {
+  public:
+    Network * net;
+    void Execute( int thread ) { net->_ExecutePhase( thread ); }
+  };
+
+  int _threads;
+  bool _parallel_evaluate;
+  WorkerPool * _pool;
+  PhaseJob _job;
+
+  ePhase _phase;
+  int _phase_subnet;
+  TrafficManager * _phase_tm;
+
+  vector<vector<TimedModule *> > _thread_modules;
+  vector<TimedModule *> _eval_modules;
+  vector<vector<int> > _eval_schedule;
+  vector<vector<int> > _eval_deps;
+  atomic<int> * _eval_done;
+  int _eval_epoch;
+
   virtual void _ComputeSize( const Configuration &config ) = 0;
   virtual void _BuildNet( const Configuration &config ) = 0;
 
   void _Alloc( );
 
+  void _BuildSchedule( );
+  void _RunPhase( ePhase phase, int subnet = 0, TrafficManager * trafficManager = NULL );
+  void _ExecutePhase( int thread );
+
 public:
   Network( const Configuration &config, const string & name );
   virtual ~Network( );
 
   static Network *New( const Configuration &config, const string & name );
 
+  static bool ParallelSteppingSafe( const Configuration &config );
+  static bool ParallelEvaluateSafe( const Configuration &config );
+
   virtual void WriteFlit( Flit *f, int source );
   virtual Flit *ReadFlit( int dest );
 
@@ -96,6 +156,11 @@ public:
   virtual void Evaluate(int subnet, TrafficManager * trafficManager );
   virtual void WriteOutputs( );
 
+  // all modules are idle; only known when stepping with an active set
+  virtual bool Idle( ) const;
+
+  virtual void Serialize( Checkpoint & ckpt );
+
   void Display( ostream & os = cout ) const;
   void DumpChannelMap( ostream & os = cout, string const & prefix = "" ) const;
   void DumpNodeMap( ostream & os = cout, string const & prefix = "" ) const;
@@ -34,13 +34,44 @@
  */
 
 #include <cassert>
+#include <cstring>
 
 #include "booksim.hpp"
 #include "outputset.hpp"
 
+OutputSet::OutputSet( OutputSet const & s ) : _size(0)
+{
+  *this = s;
+}
+
+OutputSet::~OutputSet( )
+{
+  Clear( );
+}
+
+OutputSet & OutputSet::operator=( OutputSet const & s )
+{
+  if ( this != &s ) {
+    Clear( );
+    if ( s._size > _inline_size ) {
+      int capacity = 2 * _inline_size;
+      while ( capacity < s._size ) {
+	capacity *= 2;
+      }
+      _heap = new sSetElement[capacity];
+    }
+    _size = s._size;
+    memcpy( _Elements( ), s._Elements( ), _size * sizeof( sSetElement ) );
+  }
+  return *this;
+}
+
 void OutputSet::Clear( )
 {
-  _outputs.clear( );
+  if ( _size > _inline_size ) {
+    delete [] _heap;
+  }
+  _size = 0;
 }
 
 void OutputSet::Add( int output_port, int vc, int pri  )
@@ -50,22 +81,46 @@ void OutputSet::Add( int output_port, int vc, int pri  )
 
 void OutputSet::AddRange( int output_port, int vc_start, int vc_end, int pri )
 {
+  sSetElement * elements = _Elements( );
+
+  // keep the first element added for each priority, lower priorities last
+  int pos = 0;
+  while ( ( pos < _size ) && ( elements[pos].pri >= pri ) ) {
+    if ( elements[pos].pri == pri ) {
+      return;
+    }
+    ++pos;
+  }
 
-  sSetElement s;
+  if ( _size == _inline_size ) {
+    sSetElement * heap = new sSetElement[2 * _inline_size];
+    memcpy( heap, _inline, _size * sizeof( sSetElement ) );
+    _heap = heap;
+    elements = heap;
+  } else if ( ( _size > _inline_size ) && !( _size & ( _size - 1 ) ) ) {
+    sSetElement * heap = new sSetElement[2 * _size];
+    memcpy( heap, _heap, _size * sizeof( sSetElement ) );
+    delete [] _heap;
+    _heap = heap;
+    elements = heap;
+  }
+
+  memmove( elements + pos + 1, elements + pos, ( _size - pos ) * sizeof( sSetElement ) );
 
+  sSetElement & s = elements[pos];
   s.vc_start = vc_start;
   s.vc_end   = vc_end;
   s.pri      = pri;
   s.output_port = output_port;
-  _outputs.insert( s );
+  ++_size;
 }
 
 //legacy support, for performance, just use GetSet()
 int OutputSet::NumVCs( int output_port ) const
 {
   int total = 0;
-  set<sSetElement>::const_iterator i = _outputs.begin( );
-  while(i!=_outputs.end( )){
+  const_iterator i = begin( );
+  while(i!=end( )){
     if(i->output_port == output_port){
       total += (i->vc_end - i->vc_start + 1);
     }
@@ -76,8 +131,8 @@ int OutputSet::NumVCs( int output_port ) const
 
 bool OutputSet::OutputEmpty( int output_port ) const
 {
-  set<sSetElement>::const_iterator i = _outputs.begin( );
-  while(i!=_outputs.end( )){
+  const_iterator i = begin( );
+  while(i!=end( )){
     if(i->output_port == output_port){
       return false;
     }
@@ -86,11 +141,6 @@ bool OutputSet::OutputEmpty( int output_port ) const
   return true;
 }
 
-
-const set<OutputSet::sSetElement> & OutputSet::GetSet() const{
-  return _outputs;
-}
-
 //legacy support, for performance, just use GetSet()
 int OutputSet::GetVC( int output_port, int vc_index, int *pri ) const
 {
@@ -101,8 +151,8 @@ int OutputSet::GetVC( int output_port, int vc_index, int *pri ) const
   
   if ( pri ) { *pri = -1; }
 
-  set<sSetElement>::const_iterator i = _outputs.begin( );
-  while(i!=_outputs.end( )){
+  const_iterator i = begin( );
+  while(i!=end( )){
     if(i->output_port == output_port){
       range = i->vc_end - i->vc_start + 1;
       if ( remaining >= range ) {
@@ -128,11 +178,11 @@ bool OutputSet::GetPortVC( int *out_port, int *out_vc ) const
   bool single_output = false;
   int  used_outputs  = 0;
 
-  set<sSetElement>::const_iterator i = _outputs.begin( );
-  if(i!=_outputs.end( )){
+  const_iterator i = begin( );
+  if(i!=end( )){
     used_outputs = i->output_port;
   }
-  while(i!=_outputs.end( )){
+  while(i!=end( )){
 
     if ( i->vc_start == i->vc_end ) {
       *out_vc   = i->vc_start;
@@ -28,8 +28,10 @@
 #ifndef _OUTPUTSET_HPP_
 #define _OUTPUTSET_HPP_
 
-#include <set>
-
+// Route candidates, kept sorted by priority (highest first); adding an
+// element whose priority is already present has no effect. Routing
+// functions rarely produce more than a handful of candidates, so they are
+// stored inline and only spill to the heap past _inline_size elements.
 class OutputSet {
 
 
@@ -41,6 +43,14 @@ public:
     int output_port;
   };
 
+  typedef sSetElement const * const_iterator;
+
+  OutputSet( ) : _size(0) {}
+  OutputSet( OutputSet const & s );
+  ~OutputSet( );
+
+  OutputSet & operator=( OutputSet const & s );
+
   void Clear( );
   void Add( int output_port, int vc, int pri = 0 );
   void AddRange( int output_port, int vc_start, int vc_end, int pri = 0 );
@@ -48,19 +58,32 @@ public:
   bool OutputEmpty( int output_port ) const;
   int NumVCs( int output_port ) const;
   
-  const set<sSetElement> & GetSet() const;
+  const OutputSet & GetSet() const { return *this; }
+
+  inline const_iterator begin( ) const { return _Elements( ); }
+  inline const_iterator end( ) const { return _Elements( ) + _size; }
+  inline int size( ) const { return _size; }
+  inline bool empty( ) const { return _size == 0; }
 
   int  GetVC( int output_port,  int vc_index, int *pri = 0 ) const;
   bool GetPortVC( int *out_port, int *out_vc ) const;
 private:
-  set<sSetElement> _outputs;
-};
+  static int const _inline_size = 4;
+
+  int _size;
+  union {
+    sSetElement _inline[_inline_size];
+    // past _inline_size elements; the capacity is the smallest power of
+    // two that holds _size
+    sSetElement * _heap;
+  };
 
-inline bool operator<(const OutputSet::sSetElement & se1, 
-	       const OutputSet::sSetElement & se2) {
-  return se1.pri > se2.pri; // higher priorities first!
-}
+  inline sSetElement * _Elements( ) {
+    return (_size > _inline_size) ? _heap : _inline;
+  }
+  inline sSetElement const * _Elements( ) const {
+    return (_size > _inline_size) ? _heap : _inline;
+  }
+};
 
 #endif
-
-
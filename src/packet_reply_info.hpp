@@ -28,9 +28,8 @@
 #ifndef _PACKET_REPLY_INFO_HPP_
 #define _PACKET_REPLY_INFO_HPP_
 
-#include <stack>
-
 #include "flit.hpp"
+#include "slab_pool.hpp"
 
 //register the requests to a node
 class PacketReplyInfo {
@@ -47,8 +46,7 @@ public:
 
 private:
 
-  static stack<PacketReplyInfo*> _all;
-  static stack<PacketReplyInfo*> _free;
+  friend class SlabPool<PacketReplyInfo>;
 
   PacketReplyInfo() {}
   ~PacketReplyInfo() {}
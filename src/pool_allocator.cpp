@@ -0,0 +1,88 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*pool_allocator.cpp
+ *
+ *Per-thread free lists for the small blocks handed out by PoolAllocator
+ */
+
+#include <new>
+#include <vector>
+
+#include "booksim.hpp"
+#include "pool_allocator.hpp"
+
+// blocks are rounded up to a multiple of the granule; anything larger than
+// the largest class goes straight to the heap
+static size_t const gGranule = 16;
+static size_t const gClasses = 64;
+
+struct FreeLists {
+  vector<void *> free[gClasses];
+  ~FreeLists( );
+};
+
+static thread_local FreeLists gFreeLists;
+
+// set once a thread's free lists are gone, so that containers destroyed
+// later on (e.g. during static destruction) still release their blocks
+static thread_local bool gFreeListsDone = false;
+
+FreeLists::~FreeLists( )
+{
+  for(size_t c = 0; c < gClasses; ++c) {
+    for(size_t i = 0; i < free[c].size(); ++i) {
+      ::operator delete(free[c][i]);
+    }
+  }
+  gFreeListsDone = true;
+}
+
+void * PoolAllocate( size_t size )
+{
+  size_t const c = (size + gGranule - 1) / gGranule;
+  if((c == 0) || (c > gClasses) || gFreeListsDone) {
+    return ::operator new(size);
+  }
+  vector<void *> & free = gFreeLists.free[c - 1];
+  if(free.empty()) {
+    return ::operator new(c * gGranule);
+  }
+  void * p = free.back();
+  free.pop_back();
+  return p;
+}
+
+void PoolDeallocate( void * p, size_t size )
+{
+  size_t const c = (size + gGranule - 1) / gGranule;
+  if((c == 0) || (c > gClasses) || gFreeListsDone) {
+    ::operator delete(p);
+    return;
+  }
+  gFreeLists.free[c - 1].push_back(p);
+}
@@ -0,0 +1,71 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef _POOL_ALLOCATOR_HPP_
+#define _POOL_ALLOCATOR_HPP_
+
+#include <cstddef>
+
+using namespace std;
+
+// Small blocks are recycled through per-thread free lists kept by size, so
+// that containers which keep inserting and erasing (the request maps of the
+// allocators, the in-flight flit maps, ...) stop going to the heap once
+// they have seen their largest size.
+void * PoolAllocate( size_t size );
+void PoolDeallocate( void * p, size_t size );
+
+// STL allocator on top of the free lists above
+template<class T> class PoolAllocator {
+
+public:
+  typedef T value_type;
+
+  PoolAllocator( ) {}
+  template<class U> PoolAllocator( PoolAllocator<U> const & ) {}
+
+  T * allocate( size_t n ) {
+    return static_cast<T *>(PoolAllocate(n * sizeof(T)));
+  }
+  void deallocate( T * p, size_t n ) {
+    PoolDeallocate(p, n * sizeof(T));
+  }
+};
+
+template<class T, class U>
+inline bool operator==( PoolAllocator<T> const &, PoolAllocator<U> const & )
+{
+  return true;
+}
+
+template<class T, class U>
+inline bool operator!=( PoolAllocator<T> const &, PoolAllocator<U> const & )
+{
+  return false;
+}
+
+#endif
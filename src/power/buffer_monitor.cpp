@@ -28,6 +28,7 @@
 #include "buffer_monitor.hpp"
 
 #include "flit.hpp"
+#include "checkpoint.hpp"
 
 BufferMonitor::BufferMonitor( int inputs, int classes ) 
 : _cycles(0), _inputs(inputs), _classes(classes) {
@@ -46,11 +47,11 @@ void BufferMonitor::cycle() {
 }
 
 void BufferMonitor::write( int input, Flit const * f ) {
-  _writes[ index(input, f->cl) ]++ ;
+  _writes[ index(input, f->packet->cl) ]++ ;
 }
 
 void BufferMonitor::read( int input, Flit const * f ) {
-  _reads[ index(input, f->cl) ]++ ;
+  _reads[ index(input, f->packet->cl) ]++ ;
 }
 
 void BufferMonitor::display(ostream & os) const {
@@ -69,3 +70,9 @@ ostream & operator<<( ostream & os, BufferMonitor const & obj ) {
   obj.display(os);
   return os ;
 }
+
+void BufferMonitor::Serialize( Checkpoint & ckpt ) {
+  ckpt.Sync( _cycles ) ;
+  ckpt.Sync( _reads ) ;
+  ckpt.Sync( _writes ) ;
+}
@@ -28,6 +28,7 @@
 #include "switch_monitor.hpp"
 
 #include "flit.hpp"
+#include "checkpoint.hpp"
 
 SwitchMonitor::SwitchMonitor( int inputs, int outputs, int classes )
 : _cycles(0), _inputs(inputs), _outputs(outputs), _classes(classes) {
@@ -46,7 +47,7 @@ void SwitchMonitor::cycle() {
 }
 
 void SwitchMonitor::traversal( int input, int output, Flit const * f ) {
-  _event[ index( input, output, f->cl) ]++ ;
+  _event[ index( input, output, f->packet->cl) ]++ ;
 }
 
 void SwitchMonitor::display(ostream & os) const {
@@ -65,3 +66,8 @@ ostream & operator<<( ostream & os, SwitchMonitor const & obj ) {
   obj.display(os);
   return os ;
 }
+
+void SwitchMonitor::Serialize( Checkpoint & ckpt ) {
+  ckpt.Sync( _cycles ) ;
+  ckpt.Sync( _event ) ;
+}
@@ -31,6 +31,12 @@
 
 extern long ran_x[];
 extern double ran_u[];
+extern long ran_arr_buf[];
+extern long ran_arr_dummy, ran_arr_started;
+extern long * ran_arr_ptr;
+extern double ranf_arr_buf[];
+extern double ranf_arr_dummy, ranf_arr_started;
+extern double * ranf_arr_ptr;
 #define KK 100
 
 void SaveRandomState( std::vector<long> & save_x, std::vector<double> & save_u ) {
@@ -44,3 +50,44 @@ void RestoreRandomState( std::vector<long> const & save_x, std::vector<double> c
   assert(save_u.size() == KK);
   std::copy(save_u.begin(), save_u.end(), ran_u);
 }
+
+// the position in the output buffer is stored as an index, with -2 and -1
+// standing for the "not seeded" and "freshly seeded" sentinels
+template<class T>
+static T EncodePosition( T * ptr, T * buf, T * dummy, T * started ) {
+  if(ptr == dummy) {
+    return -2;
+  } else if(ptr == started) {
+    return -1;
+  }
+  return ptr - buf;
+}
+
+template<class T>
+static T * DecodePosition( T pos, T * buf, T * dummy, T * started ) {
+  if(pos == -2) {
+    return dummy;
+  } else if(pos == -1) {
+    return started;
+  }
+  return buf + (long)pos;
+}
+
+void SaveRandomStream( std::vector<long> & save_x, std::vector<double> & save_u ) {
+  SaveRandomState(save_x, save_u);
+  save_x.insert(save_x.end(), ran_arr_buf, ran_arr_buf + KK + 1);
+  save_x.push_back(EncodePosition(ran_arr_ptr, ran_arr_buf, &ran_arr_dummy, &ran_arr_started));
+  save_u.insert(save_u.end(), ranf_arr_buf, ranf_arr_buf + KK + 1);
+  save_u.push_back(EncodePosition(ranf_arr_ptr, ranf_arr_buf, &ranf_arr_dummy, &ranf_arr_started));
+}
+
+void RestoreRandomStream( std::vector<long> const & save_x, std::vector<double> const & save_u ) {
+  assert(save_x.size() == KK + KK + 2);
+  assert(save_u.size() == KK + KK + 2);
+  RestoreRandomState(std::vector<long>(save_x.begin(), save_x.begin() + KK),
+                     std::vector<double>(save_u.begin(), save_u.begin() + KK));
+  std::copy(save_x.begin() + KK, save_x.begin() + KK + KK + 1, ran_arr_buf);
+  ran_arr_ptr = DecodePosition(save_x.back(), ran_arr_buf, &ran_arr_dummy, &ran_arr_started);
+  std::copy(save_u.begin() + KK, save_u.begin() + KK + KK + 1, ranf_arr_buf);
+  ranf_arr_ptr = DecodePosition(save_u.back(), ranf_arr_buf, &ranf_arr_dummy, &ranf_arr_started);
+}
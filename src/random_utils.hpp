@@ -66,4 +66,10 @@ void SaveRandomState( std::vector<long> & save_x, std::vector<double> & save_u )
 // Restores the generator state from previously saved values
 void RestoreRandomState( std::vector<long> const & save_x, std::vector<double> const & save_u );
 
+// Like SaveRandomState, but also captures the numbers that have already
+// been generated and not yet handed out, so that restoring continues the
+// exact same sequence
+void SaveRandomStream( std::vector<long> & save_x, std::vector<double> & save_u );
+void RestoreRandomStream( std::vector<long> const & save_x, std::vector<double> const & save_u );
+
 #endif
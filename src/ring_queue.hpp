@@ -0,0 +1,126 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef _RING_QUEUE_HPP_
+#define _RING_QUEUE_HPP_
+
+#include <vector>
+#include <cstddef>
+#include <cassert>
+
+using namespace std;
+
+// A FIFO kept in a power-of-two ring. Its capacity is set up front from
+// the bound on the number of queued items, so that pushing and popping on
+// the per-cycle path never touches the heap; should the bound turn out to
+// be too small, the ring doubles in size instead of overflowing.
+template<class T> class RingQueue {
+
+  vector<T> _ring;
+  size_t _mask;
+  size_t _head;
+  size_t _size;
+
+  void _Grow( ) {
+    vector<T> ring(2 * _ring.size());
+    for(size_t i = 0; i < _size; ++i) {
+      ring[i] = _ring[(_head + i) & _mask];
+    }
+    _ring.swap(ring);
+    _mask = _ring.size() - 1;
+    _head = 0;
+  }
+
+public:
+
+  class iterator {
+    RingQueue * _q;
+    size_t _i;
+  public:
+    iterator( RingQueue * q, size_t i ) : _q(q), _i(i) {}
+    T & operator*( ) const { return (*_q)[_i]; }
+    T * operator->( ) const { return &(*_q)[_i]; }
+    iterator & operator++( ) { ++_i; return *this; }
+    bool operator==( iterator const & other ) const { return _i == other._i; }
+    bool operator!=( iterator const & other ) const { return _i != other._i; }
+  };
+
+  RingQueue( size_t capacity = 1 ) : _ring(1), _mask(0), _head(0), _size(0) {
+    Reserve(capacity);
+  }
+
+  void Reserve( size_t capacity ) {
+    while(_ring.size() < capacity) {
+      _Grow();
+    }
+  }
+
+  bool empty( ) const { return _size == 0; }
+  size_t size( ) const { return _size; }
+
+  T & front( ) { assert(_size); return _ring[_head]; }
+  T const & front( ) const { assert(_size); return _ring[_head]; }
+
+  T & operator[]( size_t i ) { assert(i < _size); return _ring[(_head + i) & _mask]; }
+  T const & operator[]( size_t i ) const { assert(i < _size); return _ring[(_head + i) & _mask]; }
+
+  iterator begin( ) { return iterator(this, 0); }
+  iterator end( ) { return iterator(this, _size); }
+
+  void push_back( T const & item ) {
+    if(_size == _ring.size()) {
+      T const copy = item;
+      _Grow();
+      _ring[_size++] = copy;
+      return;
+    }
+    _ring[(_head + _size) & _mask] = item;
+    ++_size;
+  }
+
+  void pop_front( ) {
+    assert(_size);
+    _head = (_head + 1) & _mask;
+    --_size;
+  }
+
+  void clear( ) {
+    _head = 0;
+    _size = 0;
+  }
+
+  void resize( size_t n ) {
+    while(_size > n) {
+      --_size;
+    }
+    while(_size < n) {
+      push_back(T());
+    }
+  }
+};
+
+#endif
@@ -76,16 +76,16 @@ void qtree_nca( const Router *r, const Flit *f,
 		int in_channel, OutputSet* outputs, bool inject)
 {
   int vcBegin = 0, vcEnd = gNumVCs-1;
-  if ( f->type == Flit::READ_REQUEST ) {
+  if ( f->packet->type == Flit::READ_REQUEST ) {
     vcBegin = gReadReqBeginVC;
     vcEnd = gReadReqEndVC;
-  } else if ( f->type == Flit::WRITE_REQUEST ) {
+  } else if ( f->packet->type == Flit::WRITE_REQUEST ) {
     vcBegin = gWriteReqBeginVC;
     vcEnd = gWriteReqEndVC;
-  } else if ( f->type ==  Flit::READ_REPLY ) {
+  } else if ( f->packet->type ==  Flit::READ_REPLY ) {
     vcBegin = gReadReplyBeginVC;
     vcEnd = gReadReplyEndVC;
-  } else if ( f->type ==  Flit::WRITE_REPLY ) {
+  } else if ( f->packet->type ==  Flit::WRITE_REPLY ) {
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
@@ -102,7 +102,7 @@ void qtree_nca( const Router *r, const Flit *f,
     int height = QTree::HeightFromID( r->GetID() );
     int pos    = QTree::PosFromID( r->GetID() );
     
-    int dest   = f->dest;
+    int dest   = f->packet->dest;
     
     for (int i = height+1; i < gN; i++) 
       dest /= gK;
@@ -127,16 +127,16 @@ void tree4_anca( const Router *r, const Flit *f,
 		 int in_channel, OutputSet* outputs, bool inject)
 {
   int vcBegin = 0, vcEnd = gNumVCs-1;
-  if ( f->type == Flit::READ_REQUEST ) {
+  if ( f->packet->type == Flit::READ_REQUEST ) {
     vcBegin = gReadReqBeginVC;
     vcEnd = gReadReqEndVC;
-  } else if ( f->type == Flit::WRITE_REQUEST ) {
+  } else if ( f->packet->type == Flit::WRITE_REQUEST ) {
     vcBegin = gWriteReqBeginVC;
     vcEnd = gWriteReqEndVC;
-  } else if ( f->type ==  Flit::READ_REPLY ) {
+  } else if ( f->packet->type ==  Flit::READ_REPLY ) {
     vcBegin = gReadReplyBeginVC;
     vcEnd = gReadReplyEndVC;
-  } else if ( f->type ==  Flit::WRITE_REPLY ) {
+  } else if ( f->packet->type ==  Flit::WRITE_REPLY ) {
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
@@ -152,7 +152,7 @@ void tree4_anca( const Router *r, const Flit *f,
 
   } else {
 
-    int dest = f->dest;
+    int dest = f->packet->dest;
     
     const int NPOS = 16;
     
@@ -179,7 +179,7 @@ void tree4_anca( const Router *r, const Flit *f,
       }
     }
     
-    //  cout << "Router("<<rH<<","<<rP<<"): id= " << f->id << " dest= " << f->dest << " out_port = "
+    //  cout << "Router("<<rH<<","<<rP<<"): id= " << f->id << " dest= " << f->packet->dest << " out_port = "
     //       << out_port << endl;
 
   }
@@ -197,16 +197,16 @@ void tree4_nca( const Router *r, const Flit *f,
 		int in_channel, OutputSet* outputs, bool inject)
 {
   int vcBegin = 0, vcEnd = gNumVCs-1;
-  if ( f->type == Flit::READ_REQUEST ) {
+  if ( f->packet->type == Flit::READ_REQUEST ) {
     vcBegin = gReadReqBeginVC;
     vcEnd = gReadReqEndVC;
-  } else if ( f->type == Flit::WRITE_REQUEST ) {
+  } else if ( f->packet->type == Flit::WRITE_REQUEST ) {
     vcBegin = gWriteReqBeginVC;
     vcEnd = gWriteReqEndVC;
-  } else if ( f->type ==  Flit::READ_REPLY ) {
+  } else if ( f->packet->type ==  Flit::READ_REPLY ) {
     vcBegin = gReadReplyBeginVC;
     vcEnd = gReadReplyEndVC;
-  } else if ( f->type ==  Flit::WRITE_REPLY ) {
+  } else if ( f->packet->type ==  Flit::WRITE_REPLY ) {
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
@@ -220,7 +220,7 @@ void tree4_nca( const Router *r, const Flit *f,
 
   } else {
 
-    int dest = f->dest;
+    int dest = f->packet->dest;
     
     const int NPOS = 16;
     
@@ -243,7 +243,7 @@ void tree4_nca( const Router *r, const Flit *f,
 	out_port = gK + RandomInt(1);
     }
     
-    //  cout << "Router("<<rH<<","<<rP<<"): id= " << f->id << " dest= " << f->dest << " out_port = "
+    //  cout << "Router("<<rH<<","<<rP<<"): id= " << f->id << " dest= " << f->packet->dest << " out_port = "
     //       << out_port << endl;
 
   }
@@ -260,16 +260,16 @@ void fattree_nca( const Router *r, const Flit *f,
                int in_channel, OutputSet* outputs, bool inject)
 {
   int vcBegin = 0, vcEnd = gNumVCs-1;
-  if ( f->type == Flit::READ_REQUEST ) {
+  if ( f->packet->type == Flit::READ_REQUEST ) {
     vcBegin = gReadReqBeginVC;
     vcEnd = gReadReqEndVC;
-  } else if ( f->type == Flit::WRITE_REQUEST ) {
+  } else if ( f->packet->type == Flit::WRITE_REQUEST ) {
     vcBegin = gWriteReqBeginVC;
     vcEnd = gWriteReqEndVC;
-  } else if ( f->type ==  Flit::READ_REPLY ) {
+  } else if ( f->packet->type ==  Flit::READ_REPLY ) {
     vcBegin = gReadReplyBeginVC;
     vcEnd = gReadReplyEndVC;
-  } else if ( f->type ==  Flit::WRITE_REPLY ) {
+  } else if ( f->packet->type ==  Flit::WRITE_REPLY ) {
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
@@ -283,7 +283,7 @@ void fattree_nca( const Router *r, const Flit *f,
 
   } else {
     
-    int dest = f->dest;
+    int dest = f->packet->dest;
     int router_id = r->GetID(); //routers are numbered with smallest at the top level
     int routers_per_level = powi(gK, gN-1);
     int pos = router_id%routers_per_level;
@@ -325,16 +325,16 @@ void fattree_anca( const Router *r, const Flit *f,
 {
 
   int vcBegin = 0, vcEnd = gNumVCs-1;
-  if ( f->type == Flit::READ_REQUEST ) {
+  if ( f->packet->type == Flit::READ_REQUEST ) {
     vcBegin = gReadReqBeginVC;
     vcEnd = gReadReqEndVC;
-  } else if ( f->type == Flit::WRITE_REQUEST ) {
+  } else if ( f->packet->type == Flit::WRITE_REQUEST ) {
     vcBegin = gWriteReqBeginVC;
     vcEnd = gWriteReqEndVC;
-  } else if ( f->type ==  Flit::READ_REPLY ) {
+  } else if ( f->packet->type ==  Flit::READ_REPLY ) {
     vcBegin = gReadReplyBeginVC;
     vcEnd = gReadReplyEndVC;
-  } else if ( f->type ==  Flit::WRITE_REPLY ) {
+  } else if ( f->packet->type ==  Flit::WRITE_REPLY ) {
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
@@ -350,7 +350,7 @@ void fattree_anca( const Router *r, const Flit *f,
   } else {
 
 
-    int dest = f->dest;
+    int dest = f->packet->dest;
     int router_id = r->GetID(); //routers are numbered with smallest at the top level
     int routers_per_level = powi(gK, gN-1);
     int pos = router_id%routers_per_level;
@@ -405,16 +405,16 @@ void adaptive_xy_yx_mesh( const Router *r, const Flit *f,
 		 int in_channel, OutputSet *outputs, bool inject )
 {
   int vcBegin = 0, vcEnd = gNumVCs-1;
-  if ( f->type == Flit::READ_REQUEST ) {
+  if ( f->packet->type == Flit::READ_REQUEST ) {
     vcBegin = gReadReqBeginVC;
     vcEnd = gReadReqEndVC;
-  } else if ( f->type == Flit::WRITE_REQUEST ) {
+  } else if ( f->packet->type == Flit::WRITE_REQUEST ) {
     vcBegin = gWriteReqBeginVC;
     vcEnd = gWriteReqEndVC;
-  } else if ( f->type ==  Flit::READ_REPLY ) {
+  } else if ( f->packet->type ==  Flit::READ_REPLY ) {
     vcBegin = gReadReplyBeginVC;
     vcEnd = gReadReplyEndVC;
-  } else if ( f->type ==  Flit::WRITE_REPLY ) {
+  } else if ( f->packet->type ==  Flit::WRITE_REPLY ) {
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
@@ -426,7 +426,7 @@ void adaptive_xy_yx_mesh( const Router *r, const Flit *f,
 
     out_port = -1;
 
-  } else if(r->GetID() == f->dest) {
+  } else if(r->GetID() == f->packet->dest) {
 
     // at destination router, we don't need to separate VCs by dim order
     out_port = 2*gN;
@@ -437,8 +437,8 @@ void adaptive_xy_yx_mesh( const Router *r, const Flit *f,
     int const available_vcs = (vcEnd - vcBegin + 1) / 2;
     assert(available_vcs > 0);
     
-    int out_port_xy = dor_next_mesh( r->GetID(), f->dest, false );
-    int out_port_yx = dor_next_mesh( r->GetID(), f->dest, true );
+    int out_port_xy = dor_next_mesh( r->GetID(), f->packet->dest, false );
+    int out_port_yx = dor_next_mesh( r->GetID(), f->packet->dest, true );
 
     // Route order (XY or YX) determined when packet is injected
     //  into the network, adaptively
@@ -477,16 +477,16 @@ void xy_yx_mesh( const Router *r, const Flit *f,
 		 int in_channel, OutputSet *outputs, bool inject )
 {
   int vcBegin = 0, vcEnd = gNumVCs-1;
-  if ( f->type == Flit::READ_REQUEST ) {
+  if ( f->packet->type == Flit::READ_REQUEST ) {
     vcBegin = gReadReqBeginVC;
     vcEnd = gReadReqEndVC;
-  } else if ( f->type == Flit::WRITE_REQUEST ) {
+  } else if ( f->packet->type == Flit::WRITE_REQUEST ) {
     vcBegin = gWriteReqBeginVC;
     vcEnd = gWriteReqEndVC;
-  } else if ( f->type ==  Flit::READ_REPLY ) {
+  } else if ( f->packet->type ==  Flit::READ_REPLY ) {
     vcBegin = gReadReplyBeginVC;
     vcEnd = gReadReplyEndVC;
-  } else if ( f->type ==  Flit::WRITE_REPLY ) {
+  } else if ( f->packet->type ==  Flit::WRITE_REPLY ) {
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
@@ -498,7 +498,7 @@ void xy_yx_mesh( const Router *r, const Flit *f,
 
     out_port = -1;
 
-  } else if(r->GetID() == f->dest) {
+  } else if(r->GetID() == f->packet->dest) {
 
     // at destination router, we don't need to separate VCs by dim order
     out_port = 2*gN;
@@ -516,10 +516,10 @@ void xy_yx_mesh( const Router *r, const Flit *f,
 		     (RandomInt(1) > 0));
 
     if(x_then_y) {
-      out_port = dor_next_mesh( r->GetID(), f->dest, false );
+      out_port = dor_next_mesh( r->GetID(), f->packet->dest, false );
       vcEnd -= available_vcs;
     } else {
-      out_port = dor_next_mesh( r->GetID(), f->dest, true );
+      out_port = dor_next_mesh( r->GetID(), f->packet->dest, true );
       vcBegin += available_vcs;
     }
 
@@ -642,19 +642,19 @@ void dor_next_torus( int cur, int dest, int in_port,
 
 void dim_order_mesh( const Router *r, const Flit *f, int in_channel, OutputSet *outputs, bool inject )
 {
-  int out_port = inject ? -1 : dor_next_mesh( r->GetID( ), f->dest );
+  int out_port = inject ? -1 : dor_next_mesh( r->GetID( ), f->packet->dest );
   
   int vcBegin = 0, vcEnd = gNumVCs-1;
-  if ( f->type == Flit::READ_REQUEST ) {
+  if ( f->packet->type == Flit::READ_REQUEST ) {
     vcBegin = gReadReqBeginVC;
     vcEnd = gReadReqEndVC;
-  } else if ( f->type == Flit::WRITE_REQUEST ) {
+  } else if ( f->packet->type == Flit::WRITE_REQUEST ) {
     vcBegin = gWriteReqBeginVC;
     vcEnd = gWriteReqEndVC;
-  } else if ( f->type ==  Flit::READ_REPLY ) {
+  } else if ( f->packet->type ==  Flit::READ_REPLY ) {
     vcBegin = gReadReplyBeginVC;
     vcEnd = gReadReplyEndVC;
-  } else if ( f->type ==  Flit::WRITE_REPLY ) {
+  } else if ( f->packet->type ==  Flit::WRITE_REPLY ) {
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
@@ -668,7 +668,7 @@ void dim_order_mesh( const Router *r, const Flit *f, int in_channel, OutputSet *
 	       << " at output port " << out_port
 	       << " for flit " << f->id
 	       << " (input port " << in_channel
-	       << ", destination " << f->dest << ")"
+	       << ", destination " << f->packet->dest << ")"
 	       << "." << endl;
   }
   
@@ -681,31 +681,31 @@ void dim_order_mesh( const Router *r, const Flit *f, int in_channel, OutputSet *
 
 void dim_order_ni_mesh( const Router *r, const Flit *f, int in_channel, OutputSet *outputs, bool inject )
 {
-  int out_port = inject ? -1 : dor_next_mesh( r->GetID( ), f->dest );
+  int out_port = inject ? -1 : dor_next_mesh( r->GetID( ), f->packet->dest );
   
   int vcBegin = 0, vcEnd = gNumVCs-1;
-  if ( f->type == Flit::READ_REQUEST ) {
+  if ( f->packet->type == Flit::READ_REQUEST ) {
     vcBegin = gReadReqBeginVC;
     vcEnd = gReadReqEndVC;
-  } else if ( f->type == Flit::WRITE_REQUEST ) {
+  } else if ( f->packet->type == Flit::WRITE_REQUEST ) {
     vcBegin = gWriteReqBeginVC;
     vcEnd = gWriteReqEndVC;
-  } else if ( f->type ==  Flit::READ_REPLY ) {
+  } else if ( f->packet->type ==  Flit::READ_REPLY ) {
     vcBegin = gReadReplyBeginVC;
     vcEnd = gReadReplyEndVC;
-  } else if ( f->type ==  Flit::WRITE_REPLY ) {
+  } else if ( f->packet->type ==  Flit::WRITE_REPLY ) {
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
   assert(((f->vc >= vcBegin) && (f->vc <= vcEnd)) || (inject && (f->vc < 0)));
 
   // at the destination router, we don't need to separate VCs by destination
-  if(inject || (r->GetID() != f->dest)) {
+  if(inject || (r->GetID() != f->packet->dest)) {
 
     int const vcs_per_dest = (vcEnd - vcBegin + 1) / gNodes;
     assert(vcs_per_dest > 0);
 
-    vcBegin += f->dest * vcs_per_dest;
+    vcBegin += f->packet->dest * vcs_per_dest;
     vcEnd = vcBegin + vcs_per_dest - 1;
 
   }
@@ -718,7 +718,7 @@ void dim_order_ni_mesh( const Router *r, const Flit *f, int in_channel, OutputSe
 	       << " at output port " << out_port
 	       << " for flit " << f->id
 	       << " (input port " << in_channel
-	       << ", destination " << f->dest << ")"
+	       << ", destination " << f->packet->dest << ")"
 	       << "." << endl;
   }
   
@@ -731,26 +731,26 @@ void dim_order_ni_mesh( const Router *r, const Flit *f, int in_channel, OutputSe
 
 void dim_order_pni_mesh( const Router *r, const Flit *f, int in_channel, OutputSet *outputs, bool inject )
 {
-  int out_port = inject ? -1 : dor_next_mesh( r->GetID(), f->dest );
+  int out_port = inject ? -1 : dor_next_mesh( r->GetID(), f->packet->dest );
   
   int vcBegin = 0, vcEnd = gNumVCs-1;
-  if ( f->type == Flit::READ_REQUEST ) {
+  if ( f->packet->type == Flit::READ_REQUEST ) {
     vcBegin = gReadReqBeginVC;
     vcEnd = gReadReqEndVC;
-  } else if ( f->type == Flit::WRITE_REQUEST ) {
+  } else if ( f->packet->type == Flit::WRITE_REQUEST ) {
     vcBegin = gWriteReqBeginVC;
     vcEnd = gWriteReqEndVC;
-  } else if ( f->type ==  Flit::READ_REPLY ) {
+  } else if ( f->packet->type ==  Flit::READ_REPLY ) {
     vcBegin = gReadReplyBeginVC;
     vcEnd = gReadReplyEndVC;
-  } else if ( f->type ==  Flit::WRITE_REPLY ) {
+  } else if ( f->packet->type ==  Flit::WRITE_REPLY ) {
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
   assert(((f->vc >= vcBegin) && (f->vc <= vcEnd)) || (inject && (f->vc < 0)));
 
-  if(inject || (r->GetID() != f->dest)) {
-    int next_coord = f->dest;
+  if(inject || (r->GetID() != f->packet->dest)) {
+    int next_coord = f->packet->dest;
     if(!inject) {
       int out_dim = out_port / 2;
       for(int d = 0; d < out_dim; ++d) {
@@ -773,7 +773,7 @@ void dim_order_pni_mesh( const Router *r, const Flit *f, int in_channel, OutputS
 	       << " at output port " << out_port
 	       << " for flit " << f->id
 	       << " (input port " << in_channel
-	       << ", destination " << f->dest << ")"
+	       << ", destination " << f->packet->dest << ")"
 	       << "." << endl;
   }
   
@@ -814,16 +814,16 @@ int rand_min_intr_mesh( int src, int dest )
 void romm_mesh( const Router *r, const Flit *f, int in_channel, OutputSet *outputs, bool inject )
 {
   int vcBegin = 0, vcEnd = gNumVCs-1;
-  if ( f->type == Flit::READ_REQUEST ) {
+  if ( f->packet->type == Flit::READ_REQUEST ) {
     vcBegin = gReadReqBeginVC;
     vcEnd = gReadReqEndVC;
-  } else if ( f->type == Flit::WRITE_REQUEST ) {
+  } else if ( f->packet->type == Flit::WRITE_REQUEST ) {
     vcBegin = gWriteReqBeginVC;
     vcEnd = gWriteReqEndVC;
-  } else if ( f->type ==  Flit::READ_REPLY ) {
+  } else if ( f->packet->type ==  Flit::READ_REPLY ) {
     vcBegin = gReadReplyBeginVC;
     vcEnd = gReadReplyEndVC;
-  } else if ( f->type ==  Flit::WRITE_REPLY ) {
+  } else if ( f->packet->type ==  Flit::WRITE_REPLY ) {
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
@@ -838,27 +838,27 @@ void romm_mesh( const Router *r, const Flit *f, int in_channel, OutputSet *outpu
   } else {
 
     if ( in_channel == 2*gN ) {
-      f->ph   = 0;  // Phase 0
-      f->intm = rand_min_intr_mesh( f->src, f->dest );
+      f->packet->ph   = 0;  // Phase 0
+      f->packet->intm = rand_min_intr_mesh( f->packet->src, f->packet->dest );
     } 
 
-    if ( ( f->ph == 0 ) && ( r->GetID( ) == f->intm ) ) {
-      f->ph = 1; // Go to phase 1
+    if ( ( f->packet->ph == 0 ) && ( r->GetID( ) == f->packet->intm ) ) {
+      f->packet->ph = 1; // Go to phase 1
     }
 
-    out_port = dor_next_mesh( r->GetID( ), (f->ph == 0) ? f->intm : f->dest );
+    out_port = dor_next_mesh( r->GetID( ), (f->packet->ph == 0) ? f->packet->intm : f->packet->dest );
 
     // at the destination router, we don't need to separate VCs by phase
-    if(r->GetID() != f->dest) {
+    if(r->GetID() != f->packet->dest) {
 
       //each class must have at least 2 vcs assigned or else valiant valiant will deadlock
       int available_vcs = (vcEnd - vcBegin + 1) / 2;
       assert(available_vcs > 0);
 
-      if(f->ph == 0) {
+      if(f->packet->ph == 0) {
 	vcEnd -= available_vcs;
       } else {
-	assert(f->ph == 1);
+	assert(f->packet->ph == 1);
 	vcBegin += available_vcs;
       }
     }
@@ -875,28 +875,28 @@ void romm_mesh( const Router *r, const Flit *f, int in_channel, OutputSet *outpu
 void romm_ni_mesh( const Router *r, const Flit *f, int in_channel, OutputSet *outputs, bool inject )
 {
   int vcBegin = 0, vcEnd = gNumVCs-1;
-  if ( f->type == Flit::READ_REQUEST ) {
+  if ( f->packet->type == Flit::READ_REQUEST ) {
     vcBegin = gReadReqBeginVC;
     vcEnd = gReadReqEndVC;
-  } else if ( f->type == Flit::WRITE_REQUEST ) {
+  } else if ( f->packet->type == Flit::WRITE_REQUEST ) {
     vcBegin = gWriteReqBeginVC;
     vcEnd = gWriteReqEndVC;
-  } else if ( f->type ==  Flit::READ_REPLY ) {
+  } else if ( f->packet->type ==  Flit::READ_REPLY ) {
     vcBegin = gReadReplyBeginVC;
     vcEnd = gReadReplyEndVC;
-  } else if ( f->type ==  Flit::WRITE_REPLY ) {
+  } else if ( f->packet->type ==  Flit::WRITE_REPLY ) {
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
   assert(((f->vc >= vcBegin) && (f->vc <= vcEnd)) || (inject && (f->vc < 0)));
 
   // at the destination router, we don't need to separate VCs by destination
-  if(inject || (r->GetID() != f->dest)) {
+  if(inject || (r->GetID() != f->packet->dest)) {
 
     int const vcs_per_dest = (vcEnd - vcBegin + 1) / gNodes;
     assert(vcs_per_dest > 0);
 
-    vcBegin += f->dest * vcs_per_dest;
+    vcBegin += f->packet->dest * vcs_per_dest;
     vcEnd = vcBegin + vcs_per_dest - 1;
 
   }
@@ -910,15 +910,15 @@ void romm_ni_mesh( const Router *r, const Flit *f, int in_channel, OutputSet *ou
   } else {
 
     if ( in_channel == 2*gN ) {
-      f->ph   = 0;  // Phase 0
-      f->intm = rand_min_intr_mesh( f->src, f->dest );
+      f->packet->ph   = 0;  // Phase 0
+      f->packet->intm = rand_min_intr_mesh( f->packet->src, f->packet->dest );
     } 
 
-    if ( ( f->ph == 0 ) && ( r->GetID( ) == f->intm ) ) {
-      f->ph = 1; // Go to phase 1
+    if ( ( f->packet->ph == 0 ) && ( r->GetID( ) == f->packet->intm ) ) {
+      f->packet->ph = 1; // Go to phase 1
     }
 
-    out_port = dor_next_mesh( r->GetID( ), (f->ph == 0) ? f->intm : f->dest );
+    out_port = dor_next_mesh( r->GetID( ), (f->packet->ph == 0) ? f->packet->intm : f->packet->dest );
 
   }
 
@@ -932,16 +932,16 @@ void romm_ni_mesh( const Router *r, const Flit *f, int in_channel, OutputSet *ou
 void min_adapt_mesh( const Router *r, const Flit *f, int in_channel, OutputSet *outputs, bool inject )
 {
   int vcBegin = 0, vcEnd = gNumVCs-1;
-  if ( f->type == Flit::READ_REQUEST ) {
+  if ( f->packet->type == Flit::READ_REQUEST ) {
     vcBegin = gReadReqBeginVC;
     vcEnd = gReadReqEndVC;
-  } else if ( f->type == Flit::WRITE_REQUEST ) {
+  } else if ( f->packet->type == Flit::WRITE_REQUEST ) {
     vcBegin = gWriteReqBeginVC;
     vcEnd = gWriteReqEndVC;
-  } else if ( f->type ==  Flit::READ_REPLY ) {
+  } else if ( f->packet->type ==  Flit::READ_REPLY ) {
     vcBegin = gReadReplyBeginVC;
     vcEnd = gReadReplyEndVC;
-  } else if ( f->type ==  Flit::WRITE_REPLY ) {
+  } else if ( f->packet->type ==  Flit::WRITE_REPLY ) {
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
@@ -953,7 +953,7 @@ void min_adapt_mesh( const Router *r, const Flit *f, int in_channel, OutputSet *
     // injection can use all VCs
     outputs->AddRange(-1, vcBegin, vcEnd);
     return;
-  } else if(r->GetID() == f->dest) {
+  } else if(r->GetID() == f->packet->dest) {
     // ejection can also use all VCs
     outputs->AddRange(2*gN, vcBegin, vcEnd);
     return;
@@ -968,7 +968,7 @@ void min_adapt_mesh( const Router *r, const Flit *f, int in_channel, OutputSet *
   }
   
   // DOR for the escape channel (VC 0), low priority 
-  int out_port = dor_next_mesh( r->GetID( ), f->dest );    
+  int out_port = dor_next_mesh( r->GetID( ), f->packet->dest );    
   outputs->AddRange( out_port, 0, vcBegin, vcBegin );
   
   if ( f->watch ) {
@@ -979,14 +979,14 @@ void min_adapt_mesh( const Router *r, const Flit *f, int in_channel, OutputSet *
 		  << " at output port " << out_port
 		  << " for flit " << f->id
 		  << " (input port " << in_channel
-		  << ", destination " << f->dest << ")"
+		  << ", destination " << f->packet->dest << ")"
 		  << "." << endl;
    }
   
   if ( in_vc != vcBegin ) { // If not in the escape VC
     // Minimal adaptive for all other channels
     int cur = r->GetID( );
-    int dest = f->dest;
+    int dest = f->packet->dest;
     
     for ( int n = 0; n < gN; ++n ) {
       if ( ( cur % gK ) != ( dest % gK ) ) { 
@@ -1001,7 +1001,7 @@ void min_adapt_mesh( const Router *r, const Flit *f, int in_channel, OutputSet *
 			<< " with priority " << 1
 			<< " for flit " << f->id
 			<< " (input port " << in_channel
-			<< ", destination " << f->dest << ")"
+			<< ", destination " << f->packet->dest << ")"
 			<< "." << endl;
 	  }
 	  outputs->AddRange( 2*n, vcBegin+1, vcEnd, 1 ); 
@@ -1015,7 +1015,7 @@ void min_adapt_mesh( const Router *r, const Flit *f, int in_channel, OutputSet *
 			<< " with priority " << 1
 			<< " for flit " << f->id
 			<< " (input port " << in_channel
-			<< ", destination " << f->dest << ")"
+			<< ", destination " << f->packet->dest << ")"
 			<< "." << endl;
 	  }
 	  outputs->AddRange( 2*n + 1, vcBegin+1, vcEnd, 1 ); 
@@ -1032,16 +1032,16 @@ void min_adapt_mesh( const Router *r, const Flit *f, int in_channel, OutputSet *
 void planar_adapt_mesh( const Router *r, const Flit *f, int in_channel, OutputSet *outputs, bool inject )
 {
   int vcBegin = 0, vcEnd = gNumVCs-1;
-  if ( f->type == Flit::READ_REQUEST ) {
+  if ( f->packet->type == Flit::READ_REQUEST ) {
     vcBegin = gReadReqBeginVC;
     vcEnd = gReadReqEndVC;
-  } else if ( f->type == Flit::WRITE_REQUEST ) {
+  } else if ( f->packet->type == Flit::WRITE_REQUEST ) {
     vcBegin = gWriteReqBeginVC;
     vcEnd = gWriteReqEndVC;
-  } else if ( f->type ==  Flit::READ_REPLY ) {
+  } else if ( f->packet->type ==  Flit::READ_REPLY ) {
     vcBegin = gReadReplyBeginVC;
     vcEnd = gReadReplyEndVC;
-  } else if ( f->type ==  Flit::WRITE_REPLY ) {
+  } else if ( f->packet->type ==  Flit::WRITE_REPLY ) {
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
@@ -1056,7 +1056,7 @@ void planar_adapt_mesh( const Router *r, const Flit *f, int in_channel, OutputSe
   }
 
   int cur     = r->GetID( ); 
-  int dest    = f->dest;
+  int dest    = f->packet->dest;
 
   if ( cur != dest ) {
    
@@ -1201,7 +1201,7 @@ void planar_adapt_mesh( const Router *r, const Flit *f, int in_channel, OutputSe
 //=============================================================
 /*
   FIXME: This is broken (note that f->dr is never actually modified).
-  Even if it were, this should really use f->ph instead of introducing a single-
+  Even if it were, this should really use f->packet->ph instead of introducing a single-
   use field.
 
 void limited_adapt_mesh( const Router *r, const Flit *f, int in_channel, OutputSet *outputs, bool inject )
@@ -1209,16 +1209,16 @@ void limited_adapt_mesh( const Router *r, const Flit *f, int in_channel, OutputS
   outputs->Clear( );
 
   int vcBegin = 0, vcEnd = gNumVCs-1;
-  if ( f->type == Flit::READ_REQUEST ) {
+  if ( f->packet->type == Flit::READ_REQUEST ) {
     vcBegin = gReadReqBeginVC;
     vcEnd = gReadReqEndVC;
-  } else if ( f->type == Flit::WRITE_REQUEST ) {
+  } else if ( f->packet->type == Flit::WRITE_REQUEST ) {
     vcBegin = gWriteReqBeginVC;
     vcEnd = gWriteReqEndVC;
-  } else if ( f->type ==  Flit::READ_REPLY ) {
+  } else if ( f->packet->type ==  Flit::READ_REPLY ) {
     vcBegin = gReadReplyBeginVC;
     vcEnd = gReadReplyEndVC;
-  } else if ( f->type ==  Flit::WRITE_REPLY ) {
+  } else if ( f->packet->type ==  Flit::WRITE_REPLY ) {
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
@@ -1231,7 +1231,7 @@ void limited_adapt_mesh( const Router *r, const Flit *f, int in_channel, OutputS
   }
 
   int cur = r->GetID( );
-  int dest = f->dest;
+  int dest = f->packet->dest;
   
   if ( cur != dest ) {
     if ( ( f->vc != vcEnd ) && 
@@ -1276,16 +1276,16 @@ void limited_adapt_mesh( const Router *r, const Flit *f, int in_channel, OutputS
 void valiant_mesh( const Router *r, const Flit *f, int in_channel, OutputSet *outputs, bool inject )
 {
   int vcBegin = 0, vcEnd = gNumVCs-1;
-  if ( f->type == Flit::READ_REQUEST ) {
+  if ( f->packet->type == Flit::READ_REQUEST ) {
     vcBegin = gReadReqBeginVC;
     vcEnd = gReadReqEndVC;
-  } else if ( f->type == Flit::WRITE_REQUEST ) {
+  } else if ( f->packet->type == Flit::WRITE_REQUEST ) {
     vcBegin = gWriteReqBeginVC;
     vcEnd = gWriteReqEndVC;
-  } else if ( f->type ==  Flit::READ_REPLY ) {
+  } else if ( f->packet->type ==  Flit::READ_REPLY ) {
     vcBegin = gReadReplyBeginVC;
     vcEnd = gReadReplyEndVC;
-  } else if ( f->type ==  Flit::WRITE_REPLY ) {
+  } else if ( f->packet->type ==  Flit::WRITE_REPLY ) {
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
@@ -1300,27 +1300,27 @@ void valiant_mesh( const Router *r, const Flit *f, int in_channel, OutputSet *ou
   } else {
 
     if ( in_channel == 2*gN ) {
-      f->ph   = 0;  // Phase 0
-      f->intm = RandomInt( gNodes - 1 );
+      f->packet->ph   = 0;  // Phase 0
+      f->packet->intm = RandomInt( gNodes - 1 );
     }
 
-    if ( ( f->ph == 0 ) && ( r->GetID( ) == f->intm ) ) {
-      f->ph = 1; // Go to phase 1
+    if ( ( f->packet->ph == 0 ) && ( r->GetID( ) == f->packet->intm ) ) {
+      f->packet->ph = 1; // Go to phase 1
     }
 
-    out_port = dor_next_mesh( r->GetID( ), (f->ph == 0) ? f->intm : f->dest );
+    out_port = dor_next_mesh( r->GetID( ), (f->packet->ph == 0) ? f->packet->intm : f->packet->dest );
 
     // at the destination router, we don't need to separate VCs by phase
-    if(r->GetID() != f->dest) {
+    if(r->GetID() != f->packet->dest) {
 
       //each class must have at least 2 vcs assigned or else valiant valiant will deadlock
       int const available_vcs = (vcEnd - vcBegin + 1) / 2;
       assert(available_vcs > 0);
 
-      if(f->ph == 0) {
+      if(f->packet->ph == 0) {
 	vcEnd -= available_vcs;
       } else {
-	assert(f->ph == 1);
+	assert(f->packet->ph == 1);
 	vcBegin += available_vcs;
       }
     }
@@ -1337,16 +1337,16 @@ void valiant_mesh( const Router *r, const Flit *f, int in_channel, OutputSet *ou
 void valiant_torus( const Router *r, const Flit *f, int in_channel, OutputSet *outputs, bool inject )
 {
   int vcBegin = 0, vcEnd = gNumVCs-1;
-  if ( f->type == Flit::READ_REQUEST ) {
+  if ( f->packet->type == Flit::READ_REQUEST ) {
     vcBegin = gReadReqBeginVC;
     vcEnd = gReadReqEndVC;
-  } else if ( f->type == Flit::WRITE_REQUEST ) {
+  } else if ( f->packet->type == Flit::WRITE_REQUEST ) {
     vcBegin = gWriteReqBeginVC;
     vcEnd = gWriteReqEndVC;
-  } else if ( f->type ==  Flit::READ_REPLY ) {
+  } else if ( f->packet->type ==  Flit::READ_REPLY ) {
     vcBegin = gReadReplyBeginVC;
     vcEnd = gReadReplyEndVC;
-  } else if ( f->type ==  Flit::WRITE_REPLY ) {
+  } else if ( f->packet->type ==  Flit::WRITE_REPLY ) {
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
@@ -1363,24 +1363,24 @@ void valiant_torus( const Router *r, const Flit *f, int in_channel, OutputSet *o
     int phase;
     if ( in_channel == 2*gN ) {
       phase   = 0;  // Phase 0
-      f->intm = RandomInt( gNodes - 1 );
+      f->packet->intm = RandomInt( gNodes - 1 );
     } else {
-      phase = f->ph / 2;
+      phase = f->packet->ph / 2;
     }
 
-    if ( ( phase == 0 ) && ( r->GetID( ) == f->intm ) ) {
+    if ( ( phase == 0 ) && ( r->GetID( ) == f->packet->intm ) ) {
       phase = 1; // Go to phase 1
       in_channel = 2*gN; // ensures correct vc selection at the beginning of phase 2
     }
   
     int ring_part;
-    dor_next_torus( r->GetID( ), (phase == 0) ? f->intm : f->dest, in_channel,
+    dor_next_torus( r->GetID( ), (phase == 0) ? f->packet->intm : f->packet->dest, in_channel,
 		    &out_port, &ring_part, false );
 
-    f->ph = 2 * phase + ring_part;
+    f->packet->ph = 2 * phase + ring_part;
 
     // at the destination router, we don't need to separate VCs by phase, etc.
-    if(r->GetID() != f->dest) {
+    if(r->GetID() != f->packet->dest) {
 
       int const ring_available_vcs = (vcEnd - vcBegin + 1) / 2;
       assert(ring_available_vcs > 0);
@@ -1416,28 +1416,28 @@ void valiant_ni_torus( const Router *r, const Flit *f, int in_channel,
 		       OutputSet *outputs, bool inject )
 {
   int vcBegin = 0, vcEnd = gNumVCs-1;
-  if ( f->type == Flit::READ_REQUEST ) {
+  if ( f->packet->type == Flit::READ_REQUEST ) {
     vcBegin = gReadReqBeginVC;
     vcEnd = gReadReqEndVC;
-  } else if ( f->type == Flit::WRITE_REQUEST ) {
+  } else if ( f->packet->type == Flit::WRITE_REQUEST ) {
     vcBegin = gWriteReqBeginVC;
     vcEnd = gWriteReqEndVC;
-  } else if ( f->type ==  Flit::READ_REPLY ) {
+  } else if ( f->packet->type ==  Flit::READ_REPLY ) {
     vcBegin = gReadReplyBeginVC;
     vcEnd = gReadReplyEndVC;
-  } else if ( f->type ==  Flit::WRITE_REPLY ) {
+  } else if ( f->packet->type ==  Flit::WRITE_REPLY ) {
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
   assert(((f->vc >= vcBegin) && (f->vc <= vcEnd)) || (inject && (f->vc < 0)));
 
   // at the destination router, we don't need to separate VCs by destination
-  if(inject || (r->GetID() != f->dest)) {
+  if(inject || (r->GetID() != f->packet->dest)) {
 
     int const vcs_per_dest = (vcEnd - vcBegin + 1) / gNodes;
     assert(vcs_per_dest > 0);
 
-    vcBegin += f->dest * vcs_per_dest;
+    vcBegin += f->packet->dest * vcs_per_dest;
     vcEnd = vcBegin + vcs_per_dest - 1;
 
   }
@@ -1453,24 +1453,24 @@ void valiant_ni_torus( const Router *r, const Flit *f, int in_channel,
     int phase;
     if ( in_channel == 2*gN ) {
       phase   = 0;  // Phase 0
-      f->intm = RandomInt( gNodes - 1 );
+      f->packet->intm = RandomInt( gNodes - 1 );
     } else {
-      phase = f->ph / 2;
+      phase = f->packet->ph / 2;
     }
 
-    if ( ( f->ph == 0 ) && ( r->GetID( ) == f->intm ) ) {
-      f->ph = 1; // Go to phase 1
+    if ( ( f->packet->ph == 0 ) && ( r->GetID( ) == f->packet->intm ) ) {
+      f->packet->ph = 1; // Go to phase 1
       in_channel = 2*gN; // ensures correct vc selection at the beginning of phase 2
     }
   
     int ring_part;
-    dor_next_torus( r->GetID( ), (f->ph == 0) ? f->intm : f->dest, in_channel,
+    dor_next_torus( r->GetID( ), (f->packet->ph == 0) ? f->packet->intm : f->packet->dest, in_channel,
 		    &out_port, &ring_part, false );
 
-    f->ph = 2 * phase + ring_part;
+    f->packet->ph = 2 * phase + ring_part;
 
     // at the destination router, we don't need to separate VCs by phase, etc.
-    if(r->GetID() != f->dest) {
+    if(r->GetID() != f->packet->dest) {
 
       int const ring_available_vcs = (vcEnd - vcBegin + 1) / 2;
       assert(ring_available_vcs > 0);
@@ -1501,7 +1501,7 @@ void valiant_ni_torus( const Router *r, const Flit *f, int in_channel,
 		 << " at output port " << out_port
 		 << " for flit " << f->id
 		 << " (input port " << in_channel
-		 << ", destination " << f->dest << ")"
+		 << ", destination " << f->packet->dest << ")"
 		 << "." << endl;
     }
 
@@ -1518,16 +1518,16 @@ void dim_order_torus( const Router *r, const Flit *f, int in_channel,
 		      OutputSet *outputs, bool inject )
 {
   int vcBegin = 0, vcEnd = gNumVCs-1;
-  if ( f->type == Flit::READ_REQUEST ) {
+  if ( f->packet->type == Flit::READ_REQUEST ) {
     vcBegin = gReadReqBeginVC;
     vcEnd = gReadReqEndVC;
-  } else if ( f->type == Flit::WRITE_REQUEST ) {
+  } else if ( f->packet->type == Flit::WRITE_REQUEST ) {
     vcBegin = gWriteReqBeginVC;
     vcEnd = gWriteReqEndVC;
-  } else if ( f->type ==  Flit::READ_REPLY ) {
+  } else if ( f->packet->type ==  Flit::READ_REPLY ) {
     vcBegin = gReadReplyBeginVC;
     vcEnd = gReadReplyEndVC;
-  } else if ( f->type ==  Flit::WRITE_REPLY ) {
+  } else if ( f->packet->type ==  Flit::WRITE_REPLY ) {
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
@@ -1542,10 +1542,10 @@ void dim_order_torus( const Router *r, const Flit *f, int in_channel,
   } else {
     
     int cur  = r->GetID( );
-    int dest = f->dest;
+    int dest = f->packet->dest;
 
     dor_next_torus( cur, dest, in_channel,
-		    &out_port, &f->ph, false );
+		    &out_port, &f->packet->ph, false );
 
 
     // at the destination router, we don't need to separate VCs by ring partition
@@ -1554,7 +1554,7 @@ void dim_order_torus( const Router *r, const Flit *f, int in_channel,
       int const available_vcs = (vcEnd - vcBegin + 1) / 2;
       assert(available_vcs > 0);
 
-      if ( f->ph == 0 ) {
+      if ( f->packet->ph == 0 ) {
 	vcEnd -= available_vcs;
       } else {
 	vcBegin += available_vcs;
@@ -1569,7 +1569,7 @@ void dim_order_torus( const Router *r, const Flit *f, int in_channel,
 		 << " at output port " << out_port
 		 << " for flit " << f->id
 		 << " (input port " << in_channel
-		 << ", destination " << f->dest << ")"
+		 << ", destination " << f->packet->dest << ")"
 		 << "." << endl;
     }
 
@@ -1586,16 +1586,16 @@ void dim_order_ni_torus( const Router *r, const Flit *f, int in_channel,
 			 OutputSet *outputs, bool inject )
 {
   int vcBegin = 0, vcEnd = gNumVCs-1;
-  if ( f->type == Flit::READ_REQUEST ) {
+  if ( f->packet->type == Flit::READ_REQUEST ) {
     vcBegin = gReadReqBeginVC;
     vcEnd = gReadReqEndVC;
-  } else if ( f->type == Flit::WRITE_REQUEST ) {
+  } else if ( f->packet->type == Flit::WRITE_REQUEST ) {
     vcBegin = gWriteReqBeginVC;
     vcEnd = gWriteReqEndVC;
-  } else if ( f->type ==  Flit::READ_REPLY ) {
+  } else if ( f->packet->type ==  Flit::READ_REPLY ) {
     vcBegin = gReadReplyBeginVC;
     vcEnd = gReadReplyEndVC;
-  } else if ( f->type ==  Flit::WRITE_REPLY ) {
+  } else if ( f->packet->type ==  Flit::WRITE_REPLY ) {
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
@@ -1610,7 +1610,7 @@ void dim_order_ni_torus( const Router *r, const Flit *f, int in_channel,
   } else {
     
     int cur  = r->GetID( );
-    int dest = f->dest;
+    int dest = f->packet->dest;
 
     dor_next_torus( cur, dest, in_channel,
 		    &out_port, NULL, false );
@@ -1621,7 +1621,7 @@ void dim_order_ni_torus( const Router *r, const Flit *f, int in_channel,
       int const vcs_per_dest = (vcEnd - vcBegin + 1) / gNodes;
       assert(vcs_per_dest);
 
-      vcBegin += f->dest * vcs_per_dest;
+      vcBegin += f->packet->dest * vcs_per_dest;
       vcEnd = vcBegin + vcs_per_dest - 1;
 
     }
@@ -1634,7 +1634,7 @@ void dim_order_ni_torus( const Router *r, const Flit *f, int in_channel,
 		 << " at output port " << out_port
 		 << " for flit " << f->id
 		 << " (input port " << in_channel
-		 << ", destination " << f->dest << ")"
+		 << ", destination " << f->packet->dest << ")"
 		 << "." << endl;
     }
 
@@ -1651,16 +1651,16 @@ void dim_order_bal_torus( const Router *r, const Flit *f, int in_channel,
 			  OutputSet *outputs, bool inject )
 {
   int vcBegin = 0, vcEnd = gNumVCs-1;
-  if ( f->type == Flit::READ_REQUEST ) {
+  if ( f->packet->type == Flit::READ_REQUEST ) {
     vcBegin = gReadReqBeginVC;
     vcEnd = gReadReqEndVC;
-  } else if ( f->type == Flit::WRITE_REQUEST ) {
+  } else if ( f->packet->type == Flit::WRITE_REQUEST ) {
     vcBegin = gWriteReqBeginVC;
     vcEnd = gWriteReqEndVC;
-  } else if ( f->type ==  Flit::READ_REPLY ) {
+  } else if ( f->packet->type ==  Flit::READ_REPLY ) {
     vcBegin = gReadReplyBeginVC;
     vcEnd = gReadReplyEndVC;
-  } else if ( f->type ==  Flit::WRITE_REPLY ) {
+  } else if ( f->packet->type ==  Flit::WRITE_REPLY ) {
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
@@ -1675,10 +1675,10 @@ void dim_order_bal_torus( const Router *r, const Flit *f, int in_channel,
   } else {
 
     int cur  = r->GetID( );
-    int dest = f->dest;
+    int dest = f->packet->dest;
 
     dor_next_torus( cur, dest, in_channel,
-		    &out_port, &f->ph, true );
+		    &out_port, &f->packet->ph, true );
 
     // at the destination router, we don't need to separate VCs by ring partition
     if(cur != dest) {
@@ -1686,10 +1686,10 @@ void dim_order_bal_torus( const Router *r, const Flit *f, int in_channel,
       int const available_vcs = (vcEnd - vcBegin + 1) / 2;
       assert(available_vcs > 0);
 
-      if ( f->ph == 0 ) {
+      if ( f->packet->ph == 0 ) {
 	vcEnd -= available_vcs;
       } else {
-	assert(f->ph == 1);
+	assert(f->packet->ph == 1);
 	vcBegin += available_vcs;
       } 
     }
@@ -1702,7 +1702,7 @@ void dim_order_bal_torus( const Router *r, const Flit *f, int in_channel,
 		 << " at output port " << out_port
 		 << " for flit " << f->id
 		 << " (input port " << in_channel
-		 << ", destination " << f->dest << ")"
+		 << ", destination " << f->packet->dest << ")"
 		 << "." << endl;
     }
 
@@ -1718,16 +1718,16 @@ void dim_order_bal_torus( const Router *r, const Flit *f, int in_channel,
 void min_adapt_torus( const Router *r, const Flit *f, int in_channel, OutputSet *outputs, bool inject )
 {
   int vcBegin = 0, vcEnd = gNumVCs-1;
-  if ( f->type == Flit::READ_REQUEST ) {
+  if ( f->packet->type == Flit::READ_REQUEST ) {
     vcBegin = gReadReqBeginVC;
     vcEnd = gReadReqEndVC;
-  } else if ( f->type == Flit::WRITE_REQUEST ) {
+  } else if ( f->packet->type == Flit::WRITE_REQUEST ) {
     vcBegin = gWriteReqBeginVC;
     vcEnd = gWriteReqEndVC;
-  } else if ( f->type ==  Flit::READ_REPLY ) {
+  } else if ( f->packet->type ==  Flit::READ_REPLY ) {
     vcBegin = gReadReplyBeginVC;
     vcEnd = gReadReplyEndVC;
-  } else if ( f->type ==  Flit::WRITE_REPLY ) {
+  } else if ( f->packet->type ==  Flit::WRITE_REPLY ) {
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
@@ -1739,7 +1739,7 @@ void min_adapt_torus( const Router *r, const Flit *f, int in_channel, OutputSet
     // injection can use all VCs
     outputs->AddRange(-1, vcBegin, vcEnd);
     return;
-  } else if(r->GetID() == f->dest) {
+  } else if(r->GetID() == f->packet->dest) {
     // ejection can also use all VCs
     outputs->AddRange(2*gN, vcBegin, vcEnd);
   }
@@ -1752,7 +1752,7 @@ void min_adapt_torus( const Router *r, const Flit *f, int in_channel, OutputSet
   }
   
   int cur = r->GetID( );
-  int dest = f->dest;
+  int dest = f->packet->dest;
 
   int out_port;
 
@@ -1778,15 +1778,15 @@ void min_adapt_torus( const Router *r, const Flit *f, int in_channel, OutputSet
     // DOR for the escape channel (VCs 0-1), low priority --- 
     // trick the algorithm with the in channel.  want VC assignment
     // as if we had injected at this node
-    dor_next_torus( r->GetID( ), f->dest, 2*gN,
-		    &out_port, &f->ph, false );
+    dor_next_torus( r->GetID( ), f->packet->dest, 2*gN,
+		    &out_port, &f->packet->ph, false );
   } else {
     // DOR for the escape channel (VCs 0-1), low priority 
     dor_next_torus( cur, dest, in_channel,
-		    &out_port, &f->ph, false );
+		    &out_port, &f->packet->ph, false );
   }
 
-  if ( f->ph == 0 ) {
+  if ( f->packet->ph == 0 ) {
     outputs->AddRange( out_port, vcBegin, vcBegin, 0 );
   } else  {
     outputs->AddRange( out_port, vcBegin+1, vcBegin+1, 0 );
@@ -1799,16 +1799,16 @@ void dest_tag_fly( const Router *r, const Flit *f, int in_channel,
 		   OutputSet *outputs, bool inject )
 {
   int vcBegin = 0, vcEnd = gNumVCs-1;
-  if ( f->type == Flit::READ_REQUEST ) {
+  if ( f->packet->type == Flit::READ_REQUEST ) {
     vcBegin = gReadReqBeginVC;
     vcEnd = gReadReqEndVC;
-  } else if ( f->type == Flit::WRITE_REQUEST ) {
+  } else if ( f->packet->type == Flit::WRITE_REQUEST ) {
     vcBegin = gWriteReqBeginVC;
     vcEnd = gWriteReqEndVC;
-  } else if ( f->type ==  Flit::READ_REPLY ) {
+  } else if ( f->packet->type ==  Flit::READ_REPLY ) {
     vcBegin = gReadReplyBeginVC;
     vcEnd = gReadReplyEndVC;
-  } else if ( f->type ==  Flit::WRITE_REPLY ) {
+  } else if ( f->packet->type ==  Flit::WRITE_REPLY ) {
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
@@ -1823,7 +1823,7 @@ void dest_tag_fly( const Router *r, const Flit *f, int in_channel,
   } else {
 
     int stage = ( r->GetID( ) * gK ) / gNodes;
-    int dest  = f->dest;
+    int dest  = f->packet->dest;
 
     while( stage < ( gN - 1 ) ) {
       dest /= gK;
@@ -1853,7 +1853,7 @@ void chaos_torus( const Router *r, const Flit *f,
   }
 
   int cur = r->GetID( );
-  int dest = f->dest;
+  int dest = f->packet->dest;
   
   if ( cur != dest ) {
     for ( int n = 0; n < gN; ++n ) {
@@ -1892,7 +1892,7 @@ void chaos_mesh( const Router *r, const Flit *f,
   }
 
   int cur = r->GetID( );
-  int dest = f->dest;
+  int dest = f->packet->dest;
   
   if ( cur != dest ) {
     for ( int n = 0; n < gN; ++n ) {
@@ -1915,16 +1915,16 @@ void chaos_mesh( const Router *r, const Flit *f,
 // =================odd-even routing==============================
 void oddeven_mesh(const Router *r, const Flit *f, int in_channel, OutputSet *outputs, bool inject) {
     int vcBegin = 0, vcEnd = gNumVCs-1;
-    if ( f->type == Flit::READ_REQUEST ) {
+    if ( f->packet->type == Flit::READ_REQUEST ) {
         vcBegin = gReadReqBeginVC;
         vcEnd = gReadReqEndVC;
-    } else if ( f->type == Flit::WRITE_REQUEST ) {
+    } else if ( f->packet->type == Flit::WRITE_REQUEST ) {
         vcBegin = gWriteReqBeginVC;
         vcEnd = gWriteReqEndVC;
-    } else if ( f->type ==  Flit::READ_REPLY ) {
+    } else if ( f->packet->type ==  Flit::READ_REPLY ) {
         vcBegin = gReadReplyBeginVC;
         vcEnd = gReadReplyEndVC;
-    } else if ( f->type ==  Flit::WRITE_REPLY ) {
+    } else if ( f->packet->type ==  Flit::WRITE_REPLY ) {
         vcBegin = gWriteReplyBeginVC;
         vcEnd = gWriteReplyEndVC;
     }
@@ -1936,7 +1936,7 @@ void oddeven_mesh(const Router *r, const Flit *f, int in_channel, OutputSet *out
         // injection can use all VCs
         outputs->AddRange(-1, vcBegin, vcEnd);
         return;
-    } else if(r->GetID() == f->dest) {
+    } else if(r->GetID() == f->packet->dest) {
         // ejection can also use all VCs
         outputs->AddRange(2*gN, vcBegin, vcEnd);
         return;
@@ -1951,7 +1951,7 @@ void oddeven_mesh(const Router *r, const Flit *f, int in_channel, OutputSet *out
     }
 
     // DOR for the escape channel (VC 0), low priority
-    int out_port = dor_next_mesh( r->GetID( ), f->dest );
+    int out_port = dor_next_mesh( r->GetID( ), f->packet->dest );
     outputs->AddRange( out_port, 0, vcBegin, vcBegin );
 
     if ( f->watch ) {
@@ -1962,14 +1962,14 @@ void oddeven_mesh(const Router *r, const Flit *f, int in_channel, OutputSet *out
                    << " at output port " << out_port
                    << " for flit " << f->id
                    << " (input port " << in_channel
-                   << ", destination " << f->dest << ")"
+                   << ", destination " << f->packet->dest << ")"
                    << "." << endl;
     }
 
     if ( in_vc != vcBegin ) { // If not in the escape VC
         // Minimal adaptive for all other channels
         int cur = r->GetID( );
-        int dest = f->dest;
+        int dest = f->packet->dest;
         int cur_col = cur % gK;
         int dest_col = dest % gK;
         int cur_row = cur / gK;
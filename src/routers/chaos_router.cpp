@@ -581,7 +581,7 @@ void ChaosRouter::_OutputAdvance( )
 	}
 	
 	c = Credit::New( );
-	c->vc.insert(0);
+	c->vc.Insert(0);
 	_credit_queue[i].push( c );
       }
     }
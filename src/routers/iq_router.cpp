@@ -34,6 +34,7 @@
 #include <cstdlib>
 #include <cassert>
 #include <limits>
+#include <cmath>
 
 #include "globals.hpp"
 #include "random_utils.hpp"
@@ -44,9 +45,73 @@
 #include "buffer_state.hpp"
 #include "roundrobin_arb.hpp"
 #include "allocator.hpp"
+#include "islip.hpp"
 #include "switch_monitor.hpp"
 #include "buffer_monitor.hpp"
 #include "trafficmanager.hpp"
+#include "checkpoint.hpp"
+
+// Compile-time description of the router pipeline. Features that are off 
+// here are compiled out of the per-cycle code; features that are on are 
+// still checked against the configuration. Allocators are called through 
+// the given types, which lets calls into final classes be bound statically.
+template<bool S, bool H, bool N, bool W, bool U, class VA, class SA>
+struct IQRouterTraits {
+  static bool const speculative = S;
+  static bool const hold_switch = H;
+  static bool const noq = N;
+  static bool const watch = W;
+  static bool const unit_speedup = U;
+  typedef VA tVCAlloc;
+  typedef SA tSWAlloc;
+};
+
+typedef IQRouterTraits<true, true, true, true, false, Allocator, Allocator> tGenericTraits;
+typedef IQRouterTraits<false, false, false, false, true, Allocator, Allocator> tBasicTraits;
+typedef IQRouterTraits<true, false, false, false, true, Allocator, Allocator> tSpecTraits;
+typedef IQRouterTraits<false, false, false, false, true, iSLIP_Sparse, iSLIP_Sparse> tISLIPTraits;
+
+template<class T>
+class IQRouterVariant : public IQRouter {
+
+  virtual void _InternalStep( int subnet, TrafficManager * trafficmanager )
+  {
+    _PipelineStep<T>(subnet, trafficmanager);
+  }
+
+public:
+
+  IQRouterVariant( Configuration const & config, Module *parent, 
+		   string const & name, int id, int inputs, int outputs )
+    : IQRouter( config, parent, name, id, inputs, outputs ) {}
+};
+
+IQRouter * IQRouter::New( Configuration const & config, Module *parent, 
+			  string const & name, int id, int inputs, int outputs )
+{
+  // watched flits, switch holding, NOQ and switch speedup are only handled 
+  // by the generic pipeline (flits are never watched without a watch_out)
+  if(gWatchOut ||
+     (config.GetInt("hold_switch_for_packet") > 0) ||
+     (config.GetInt("noq") > 0) ||
+     (config.GetInt("input_speedup") != 1) ||
+     (config.GetInt("output_speedup") != 1)) {
+    return new IQRouter( config, parent, name, id, inputs, outputs );
+  }
+  if(config.GetInt("speculative") > 0) {
+    return new IQRouterVariant<tSpecTraits>( config, parent, name, id, 
+					     inputs, outputs );
+  }
+  string const vc_alloc_type = config.GetStr("vc_allocator");
+  string const sw_alloc_type = config.GetStr("sw_allocator");
+  if((vc_alloc_type.substr(0, vc_alloc_type.find('(')) == "islip") &&
+     (sw_alloc_type.substr(0, sw_alloc_type.find('(')) == "islip")) {
+    return new IQRouterVariant<tISLIPTraits>( config, parent, name, id, 
+					      inputs, outputs );
+  }
+  return new IQRouterVariant<tBasicTraits>( config, parent, name, id, 
+					    inputs, outputs );
+}
 
 IQRouter::IQRouter( Configuration const & config, Module *parent, 
 		    string const & name, int id, int inputs, int outputs )
@@ -81,6 +146,10 @@ IQRouter::IQRouter( Configuration const & config, Module *parent,
   }
   _rf = rf_iter->second;
 
+  _in_queue_flits.resize(_inputs, NULL);
+  _out_queue_credits.resize(_inputs, NULL);
+  _vc_alloc_matched.resize(_outputs, 0);
+
   // Alloc VC's
   _buf.resize(_inputs);
   for ( int i = 0; i < _inputs; ++i ) {//为每个input信道创建buffer，在buffer中创建vc。注意这里的input信道包含了inject信道，但并不包括credit信道
@@ -163,6 +232,27 @@ IQRouter::IQRouter( Configuration const & config, Module *parent,
   _output_buffer.resize(_outputs); 
   _credit_buffer.resize(_inputs); 
 
+  // Size the pipeline queues for the most entries they can hold, so that 
+  // they never grow once the simulation is running: every input VC sits 
+  // at most once in each per-VC stage (plus the one being requeued), each 
+  // expanded output takes at most one flit per cycle into the crossbar, 
+  // and credits wait for at most _credit_delay cycles.
+  _proc_credits.Reserve(_outputs * (_credit_delay + 2));
+  _route_vcs.Reserve(_inputs * _vcs + 1);
+  _vc_alloc_vcs.Reserve(_inputs * _vcs + 1);
+  _sw_hold_vcs.Reserve(_inputs * _vcs + 1);
+  _sw_alloc_vcs.Reserve(_inputs * _vcs + 1);
+  _crossbar_flits.Reserve(_outputs * _output_speedup * (_crossbar_delay + 1));
+  // an output buffer drains one flit per cycle and, unless it is limited 
+  // by output_buffer_size, only grows while a speedup outpaces it
+  for(int j = 0; j < _outputs; ++j) {
+    _output_buffer[j].Reserve(max(_output_buffer_size, 0) + 
+			      _output_speedup * (_crossbar_delay + 1));
+  }
+  for(int i = 0; i < _inputs; ++i) {
+    _credit_buffer[i].Reserve((int)ceil(_internal_speedup) + 1);
+  }
+
   // Switch configuration (when held for multiple cycles)
   _hold_switch_for_packet = (config.GetInt("hold_switch_for_packet") > 0);
   _switch_hold_in.resize(_inputs*_input_speedup, -1);
@@ -231,6 +321,18 @@ void IQRouter::ReadInputs( )
 //vc初始状态为idle，在_InputQueuing中有flit进来后状态变为VC::Routing；经过_RouteUpdate完成RC后，状态变为VC::Alloc；执行_VCAllocUpdate后，状态变为active；在_SWAllocUpdate中，如果flit离开后vc buffer为空，并且离开的是tail flit，将vc状态变为idle，否则保持active；_SwitchUpdate不改变vc状态。
 void IQRouter::_InternalStep( int subnet, TrafficManager * trafficmanager)
 {
+  _PipelineStep<tGenericTraits>(subnet, trafficmanager);
+}
+
+template<class T>
+void IQRouter::_PipelineStep( int subnet, TrafficManager * trafficmanager)
+{
+  bool const hold_switch = T::hold_switch && _hold_switch_for_packet;
+  typename T::tVCAlloc * const vc_allocator
+    = static_cast<typename T::tVCAlloc *>(_vc_allocator);
+  typename T::tSWAlloc * const sw_allocator
+    = static_cast<typename T::tSWAlloc *>(_sw_allocator);
+
   if(!_active) {
 //非active路由器的输入端口状态转变(不包括inject端口的dest_buf)
       for (int output = 0; output < _outputs - 1; ++output) {
@@ -239,48 +341,48 @@ void IQRouter::_InternalStep( int subnet, TrafficManager * trafficmanager)
     return;
   }
 
-  _InputQueuing(subnet, trafficmanager);//初始化_route_vcs
+  _InputQueuing<T>(subnet, trafficmanager);//初始化_route_vcs
   bool activity = !_proc_credits.empty();
 
   if(!_route_vcs.empty())
-    _RouteEvaluate( );//修改_route_vcs
-  if(_vc_allocator) {
-    _vc_allocator->Clear();//清除_in_req _out_req _in_occ _out_occ和_in_match _out_match
+    _RouteEvaluate<T>( );//修改_route_vcs
+  if(vc_allocator) {
+    vc_allocator->Clear();//清除_in_req _out_req _in_occ _out_occ和_in_match _out_match
     if(!_vc_alloc_vcs.empty())
-      _VCAllocEvaluate( );
+      _VCAllocEvaluate<T>( );
   }
-  if(_hold_switch_for_packet) {
+  if(hold_switch) {
     if(!_sw_hold_vcs.empty())
-      _SWHoldEvaluate( );
+      _SWHoldEvaluate<T>( );
   }
-  _sw_allocator->Clear();
-  if(_spec_sw_allocator)
+  sw_allocator->Clear();
+  if(T::speculative && _spec_sw_allocator)
     _spec_sw_allocator->Clear();
   if(!_sw_alloc_vcs.empty())
-    _SWAllocEvaluate( );
+    _SWAllocEvaluate<T>( );
   if(!_crossbar_flits.empty())
-    _SwitchEvaluate( );
+    _SwitchEvaluate<T>( );
 
   if(!_route_vcs.empty()) {
-    _RouteUpdate( );//初始化_vc_alloc_vcs
+    _RouteUpdate<T>( );//初始化_vc_alloc_vcs
     activity = activity || !_route_vcs.empty();
   }
   if(!_vc_alloc_vcs.empty()) {
-    _VCAllocUpdate( );
+    _VCAllocUpdate<T>( );
     activity = activity || !_vc_alloc_vcs.empty();
   }
-  if(_hold_switch_for_packet) {
+  if(hold_switch) {
     if(!_sw_hold_vcs.empty()) {
-      _SWHoldUpdate( );
+      _SWHoldUpdate<T>( );
       activity = activity || !_sw_hold_vcs.empty();
     }
   }
   if(!_sw_alloc_vcs.empty()) {
-    _SWAllocUpdate(subnet , trafficmanager);
+    _SWAllocUpdate<T>(subnet , trafficmanager);
     activity = activity || !_sw_alloc_vcs.empty();
   }
   if(!_crossbar_flits.empty()) {
-    _SwitchUpdate( );
+    _SwitchUpdate<T>( );
     activity = activity || !_crossbar_flits.empty();
   }
 
@@ -299,6 +401,86 @@ void IQRouter::WriteOutputs( )
 }
 
 
+bool IQRouter::Idle( ) const
+{
+  // a fractional internal speedup carries state from one cycle to the next
+  if(_active || (_internal_speedup != floor(_internal_speedup))) {
+    return false;
+  }
+  for(int output = 0; output < _outputs; ++output) {
+    if(!_output_buffer[output].empty()) {
+      return false;
+    }
+  }
+  for(int input = 0; input < _inputs; ++input) {
+    if(!_credit_buffer[input].empty()) {
+      return false;
+    }
+  }
+  // inactive routers still advance the power-gating state of their output
+  // buffers (see _InternalStep)
+  for(int output = 0; output < _outputs - 1; ++output) {
+    BufferState::_states const s = _next_buf[output]->GetState();
+    if((s == BufferState::idle) || (s == BufferState::wakingup)) {
+      return false;
+    }
+  }
+  return !_InputsPending();
+}
+
+void IQRouter::Serialize( Checkpoint & ckpt )
+{
+  _SerializeState(ckpt);
+
+  ckpt.Sync(_active);
+
+  ckpt.Sync(_in_queue_flits);
+  ckpt.Sync(_proc_credits);
+
+  ckpt.Sync(_route_vcs);
+  ckpt.Sync(_vc_alloc_vcs);
+  ckpt.Sync(_sw_hold_vcs);
+  ckpt.Sync(_sw_alloc_vcs);
+  ckpt.Sync(_crossbar_flits);
+
+  ckpt.Sync(_out_queue_credits);
+
+  for(int input = 0; input < _inputs; ++input) {
+    _buf[input]->Serialize(ckpt);
+  }
+  for(int output = 0; output < _outputs; ++output) {
+    _next_buf[output]->Serialize(ckpt);
+  }
+
+  if(_vc_allocator) {
+    _vc_allocator->Serialize(ckpt);
+  }
+  _sw_allocator->Serialize(ckpt);
+  if(_spec_sw_allocator) {
+    _spec_sw_allocator->Serialize(ckpt);
+  }
+  ckpt.Sync(_vc_rr_offset);
+  ckpt.Sync(_sw_rr_offset);
+
+  ckpt.Sync(_output_buffer);
+  ckpt.Sync(_credit_buffer);
+
+  ckpt.Sync(_switch_hold_in);
+  ckpt.Sync(_switch_hold_out);
+  ckpt.Sync(_switch_hold_vc);
+
+  ckpt.Sync(_noq_next_output_port);
+  ckpt.Sync(_noq_next_vc_start);
+  ckpt.Sync(_noq_next_vc_end);
+
+#ifdef TRACK_FLOWS
+  ckpt.Sync(_outstanding_classes);
+#endif
+
+  _switchMonitor->Serialize(ckpt);
+  _bufferMonitor->Serialize(ckpt);
+}
+
 //------------------------------------------------------------------------------
 // read inputs
 //------------------------------------------------------------------------------
@@ -311,7 +493,7 @@ bool IQRouter::_ReceiveFlits( )
     if(f) {
 
 #ifdef TRACK_FLOWS
-      ++_received_flits[f->cl][input];
+      ++_received_flits[f->packet->cl][input];
 #endif
 
       if(f->watch) {
@@ -320,7 +502,8 @@ bool IQRouter::_ReceiveFlits( )
 		   << " from channel at input " << input
 		   << "." << endl;
       }
-      _in_queue_flits.insert(make_pair(input, f));
+      assert(!_in_queue_flits[input]);
+      _in_queue_flits[input] = f;
       activity = true;
     }
   }
@@ -346,21 +529,18 @@ bool IQRouter::_ReceiveCredits( )
 // input queuing
 //------------------------------------------------------------------------------
 
+template<class T>
 void IQRouter::_InputQueuing(int subnet, TrafficManager * trafficmanager )//flit流通：_input -> _wait_queue -> _output -> _in_queue_flits -> cur_buf(cur_vc->buffer)
 {
-    vector<int> v;
-    v.resize(_inputs);
-    for (int i = 0; i < _inputs; ++i) {
-        v[i] = 0;
-    }
-    //active路由器的输入端口状态变化
-    for(map<int, Flit *>::const_iterator iter = _in_queue_flits.begin(); iter != _in_queue_flits.end(); ++iter) {
-        int input = iter->first;
-        v[input] = 1;
-    }
+  bool const speculative = T::speculative && _speculative;
+  bool const noq = T::noq && _noq;
+  int const input_speedup = T::unit_speedup ? 1 : _input_speedup;
+  typename T::tVCAlloc * const vc_allocator
+    = static_cast<typename T::tVCAlloc *>(_vc_allocator);
+
 //input that without flit；这里不需要修改vc，因为进入_in_queue_flits之前，flit要么来自PE（_step修改了vc），要么来自其他路由器（_VCAllocUdpate修改了vc）
         /*for (int j = 0; j < _inputs; ++j) {
-            if (v[j] == 0) {
+            if (!_in_queue_flits[j]) {
                 if (j == 4) {
                     int n = this->_id;
                     BufferState * destBuf = trafficmanager->GetDestBuf(n,subnet);
@@ -375,14 +555,13 @@ void IQRouter::_InputQueuing(int subnet, TrafficManager * trafficmanager )//flit
             }
         }*/
 
-    for(map<int, Flit *>::const_iterator iter = _in_queue_flits.begin();//判断_in_queue_flits的内容是否有问题 -> 将flit添加到vc的buffer -> 判断vc的buffer里面的flit是否有问题 -> 将flit的路由信息给vc，vc的_state设为Alloc
-      iter != _in_queue_flits.end();
-      ++iter) {
+    for(int input = 0; input < _inputs; ++input) {//判断_in_queue_flits的内容是否有问题 -> 将flit添加到vc的buffer -> 判断vc的buffer里面的flit是否有问题 -> 将flit的路由信息给vc，vc的_state设为Alloc
 
-    int const input = iter->first;
-    assert((input >= 0) && (input < _inputs));
-    Flit * const f = iter->second;
-    assert(f);
+    Flit * const f = _in_queue_flits[input];
+    if(!f) {
+      continue;
+    }
+    _in_queue_flits[input] = NULL;
 
     int vc = f->vc;
     assert((vc >= 0) && (vc < _vcs));
@@ -401,7 +580,7 @@ void IQRouter::_InputQueuing(int subnet, TrafficManager * trafficmanager )//flit
 
         Buffer * const cur_buf = _buf[input];
       
-    if(f->watch) {
+    if(T::watch && f->watch) {
       *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		 << "Adding flit " << f->id
 		 << " to VC " << vc
@@ -418,8 +597,8 @@ void IQRouter::_InputQueuing(int subnet, TrafficManager * trafficmanager )//flit
     cur_buf->AddFlit(vc, f);//AddFlit作用：buf[input]的occupancy++；将flit加入对应虚拟信道的buffer队列。
 
 #ifdef TRACK_FLOWS
-    ++_stored_flits[f->cl][input];
-    if(f->head) ++_active_packets[f->cl][input];
+    ++_stored_flits[f->packet->cl][input];
+    if(f->head) ++_active_packets[f->packet->cl][input];
 #endif
 
     _bufferMonitor->write(input, f) ;//bufferMonitor的writes[input]++
@@ -428,35 +607,35 @@ void IQRouter::_InputQueuing(int subnet, TrafficManager * trafficmanager )//flit
       assert(cur_buf->FrontFlit(vc) == f);//vc的buffer.front()
       assert(cur_buf->GetOccupancy(vc) == 1);//vc的buffer.size()
       assert(f->head);
-      assert(_switch_hold_vc[input*_input_speedup + vc%_input_speedup] != vc);
+      assert(_switch_hold_vc[input*input_speedup + vc%input_speedup] != vc);
       if(_routing_delay) {
 	cur_buf->SetState(vc, VC::routing);
 	_route_vcs.push_back(make_pair(-1, make_pair(input, vc)));
       } else {
-	if(f->watch) {
+	if(T::watch && f->watch) {
 	  *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		     << "Using precomputed lookahead routing information for VC " << vc
 		     << " at input " << input
 		     << " (front: " << f->id
 		     << ")." << endl;
 	}
-	cur_buf->SetRouteSet(vc, &f->la_route_set);//flit的la_route_set给到vc的_route_set
+	cur_buf->SetRouteSet(vc, &f->packet->la_route_set);//flit的la_route_set给到vc的_route_set
 	cur_buf->SetState(vc, VC::vc_alloc);//如果是lookahead路由，vc状态直接由idle变为vc_alloc，中间没有routing状态过渡
-	if(_speculative) {
+	if(speculative) {
 	  _sw_alloc_vcs.push_back(make_pair(-1, make_pair(make_pair(input, vc),
 							  -1)));
 	}
-	if(_vc_allocator) {
+	if(vc_allocator) {
 	  _vc_alloc_vcs.push_back(make_pair(-1, make_pair(make_pair(input, vc), 
 							  -1)));
 	}
-	if(_noq) {
+	if(noq) {
 	  _UpdateNOQ(input, vc, f);
 	}
       }
     } else if((cur_buf->GetState(vc) == VC::active) &&
 	      (cur_buf->FrontFlit(vc) == f)) {
-      if(_switch_hold_vc[input*_input_speedup + vc%_input_speedup] == vc) {
+      if(_switch_hold_vc[input*input_speedup + vc%input_speedup] == vc) {
 	_sw_hold_vcs.push_back(make_pair(-1, make_pair(make_pair(input, vc),
 						       -1)));
       } else {
@@ -465,7 +644,6 @@ void IQRouter::_InputQueuing(int subnet, TrafficManager * trafficmanager )//flit
       }
     }
   }
-  _in_queue_flits.clear();//对in_queue_flits里面的所有flit完成上面操作后清空队列
 
   while(!_proc_credits.empty()) {
 
@@ -485,8 +663,7 @@ void IQRouter::_InputQueuing(int subnet, TrafficManager * trafficmanager )//flit
     BufferState * const dest_buf = _next_buf[output];
     
 #ifdef TRACK_FLOWS
-    for(set<int>::const_iterator iter = c->vc.begin(); iter != c->vc.end(); ++iter) {
-      int const vc = *iter;
+    for(int vc = c->vc.First(); vc >= 0; vc = c->vc.Next(vc)) {
       assert(!_outstanding_classes[output][vc].empty());
       int cl = _outstanding_classes[output][vc].front();
       _outstanding_classes[output][vc].pop();
@@ -506,11 +683,12 @@ void IQRouter::_InputQueuing(int subnet, TrafficManager * trafficmanager )//flit
 // routing
 //------------------------------------------------------------------------------
 
+template<class T>
 void IQRouter::_RouteEvaluate( )
 {
   assert(_routing_delay);
 
-  for(deque<pair<int, pair<int, int> > >::iterator iter = _route_vcs.begin();
+  for(RingQueue<pair<int, pair<int, int> > >::iterator iter = _route_vcs.begin();
       iter != _route_vcs.end();
       ++iter) {
     
@@ -534,7 +712,7 @@ void IQRouter::_RouteEvaluate( )
     assert(f->vc == vc);
     assert(f->head);
 
-    if(f->watch) {
+    if(T::watch && f->watch) {
       *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		 << "Beginning routing for VC " << vc
 		 << " at input " << input
@@ -544,8 +722,13 @@ void IQRouter::_RouteEvaluate( )
   }    
 }
 
+template<class T>
 void IQRouter::_RouteUpdate( )
 {
+  bool const speculative = T::speculative && _speculative;
+  typename T::tVCAlloc * const vc_allocator
+    = static_cast<typename T::tVCAlloc *>(_vc_allocator);
+
   assert(_routing_delay);
 
   while(!_route_vcs.empty()) {
@@ -572,7 +755,7 @@ void IQRouter::_RouteUpdate( )
     assert(f->vc == vc);
     assert(f->head);
 
-    if(f->watch) {
+    if(T::watch && f->watch) {
       *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		 << "Completed routing for VC " << vc
 		 << " at input " << input
@@ -582,10 +765,10 @@ void IQRouter::_RouteUpdate( )
 
     cur_buf->Route(vc, _rf, this, f, input);
     cur_buf->SetState(vc, VC::vc_alloc);
-    if(_speculative) {
+    if(speculative) {
       _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second, -1)));
     }
-    if(_vc_allocator) {
+    if(vc_allocator) {
       _vc_alloc_vcs.push_back(make_pair(-1, make_pair(item.second, -1)));
     }
     // NOTE: No need to handle NOQ here, as it requires lookahead routing!
@@ -598,13 +781,18 @@ void IQRouter::_RouteUpdate( )
 // VC allocation
 //------------------------------------------------------------------------------
 
+template<class T>
 void IQRouter::_VCAllocEvaluate( )
 {
-  assert(_vc_allocator);
+  bool const noq = T::noq && _noq;
+  typename T::tVCAlloc * const vc_allocator
+    = static_cast<typename T::tVCAlloc *>(_vc_allocator);
+
+  assert(vc_allocator);
 
   bool watched = false;
 
-  for(deque<pair<int, pair<pair<int, int>, int> > >::iterator iter = _vc_alloc_vcs.begin();
+  for(RingQueue<pair<int, pair<pair<int, int>, int> > >::iterator iter = _vc_alloc_vcs.begin();
       iter != _vc_alloc_vcs.end();
       ++iter) {//_vc_alloc_vcs={-1, [(4, 0), -1]}，两个-1由程序指定，4为输入信道，0为vc
 
@@ -629,7 +817,7 @@ void IQRouter::_VCAllocEvaluate( )
     assert(f->vc == vc);
     assert(f->head);
 
-    if(f->watch) {
+    if(T::watch && f->watch) {
       *gWatchOut << GetSimTime() << " | " << FullName() << " | " 
 		 << "Beginning VC allocation for VC " << vc
 		 << " at input " << input
@@ -641,15 +829,15 @@ void IQRouter::_VCAllocEvaluate( )
     assert(route_set);
 
     int const out_priority = cur_buf->GetPriority(vc);//vc的_pri，当多个vc竞争同一条输出信道时，依据out_priority选择优先级最高的vc
-    set<OutputSet::sSetElement> const setlist = route_set->GetSet();
+    OutputSet const & setlist = route_set->GetSet();
 
     bool elig = false;
     bool cred = false;
     bool reserved = false;
 
-    assert(!_noq || (setlist.size() == 1));
+    assert(!noq || (setlist.size() == 1));
 
-    for(set<OutputSet::sSetElement>::const_iterator iset = setlist.begin();
+    for(OutputSet::const_iterator iset = setlist.begin();
 	iset != setlist.end();
 	++iset) {
 
@@ -660,7 +848,7 @@ void IQRouter::_VCAllocEvaluate( )
 
       int vc_start;
       int vc_end;
-      if(_noq && _noq_next_output_port[input][vc] >= 0) {
+      if(noq && _noq_next_output_port[input][vc] >= 0) {
 	assert(!_routing_delay);
 	vc_start = _noq_next_vc_start[input][vc];
 	vc_end = _noq_next_vc_end[input][vc];
@@ -692,7 +880,7 @@ void IQRouter::_VCAllocEvaluate( )
 	// actual packet priorities, which is reflected in "out_priority".
 	
 	if(!dest_buf->IsAvailableFor(out_vc)) {//返回_in_use_by[vc]<0
-	  if(f->watch) {
+	  if(T::watch && f->watch) {
 	    int const use_input_and_vc = dest_buf->UsedBy(out_vc);
 	    int const use_input = use_input_and_vc / _vcs;
 	    int const use_vc = use_input_and_vc % _vcs;
@@ -712,7 +900,7 @@ void IQRouter::_VCAllocEvaluate( )
 	} else {
 	  elig = true;
 	  if(_vc_busy_when_full && dest_buf->IsFullFor(out_vc)) {
-	    if(f->watch)
+	    if(T::watch && f->watch)
 	      *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 			 << "  VC " << out_vc 
 			 << " at output " << out_port 
@@ -720,7 +908,7 @@ void IQRouter::_VCAllocEvaluate( )
 	    reserved |= !dest_buf->IsFull();
 	  } else {
 	    cred = true;
-	    if(f->watch){
+	    if(T::watch && f->watch){
 	      *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 			 << "  Requesting VC " << out_vc
 			 << " at output " << out_port 
@@ -731,7 +919,7 @@ void IQRouter::_VCAllocEvaluate( )
 	    }
 	    int const input_and_vc
 	      = _vc_shuffle_requests ? (vc*_inputs + input) : (input*_vcs + vc);//_vc_shuffle_requests来源于配置文件；input为输入信道;vc为flit选择的vc
-	    _vc_allocator->AddRequest(input_and_vc, out_port*_vcs + out_vc, //对allocator来说，有10个输入信道和10个输出信道，从0到9编号，则第四个输入信道的两个虚拟信道分别为8和9;第一个输出信道为2，3。
+	    vc_allocator->AddRequest(input_and_vc, out_port*_vcs + out_vc, //对allocator来说，有10个输入信道和10个输出信道，从0到9编号，则第四个输入信道的两个虚拟信道分别为8和9;第一个输出信道为2，3。
 				      0, in_priority, out_priority);//添加_in_req和_out_req
 	  }
 	}
@@ -744,18 +932,18 @@ void IQRouter::_VCAllocEvaluate( )
     }
   }
 
-  if(watched) {
-    *gWatchOut << GetSimTime() << " | " << _vc_allocator->FullName() << " | ";
-    _vc_allocator->PrintRequests( gWatchOut );
+  if(T::watch && watched) {
+    *gWatchOut << GetSimTime() << " | " << vc_allocator->FullName() << " | ";
+    vc_allocator->PrintRequests( gWatchOut );
   }
 
-  _vc_allocator->Allocate();//input output 相互授权grants和配对 _in_match _out_match
+  vc_allocator->Allocate();//input output 相互授权grants和配对 _in_match _out_match
 
-  if(watched) {
-    *gWatchOut << GetSimTime() << " | " << _vc_allocator->FullName() << " | ";
-    _vc_allocator->PrintGrants( gWatchOut );
+  if(T::watch && watched) {
+    *gWatchOut << GetSimTime() << " | " << vc_allocator->FullName() << " | ";
+    vc_allocator->PrintGrants( gWatchOut );
   }
-  for(deque<pair<int, pair<pair<int, int>, int> > >::iterator iter = _vc_alloc_vcs.begin();
+  for(RingQueue<pair<int, pair<pair<int, int>, int> > >::iterator iter = _vc_alloc_vcs.begin();
       iter != _vc_alloc_vcs.end();
       ++iter) {
 
@@ -787,7 +975,7 @@ void IQRouter::_VCAllocEvaluate( )
 
     int const input_and_vc
       = _vc_shuffle_requests ? (vc*_inputs + input) : (input*_vcs + vc);
-    int const output_and_vc = _vc_allocator->OutputAssigned(input_and_vc);
+    int const output_and_vc = vc_allocator->OutputAssigned(input_and_vc);
 
     if(output_and_vc >= 0) {
 
@@ -796,7 +984,7 @@ void IQRouter::_VCAllocEvaluate( )
       int const match_vc = output_and_vc % _vcs;//输出端口的vc
       assert((match_vc >= 0) && (match_vc < _vcs));
 
-      if(f->watch) {
+      if(T::watch && f->watch) {
 	*gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		   << "Assigning VC " << match_vc
 		   << " at output " << match_output 
@@ -809,7 +997,7 @@ void IQRouter::_VCAllocEvaluate( )
 
     } else {
 
-      if(f->watch) {
+      if(T::watch && f->watch) {
 	*gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		   << "VC allocation failed for VC " << vc
 		   << " at input " << input
@@ -825,7 +1013,7 @@ void IQRouter::_VCAllocEvaluate( )
     return;
   }
 
-  for(deque<pair<int, pair<pair<int, int>, int> > >::iterator iter = _vc_alloc_vcs.begin();
+  for(RingQueue<pair<int, pair<pair<int, int>, int> > >::iterator iter = _vc_alloc_vcs.begin();
       iter != _vc_alloc_vcs.end();
       ++iter) {
     
@@ -863,7 +1051,7 @@ void IQRouter::_VCAllocEvaluate( )
       assert(f->head);
       
       if(!dest_buf->IsAvailableFor(match_vc)) {
-	if(f->watch) {
+	if(T::watch && f->watch) {
 	  *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		     << "  Discarding previously generated grant for VC " << vc
 		     << " at input " << input
@@ -873,7 +1061,7 @@ void IQRouter::_VCAllocEvaluate( )
 	}
 	iter->second.second = STALL_BUFFER_BUSY;
       } else if(_vc_busy_when_full && dest_buf->IsFullFor(match_vc)) {
-	if(f->watch) {
+	if(T::watch && f->watch) {
 	  *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		     << "  Discarding previously generated grant for VC " << vc
 		     << " at input " << input
@@ -887,11 +1075,14 @@ void IQRouter::_VCAllocEvaluate( )
   }
 }
 
+template<class T>
 void IQRouter::_VCAllocUpdate( )
 {
+  bool const speculative = T::speculative && _speculative;
+
   assert(_vc_allocator);
 //向量记录match_output
-  vector<int> m={0,0,0,0,0};
+  _vc_alloc_matched.assign(_outputs, 0);
   while(!_vc_alloc_vcs.empty()) {
 
     pair<int, pair<pair<int, int>, int> > const & item = _vc_alloc_vcs.front();
@@ -918,7 +1109,7 @@ void IQRouter::_VCAllocUpdate( )
     assert(f->vc == vc);
     assert(f->head);
     
-    if(f->watch) {
+    if(T::watch && f->watch) {
       *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		 << "Completed VC allocation for VC " << vc
 		 << " at input " << input
@@ -931,12 +1122,12 @@ void IQRouter::_VCAllocUpdate( )
     if(output_and_vc >= 0) {
       
       int const match_output = output_and_vc / _vcs;
-      m[match_output] = 1;
+      _vc_alloc_matched[match_output] = 1;
       assert((match_output >= 0) && (match_output < _outputs));
       int const match_vc = output_and_vc % _vcs;
       assert((match_vc >= 0) && (match_vc < _vcs));
       
-      if(f->watch) {
+      if(T::watch && f->watch) {
 	*gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		   << "  Acquiring assigned VC " << match_vc
 		   << " at output " << match_output
@@ -951,11 +1142,11 @@ void IQRouter::_VCAllocUpdate( )
 	
       cur_buf->SetOutput(vc, match_output, match_vc);//设置当前vc的_out_port为match_outport，_out_vc为match_vc
       cur_buf->SetState(vc, VC::active);//设置当前vc状态为active
-      if(!_speculative) {
+      if(!speculative) {
 	_sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first, -1)));
       }
     } else {
-      if(f->watch) {
+      if(T::watch && f->watch) {
 	*gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		   << "  No output VC allocated." << endl;
       }
@@ -964,9 +1155,9 @@ void IQRouter::_VCAllocUpdate( )
       assert((output_and_vc == STALL_BUFFER_BUSY) ||
 	     (output_and_vc == STALL_BUFFER_CONFLICT));
       if(output_and_vc == STALL_BUFFER_BUSY) {
-	++_buffer_busy_stalls[f->cl];
+	++_buffer_busy_stalls[f->packet->cl];
       } else if(output_and_vc == STALL_BUFFER_CONFLICT) {
-	++_buffer_conflict_stalls[f->cl];
+	++_buffer_conflict_stalls[f->packet->cl];
       }
 #endif
 
@@ -975,7 +1166,7 @@ void IQRouter::_VCAllocUpdate( )
     _vc_alloc_vcs.pop_front();
   }
   for (int output = 0; output < _outputs - 1; ++output) {
-    if(m[output] == 0)
+    if(_vc_alloc_matched[output] == 0)
       _next_buf[output]->nextBufWithoutHeadFlit();
   }
 }
@@ -985,11 +1176,15 @@ void IQRouter::_VCAllocUpdate( )
 // switch holding
 //------------------------------------------------------------------------------
 
+template<class T>
 void IQRouter::_SWHoldEvaluate( )
 {
+  int const input_speedup = T::unit_speedup ? 1 : _input_speedup;
+  int const output_speedup = T::unit_speedup ? 1 : _output_speedup;
+
   assert(_hold_switch_for_packet);
 
-  for(deque<pair<int, pair<pair<int, int>, int> > >::iterator iter = _sw_hold_vcs.begin();
+  for(RingQueue<pair<int, pair<pair<int, int>, int> > >::iterator iter = _sw_hold_vcs.begin();
       iter != _sw_hold_vcs.end();
       ++iter) {
     
@@ -1014,7 +1209,7 @@ void IQRouter::_SWHoldEvaluate( )
     assert(f);
     assert(f->vc == vc);
 
-    if(f->watch) {
+    if(T::watch && f->watch) {
       *gWatchOut << GetSimTime() << " | " << FullName() << " | " 
 		 << "Beginning held switch allocation for VC " << vc
 		 << " at input " << input
@@ -1022,7 +1217,7 @@ void IQRouter::_SWHoldEvaluate( )
 		 << ")." << endl;
     }
     
-    int const expanded_input = input * _input_speedup + vc % _input_speedup;
+    int const expanded_input = input * input_speedup + vc % input_speedup;
     assert(_switch_hold_vc[expanded_input] == vc);
     
     int const match_port = cur_buf->GetOutputPort(vc);
@@ -1030,28 +1225,28 @@ void IQRouter::_SWHoldEvaluate( )
     int const match_vc = cur_buf->GetOutputVC(vc);
     assert((match_vc >= 0) && (match_vc < _vcs));
     
-    int const expanded_output = match_port*_output_speedup + input%_output_speedup;
+    int const expanded_output = match_port*output_speedup + input%output_speedup;
     assert(_switch_hold_in[expanded_input] == expanded_output);
     
     BufferState const * const dest_buf = _next_buf[match_port];
     
     if(dest_buf->IsFullFor(match_vc)) {
-      if(f->watch) {
+      if(T::watch && f->watch) {
 	*gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		   << "  Unable to reuse held connection from input " << input
-		   << "." << (expanded_input % _input_speedup)
+		   << "." << (expanded_input % input_speedup)
 		   << " to output " << match_port
-		   << "." << (expanded_output % _output_speedup)
+		   << "." << (expanded_output % output_speedup)
 		   << ": No credit available." << endl;
       }
       iter->second.second = dest_buf->IsFull() ? STALL_BUFFER_FULL : STALL_BUFFER_RESERVED;
     } else {
-      if(f->watch) {
+      if(T::watch && f->watch) {
 	*gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		   << "  Reusing held connection from input " << input
-		   << "." << (expanded_input % _input_speedup)
+		   << "." << (expanded_input % input_speedup)
 		   << " to output " << match_port
-		   << "." << (expanded_output % _output_speedup)
+		   << "." << (expanded_output % output_speedup)
 		   << "." << endl;
       }
       iter->second.second = expanded_output;
@@ -1059,8 +1254,16 @@ void IQRouter::_SWHoldEvaluate( )
   }
 }
 
+template<class T>
 void IQRouter::_SWHoldUpdate( )
 {
+  bool const speculative = T::speculative && _speculative;
+  bool const noq = T::noq && _noq;
+  int const input_speedup = T::unit_speedup ? 1 : _input_speedup;
+  int const output_speedup = T::unit_speedup ? 1 : _output_speedup;
+  typename T::tVCAlloc * const vc_allocator
+    = static_cast<typename T::tVCAlloc *>(_vc_allocator);
+
   assert(_hold_switch_for_packet);
 
   while(!_sw_hold_vcs.empty()) {
@@ -1088,7 +1291,7 @@ void IQRouter::_SWHoldUpdate( )
     assert(f);
     assert(f->vc == vc);
 
-    if(f->watch) {
+    if(T::watch && f->watch) {
       *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		 << "Completed held switch allocation for VC " << vc
 		 << " at input " << input
@@ -1096,17 +1299,17 @@ void IQRouter::_SWHoldUpdate( )
 		 << ")." << endl;
     }
     
-    int const expanded_input = input * _input_speedup + vc % _input_speedup;
+    int const expanded_input = input * input_speedup + vc % input_speedup;
     assert(_switch_hold_vc[expanded_input] == vc);
     
     int const expanded_output = item.second.second;
     
-    if(expanded_output >= 0 && ( _output_buffer_size==-1 || _output_buffer[expanded_output/_output_speedup].size()<size_t(_output_buffer_size))) {
+    if(expanded_output >= 0 && ( _output_buffer_size==-1 || _output_buffer[expanded_output/output_speedup].size()<size_t(_output_buffer_size))) {
       
       assert(_switch_hold_in[expanded_input] == expanded_output);
       assert(_switch_hold_out[expanded_output] == expanded_input);
       
-      int const output = expanded_output / _output_speedup;
+      int const output = expanded_output / output_speedup;
       assert((output >= 0) && (output < _outputs));
       assert(cur_buf->GetOutputPort(vc) == output);
       
@@ -1115,20 +1318,20 @@ void IQRouter::_SWHoldUpdate( )
       
       BufferState * const dest_buf = _next_buf[output];
       
-      if(f->watch) {
+      if(T::watch && f->watch) {
 	*gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		   << "  Scheduling switch connection from input " << input
-		   << "." << (vc % _input_speedup)
+		   << "." << (vc % input_speedup)
 		   << " to output " << output
-		   << "." << (expanded_output % _output_speedup)
+		   << "." << (expanded_output % output_speedup)
 		   << "." << endl;
       }
       
       cur_buf->RemoveFlit(vc);
 
 #ifdef TRACK_FLOWS
-      --_stored_flits[f->cl][input];
-      if(f->tail) --_active_packets[f->cl][input];
+      --_stored_flits[f->packet->cl][input];
+      if(f->tail) --_active_packets[f->packet->cl][input];
 #endif
 
       _bufferMonitor->read(input, f) ;
@@ -1140,8 +1343,8 @@ void IQRouter::_SWHoldUpdate( )
 	const FlitChannel * channel = _output_channels[output];
 	const Router * router = channel->GetSink();
 	if(router) {
-	  if(_noq) {
-	    if(f->watch) {
+	  if(noq) {
+	    if(T::watch && f->watch) {
 	      *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 			 << "Updating lookahead routing information for flit " << f->id
 			 << " (NOQ)." << endl;
@@ -1155,43 +1358,43 @@ void IQRouter::_SWHoldUpdate( )
 	    int next_vc_end = _noq_next_vc_end[input][vc];
 	    assert(next_vc_end >= 0 && next_vc_end < _vcs);
 	    _noq_next_vc_end[input][vc] = -1;
-	    f->la_route_set.Clear();
-	    f->la_route_set.AddRange(next_output_port, next_vc_start, next_vc_end);
+	    f->packet->la_route_set.Clear();
+	    f->packet->la_route_set.AddRange(next_output_port, next_vc_start, next_vc_end);
 	  } else {
-	    if(f->watch) {
+	    if(T::watch && f->watch) {
 	      *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 			 << "Updating lookahead routing information for flit " << f->id
 			 << "." << endl;
 	    }
 	    int in_channel = channel->GetSinkPort();
-	    _rf(router, f, in_channel, &f->la_route_set, false);
+	    _rf(router, f, in_channel, &f->packet->la_route_set, false);
 	  }
 	} else {
-	  f->la_route_set.Clear();
+	  f->packet->la_route_set.Clear();
 	}
       }
 
 #ifdef TRACK_FLOWS
-      ++_outstanding_credits[f->cl][output];
-      _outstanding_classes[output][f->vc].push(f->cl);
+      ++_outstanding_credits[f->packet->cl][output];
+      _outstanding_classes[output][f->vc].push(f->packet->cl);
 #endif
 
       dest_buf->SendingFlit(f);
 
       _crossbar_flits.push_back(make_pair(-1, make_pair(f, make_pair(expanded_input, expanded_output))));
       
-      if(_out_queue_credits.count(input) == 0) {
-	_out_queue_credits.insert(make_pair(input, Credit::New()));
+      if(!_out_queue_credits[input]) {
+	_out_queue_credits[input] = Credit::New();
       }
-      _out_queue_credits.find(input)->second->vc.insert(vc);
+      _out_queue_credits[input]->vc.Insert(vc);
       
       if(cur_buf->Empty(vc)) {
-	if(f->watch) {
+	if(T::watch && f->watch) {
 	  *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		     << "  Cancelling held connection from input " << input
-		     << "." << (expanded_input % _input_speedup)
+		     << "." << (expanded_input % input_speedup)
 		     << " to " << output
-		     << "." << (expanded_output % _output_speedup)
+		     << "." << (expanded_output % output_speedup)
 		     << ": No more flits." << endl;
 	}
 	_switch_hold_vc[expanded_input] = -1;
@@ -1206,12 +1409,12 @@ void IQRouter::_SWHoldUpdate( )
 	assert(nf->vc == vc);
 	if(f->tail) {
 	  assert(nf->head);
-	  if(f->watch) {
+	  if(T::watch && f->watch) {
 	    *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		       << "  Cancelling held connection from input " << input
-		       << "." << (expanded_input % _input_speedup)
+		       << "." << (expanded_input % input_speedup)
 		       << " to " << output
-		       << "." << (expanded_output % _output_speedup)
+		       << "." << (expanded_output % output_speedup)
 		       << ": End of packet." << endl;
 	  }
 	  _switch_hold_vc[expanded_input] = -1;
@@ -1221,24 +1424,24 @@ void IQRouter::_SWHoldUpdate( )
 	    cur_buf->SetState(vc, VC::routing);
 	    _route_vcs.push_back(make_pair(-1, item.second.first));
 	  } else {
-	    if(nf->watch) {
+	    if(T::watch && nf->watch) {
 	      *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 			 << "Using precomputed lookahead routing information for VC " << vc
 			 << " at input " << input
 			 << " (front: " << nf->id
 			 << ")." << endl;
 	    }
-	    cur_buf->SetRouteSet(vc, &nf->la_route_set);
+	    cur_buf->SetRouteSet(vc, &nf->packet->la_route_set);
 	    cur_buf->SetState(vc, VC::vc_alloc);
-	    if(_speculative) {
+	    if(speculative) {
 	      _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first,
 							      -1)));
 	    }
-	    if(_vc_allocator) {
+	    if(vc_allocator) {
 	      _vc_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first,
 							      -1)));
 	    }
-	    if(_noq) {
+	    if(noq) {
 	      _UpdateNOQ(input, vc, nf);
 	    }
 	  }
@@ -1250,17 +1453,17 @@ void IQRouter::_SWHoldUpdate( )
     } else {
       //when internal speedup >1.0, the buffer stall stats may not be accruate
       assert((expanded_output == STALL_BUFFER_FULL) ||
-	     (expanded_output == STALL_BUFFER_RESERVED) || !( _output_buffer_size==-1 || _output_buffer[expanded_output/_output_speedup].size()<size_t(_output_buffer_size)));
+	     (expanded_output == STALL_BUFFER_RESERVED) || !( _output_buffer_size==-1 || _output_buffer[expanded_output/output_speedup].size()<size_t(_output_buffer_size)));
 
       int const held_expanded_output = _switch_hold_in[expanded_input];
       assert(held_expanded_output >= 0);
       
-      if(f->watch) {
+      if(T::watch && f->watch) {
 	*gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		   << "  Cancelling held connection from input " << input
-		   << "." << (expanded_input % _input_speedup)
-		   << " to " << (held_expanded_output / _output_speedup)
-		   << "." << (held_expanded_output % _output_speedup)
+		   << "." << (expanded_input % input_speedup)
+		   << " to " << (held_expanded_output / output_speedup)
+		   << "." << (held_expanded_output % output_speedup)
 		   << ": Flit not sent." << endl;
       }
       _switch_hold_vc[expanded_input] = -1;
@@ -1278,8 +1481,13 @@ void IQRouter::_SWHoldUpdate( )
 // switch allocation
 //------------------------------------------------------------------------------
 
+template<class T>
 bool IQRouter::_SWAllocAddReq(int input, int vc, int output)
 {
+  bool const speculative = T::speculative && _speculative;
+  int const input_speedup = T::unit_speedup ? 1 : _input_speedup;
+  int const output_speedup = T::unit_speedup ? 1 : _output_speedup;
+
   assert(input >= 0 && input < _inputs);
   assert(vc >= 0 && vc < _vcs);
   assert(output >= 0 && output < _outputs);
@@ -1288,13 +1496,13 @@ bool IQRouter::_SWAllocAddReq(int input, int vc, int output)
   // create multiple input ports to the switch. Similarily, the output ports 
   // are interleaved based on their originating input when output_speedup > 1.
   
-  int const expanded_input = input * _input_speedup + vc % _input_speedup;
-  int const expanded_output = output * _output_speedup + input % _output_speedup;
+  int const expanded_input = input * input_speedup + vc % input_speedup;
+  int const expanded_output = output * output_speedup + input % output_speedup;
   
   Buffer const * const cur_buf = _buf[input];
   assert(!cur_buf->Empty(vc));
   assert((cur_buf->GetState(vc) == VC::active) || 
-	 (_speculative && (cur_buf->GetState(vc) == VC::vc_alloc)));
+	 (speculative && (cur_buf->GetState(vc) == VC::vc_alloc)));
   
   Flit const * const f = cur_buf->FrontFlit(vc);
   assert(f);
@@ -1303,89 +1511,114 @@ bool IQRouter::_SWAllocAddReq(int input, int vc, int output)
   if((_switch_hold_in[expanded_input] < 0) && 
      (_switch_hold_out[expanded_output] < 0)) {
     
-    Allocator * allocator = _sw_allocator;
     int prio = cur_buf->GetPriority(vc);
     
-    if(_speculative && (cur_buf->GetState(vc) == VC::vc_alloc)) {
+    if(speculative && (cur_buf->GetState(vc) == VC::vc_alloc)) {
       if(_spec_sw_allocator) {
-	allocator = _spec_sw_allocator;
-      } else {
-	assert(prio >= 0);
-	prio += numeric_limits<int>::min();
+	return _SWAllocAddReq<T>(_spec_sw_allocator, input, vc, output, prio);
       }
+      assert(prio >= 0);
+      prio += numeric_limits<int>::min();
     }
     
-    Allocator::sRequest req;
-    
-    if(allocator->ReadRequest(req, expanded_input, expanded_output)) {
-      if(RoundRobinArbiter::Supersedes(vc, prio, req.label, req.in_pri, 
-				       _sw_rr_offset[expanded_input], _vcs)) {
-	if(f->watch) {
-	  *gWatchOut << GetSimTime() << " | " << FullName() << " | "
-		     << "  Replacing earlier request from VC " << req.label
-		     << " for output " << output 
-		     << "." << (expanded_output % _output_speedup)
-		     << " with priority " << req.in_pri
-		     << " (" << ((cur_buf->GetState(vc) == VC::active) ? 
-				 "non-spec" : 
-				 "spec")
-		     << ", pri: " << prio
-		     << ")." << endl;
-	}
-	allocator->RemoveRequest(expanded_input, expanded_output, req.label);
-	allocator->AddRequest(expanded_input, expanded_output, vc, prio, prio);
-	return true;
-      }
-      if(f->watch) {
-	*gWatchOut << GetSimTime() << " | " << FullName() << " | "
-		   << "  Output " << output
-		   << "." << (expanded_output % _output_speedup)
-		   << " was already requested by VC " << req.label
-		   << " with priority " << req.in_pri
-		   << " (pri: " << prio
-		   << ")." << endl;
-      }
-      return false;
-    }
-    if(f->watch) {
-      *gWatchOut << GetSimTime() << " | " << FullName() << " | "
-		 << "  Requesting output " << output
-		 << "." << (expanded_output % _output_speedup)
-		 << " (" << ((cur_buf->GetState(vc) == VC::active) ? 
-			     "non-spec" : 
-			     "spec")
-		 << ", pri: " << prio
-		 << ")." << endl;
-    }
-    allocator->AddRequest(expanded_input, expanded_output, vc, prio, prio);
-    return true;
+    typename T::tSWAlloc * const sw_allocator
+      = static_cast<typename T::tSWAlloc *>(_sw_allocator);
+    return _SWAllocAddReq<T>(sw_allocator, input, vc, output, prio);
   }
-  if(f->watch) {
+  if(T::watch && f->watch) {
     *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 	       << "  Ignoring output " << output
-	       << "." << (expanded_output % _output_speedup)
+	       << "." << (expanded_output % output_speedup)
 	       << " due to switch hold (";
     if(_switch_hold_in[expanded_input] >= 0) {
       *gWatchOut << "input: " << input
-		 << "." << (expanded_input % _input_speedup);
+		 << "." << (expanded_input % input_speedup);
       if(_switch_hold_out[expanded_output] >= 0) {
 	*gWatchOut << ", ";
       }
     }
     if(_switch_hold_out[expanded_output] >= 0) {
       *gWatchOut << "output: " << output
-		 << "." << (expanded_output % _output_speedup);
+		 << "." << (expanded_output % output_speedup);
     }
     *gWatchOut << ")." << endl;
   }
   return false;
 }
 
+template<class T, class A>
+bool IQRouter::_SWAllocAddReq(A * allocator, int input, int vc, int output, int prio)
+{
+  int const input_speedup = T::unit_speedup ? 1 : _input_speedup;
+  int const output_speedup = T::unit_speedup ? 1 : _output_speedup;
+
+  int const expanded_input = input * input_speedup + vc % input_speedup;
+  int const expanded_output = output * output_speedup + input % output_speedup;
+
+  Buffer const * const cur_buf = _buf[input];
+  Flit const * const f = cur_buf->FrontFlit(vc);
+  
+  Allocator::sRequest req;
+  
+  if(allocator->ReadRequest(req, expanded_input, expanded_output)) {
+    if(RoundRobinArbiter::Supersedes(vc, prio, req.label, req.in_pri, 
+				     _sw_rr_offset[expanded_input], _vcs)) {
+      if(T::watch && f->watch) {
+	*gWatchOut << GetSimTime() << " | " << FullName() << " | "
+		   << "  Replacing earlier request from VC " << req.label
+		   << " for output " << output 
+		   << "." << (expanded_output % output_speedup)
+		   << " with priority " << req.in_pri
+		   << " (" << ((cur_buf->GetState(vc) == VC::active) ? 
+			       "non-spec" : 
+			       "spec")
+		   << ", pri: " << prio
+		   << ")." << endl;
+      }
+      allocator->RemoveRequest(expanded_input, expanded_output, req.label);
+      allocator->AddRequest(expanded_input, expanded_output, vc, prio, prio);
+      return true;
+    }
+    if(T::watch && f->watch) {
+      *gWatchOut << GetSimTime() << " | " << FullName() << " | "
+		 << "  Output " << output
+		 << "." << (expanded_output % output_speedup)
+		 << " was already requested by VC " << req.label
+		 << " with priority " << req.in_pri
+		 << " (pri: " << prio
+		 << ")." << endl;
+    }
+    return false;
+  }
+  if(T::watch && f->watch) {
+    *gWatchOut << GetSimTime() << " | " << FullName() << " | "
+	       << "  Requesting output " << output
+	       << "." << (expanded_output % output_speedup)
+	       << " (" << ((cur_buf->GetState(vc) == VC::active) ? 
+			   "non-spec" : 
+			   "spec")
+	       << ", pri: " << prio
+	       << ")." << endl;
+  }
+  allocator->AddRequest(expanded_input, expanded_output, vc, prio, prio);
+  return true;
+}
+
+template<class T>
 void IQRouter::_SWAllocEvaluate( )
 {
+  bool const speculative = T::speculative && _speculative;
+  bool const noq = T::noq && _noq;
+  int const input_speedup = T::unit_speedup ? 1 : _input_speedup;
+  int const output_speedup = T::unit_speedup ? 1 : _output_speedup;
+  typename T::tVCAlloc * const vc_allocator
+    = static_cast<typename T::tVCAlloc *>(_vc_allocator);
+  typename T::tSWAlloc * const sw_allocator
+    = static_cast<typename T::tSWAlloc *>(_sw_allocator);
+
   bool watched = false;
 
-  for(deque<pair<int, pair<pair<int, int>, int> > >::iterator iter = _sw_alloc_vcs.begin();
+  for(RingQueue<pair<int, pair<pair<int, int>, int> > >::iterator iter = _sw_alloc_vcs.begin();
       iter != _sw_alloc_vcs.end();
       ++iter) {
 
@@ -1401,18 +1634,18 @@ void IQRouter::_SWAllocEvaluate( )
     
     assert(iter->second.second == -1);
 
-    assert(_switch_hold_vc[input * _input_speedup + vc % _input_speedup] != vc);
+    assert(_switch_hold_vc[input * input_speedup + vc % input_speedup] != vc);
 
     Buffer const * const cur_buf = _buf[input];
     assert(!cur_buf->Empty(vc));
     assert((cur_buf->GetState(vc) == VC::active) || 
-	   (_speculative && (cur_buf->GetState(vc) == VC::vc_alloc)));
+	   (speculative && (cur_buf->GetState(vc) == VC::vc_alloc)));
     
     Flit const * const f = cur_buf->FrontFlit(vc);
     assert(f);
     assert(f->vc == vc);
 
-    if(f->watch) {
+    if(T::watch && f->watch) {
       *gWatchOut << GetSimTime() << " | " << FullName() << " | " 
 		 << "Beginning switch allocation for VC " << vc
 		 << " at input " << input
@@ -1430,7 +1663,7 @@ void IQRouter::_SWAllocEvaluate( )
       BufferState const * const dest_buf = _next_buf[dest_output];
       
       if(dest_buf->IsFullFor(dest_vc) || ( _output_buffer_size!=-1  && _output_buffer[dest_output].size()>=(size_t)(_output_buffer_size))) {
-	if(f->watch) {
+	if(T::watch && f->watch) {
 	  *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		     << "  VC " << dest_vc 
 		     << " at output " << dest_output 
@@ -1439,11 +1672,11 @@ void IQRouter::_SWAllocEvaluate( )
 	iter->second.second = dest_buf->IsFull() ? STALL_BUFFER_FULL : STALL_BUFFER_RESERVED;
 	continue;
       }
-      bool const requested = _SWAllocAddReq(input, vc, dest_output);
+      bool const requested = _SWAllocAddReq<T>(input, vc, dest_output);
       watched |= requested && f->watch;
       continue;
     }
-    assert(_speculative && (cur_buf->GetState(vc) == VC::vc_alloc));
+    assert(speculative && (cur_buf->GetState(vc) == VC::vc_alloc));
     assert(f->head);
       
     // The following models the speculative VC allocation aspects of the 
@@ -1454,11 +1687,11 @@ void IQRouter::_SWAllocEvaluate( )
     OutputSet const * const route_set = cur_buf->GetRouteSet(vc);
     assert(route_set);
     
-    set<OutputSet::sSetElement> const setlist = route_set->GetSet();
+    OutputSet const & setlist = route_set->GetSet();
     
-    assert(!_noq || (setlist.size() == 1));
+    assert(!noq || (setlist.size() == 1));
 
-    for(set<OutputSet::sSetElement>::const_iterator iset = setlist.begin();
+    for(OutputSet::const_iterator iset = setlist.begin();
 	iset != setlist.end();
 	++iset) {
       
@@ -1481,7 +1714,7 @@ void IQRouter::_SWAllocEvaluate( )
 	int vc_start;
 	int vc_end;
 	
-	if(_noq && _noq_next_output_port[input][vc] >= 0) {
+	if(noq && _noq_next_output_port[input][vc] >= 0) {
 	  assert(!_routing_delay);
 	  vc_start = _noq_next_vc_start[input][vc];
 	  vc_end = _noq_next_vc_end[input][vc];
@@ -1507,49 +1740,49 @@ void IQRouter::_SWAllocEvaluate( )
       }
       
       if(_spec_check_elig && !elig) {
-	if(f->watch) {
+	if(T::watch && f->watch) {
 	  *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		     << "  Output " << dest_output 
 		     << " has no suitable VCs available." << endl;
 	}
 	iter->second.second = STALL_BUFFER_BUSY;
       } else if(_spec_check_cred && !cred) {
-	if(f->watch) {
+	if(T::watch && f->watch) {
 	  *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		     << "  All suitable VCs at output " << dest_output 
 		     << " are full." << endl;
 	}
 	iter->second.second = dest_buf->IsFull() ? STALL_BUFFER_FULL : STALL_BUFFER_RESERVED;
       } else {
-	bool const requested = _SWAllocAddReq(input, vc, dest_output);
+	bool const requested = _SWAllocAddReq<T>(input, vc, dest_output);
 	watched |= requested && f->watch;
       }
     }
   }
   
-  if(watched) {
-    *gWatchOut << GetSimTime() << " | " << _sw_allocator->FullName() << " | ";
-    _sw_allocator->PrintRequests(gWatchOut);
-    if(_spec_sw_allocator) {
+  if(T::watch && watched) {
+    *gWatchOut << GetSimTime() << " | " << sw_allocator->FullName() << " | ";
+    sw_allocator->PrintRequests(gWatchOut);
+    if(T::speculative && _spec_sw_allocator) {
       *gWatchOut << GetSimTime() << " | " << _spec_sw_allocator->FullName() << " | ";
       _spec_sw_allocator->PrintRequests(gWatchOut);
     }
   }
   
-  _sw_allocator->Allocate();
-  if(_spec_sw_allocator)
+  sw_allocator->Allocate();
+  if(T::speculative && _spec_sw_allocator)
     _spec_sw_allocator->Allocate();
   
-  if(watched) {
-    *gWatchOut << GetSimTime() << " | " << _sw_allocator->FullName() << " | ";
-    _sw_allocator->PrintGrants(gWatchOut);
-    if(_spec_sw_allocator) {
+  if(T::watch && watched) {
+    *gWatchOut << GetSimTime() << " | " << sw_allocator->FullName() << " | ";
+    sw_allocator->PrintGrants(gWatchOut);
+    if(T::speculative && _spec_sw_allocator) {
       *gWatchOut << GetSimTime() << " | " << _spec_sw_allocator->FullName() << " | ";
       _spec_sw_allocator->PrintGrants(gWatchOut);
     }
   }
   
-  for(deque<pair<int, pair<pair<int, int>, int> > >::iterator iter = _sw_alloc_vcs.begin();
+  for(RingQueue<pair<int, pair<pair<int, int>, int> > >::iterator iter = _sw_alloc_vcs.begin();
       iter != _sw_alloc_vcs.end();
       ++iter) {
 
@@ -1573,33 +1806,33 @@ void IQRouter::_SWAllocEvaluate( )
     Buffer const * const cur_buf = _buf[input];
     assert(!cur_buf->Empty(vc));
     assert((cur_buf->GetState(vc) == VC::active) || 
-	   (_speculative && (cur_buf->GetState(vc) == VC::vc_alloc)));
+	   (speculative && (cur_buf->GetState(vc) == VC::vc_alloc)));
     
     Flit const * const f = cur_buf->FrontFlit(vc);
     assert(f);
     assert(f->vc == vc);
 
-    int const expanded_input = input * _input_speedup + vc % _input_speedup;
+    int const expanded_input = input * input_speedup + vc % input_speedup;
 
-    int expanded_output = _sw_allocator->OutputAssigned(expanded_input);
+    int expanded_output = sw_allocator->OutputAssigned(expanded_input);
 
     if(expanded_output >= 0) {
-      assert((expanded_output % _output_speedup) == (input % _output_speedup));
-      int const granted_vc = _sw_allocator->ReadRequest(expanded_input, expanded_output);
+      assert((expanded_output % output_speedup) == (input % output_speedup));
+      int const granted_vc = sw_allocator->ReadRequest(expanded_input, expanded_output);
       if(granted_vc == vc) {
-	if(f->watch) {
+	if(T::watch && f->watch) {
 	  *gWatchOut << GetSimTime() << " | " << FullName() << " | "
-		     << "Assigning output " << (expanded_output / _output_speedup)
-		     << "." << (expanded_output % _output_speedup)
+		     << "Assigning output " << (expanded_output / output_speedup)
+		     << "." << (expanded_output % output_speedup)
 		     << " to VC " << vc
 		     << " at input " << input
-		     << "." << (vc % _input_speedup)
+		     << "." << (vc % input_speedup)
 		     << "." << endl;
 	}
-	_sw_rr_offset[expanded_input] = (vc + _input_speedup) % _vcs;
+	_sw_rr_offset[expanded_input] = (vc + input_speedup) % _vcs;
 	iter->second.second = expanded_output;
       } else {
-	if(f->watch) {
+	if(T::watch && f->watch) {
 	  *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		     << "Switch allocation failed for VC " << vc
 		     << " at input " << input
@@ -1607,31 +1840,31 @@ void IQRouter::_SWAllocEvaluate( )
 	}
 	iter->second.second = STALL_CROSSBAR_CONFLICT;
       }
-    } else if(_spec_sw_allocator) {
+    } else if(T::speculative && _spec_sw_allocator) {
       expanded_output = _spec_sw_allocator->OutputAssigned(expanded_input);
       if(expanded_output >= 0) {
-	assert((expanded_output % _output_speedup) == (input % _output_speedup));
+	assert((expanded_output % output_speedup) == (input % output_speedup));
 	if(_spec_mask_by_reqs && 
-	   _sw_allocator->OutputHasRequests(expanded_output)) {
-	  if(f->watch) {
+	   sw_allocator->OutputHasRequests(expanded_output)) {
+	  if(T::watch && f->watch) {
 	    *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		       << "Discarding speculative grant for VC " << vc
 		       << " at input " << input
-		       << "." << (vc % _input_speedup)
-		       << " because output " << (expanded_output / _output_speedup)
-		       << "." << (expanded_output % _output_speedup)
+		       << "." << (vc % input_speedup)
+		       << " because output " << (expanded_output / output_speedup)
+		       << "." << (expanded_output % output_speedup)
 		       << " has non-speculative requests." << endl;
 	  }
 	  iter->second.second = STALL_CROSSBAR_CONFLICT;
 	} else if(!_spec_mask_by_reqs &&
-		  (_sw_allocator->InputAssigned(expanded_output) >= 0)) {
-	  if(f->watch) {
+		  (sw_allocator->InputAssigned(expanded_output) >= 0)) {
+	  if(T::watch && f->watch) {
 	    *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		       << "Discarding speculative grant for VC " << vc
 		       << " at input " << input
-		       << "." << (vc % _input_speedup)
-		       << " because output " << (expanded_output / _output_speedup)
-		       << "." << (expanded_output % _output_speedup)
+		       << "." << (vc % input_speedup)
+		       << " because output " << (expanded_output / output_speedup)
+		       << "." << (expanded_output % output_speedup)
 		       << " has a non-speculative grant." << endl;
 	  }
 	  iter->second.second = STALL_CROSSBAR_CONFLICT;
@@ -1639,19 +1872,19 @@ void IQRouter::_SWAllocEvaluate( )
 	  int const granted_vc = _spec_sw_allocator->ReadRequest(expanded_input, 
 								 expanded_output);
 	  if(granted_vc == vc) {
-	    if(f->watch) {
+	    if(T::watch && f->watch) {
 	      *gWatchOut << GetSimTime() << " | " << FullName() << " | "
-			 << "Assigning output " << (expanded_output / _output_speedup)
-			 << "." << (expanded_output % _output_speedup)
+			 << "Assigning output " << (expanded_output / output_speedup)
+			 << "." << (expanded_output % output_speedup)
 			 << " to VC " << vc
 			 << " at input " << input
-			 << "." << (vc % _input_speedup)
+			 << "." << (vc % input_speedup)
 			 << "." << endl;
 	    }
-	    _sw_rr_offset[expanded_input] = (vc + _input_speedup) % _vcs;
+	    _sw_rr_offset[expanded_input] = (vc + input_speedup) % _vcs;
 	    iter->second.second = expanded_output;
 	  } else {
-	    if(f->watch) {
+	    if(T::watch && f->watch) {
 	      *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 			 << "Switch allocation failed for VC " << vc
 			 << " at input " << input
@@ -1662,7 +1895,7 @@ void IQRouter::_SWAllocEvaluate( )
 	}
       } else {
 
-	if(f->watch) {
+	if(T::watch && f->watch) {
 	  *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		     << "Switch allocation failed for VC " << vc
 		     << " at input " << input
@@ -1674,7 +1907,7 @@ void IQRouter::_SWAllocEvaluate( )
       }
     } else {
       
-      if(f->watch) {
+      if(T::watch && f->watch) {
 	*gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		   << "Switch allocation failed for VC " << vc
 		   << " at input " << input
@@ -1686,11 +1919,11 @@ void IQRouter::_SWAllocEvaluate( )
     }
   }
   
-  if(!_speculative && (_sw_alloc_delay <= 1)) {
+  if(!speculative && (_sw_alloc_delay <= 1)) {
     return;
   }
 
-  for(deque<pair<int, pair<pair<int, int>, int> > >::iterator iter = _sw_alloc_vcs.begin();
+  for(RingQueue<pair<int, pair<pair<int, int>, int> > >::iterator iter = _sw_alloc_vcs.begin();
       iter != _sw_alloc_vcs.end();
       ++iter) {
 
@@ -1706,24 +1939,24 @@ void IQRouter::_SWAllocEvaluate( )
     
     if(expanded_output >= 0) {
       
-      int const output = expanded_output / _output_speedup;
+      int const output = expanded_output / output_speedup;
       assert((output >= 0) && (output < _outputs));
       
       BufferState const * const dest_buf = _next_buf[output];
       
       int const input = iter->second.first.first;
       assert((input >= 0) && (input < _inputs));
-      assert((input % _output_speedup) == (expanded_output % _output_speedup));
+      assert((input % output_speedup) == (expanded_output % output_speedup));
       int const vc = iter->second.first.second;
       assert((vc >= 0) && (vc < _vcs));
       
-      int const expanded_input = input * _input_speedup + vc % _input_speedup;
+      int const expanded_input = input * input_speedup + vc % input_speedup;
       assert(_switch_hold_vc[expanded_input] != vc);
       
       Buffer const * const cur_buf = _buf[input];
       assert(!cur_buf->Empty(vc));
       assert((cur_buf->GetState(vc) == VC::active) ||
-	     (_speculative && (cur_buf->GetState(vc) == VC::vc_alloc)));
+	     (speculative && (cur_buf->GetState(vc) == VC::vc_alloc)));
       
       Flit const * const f = cur_buf->FrontFlit(vc);
       assert(f);
@@ -1731,12 +1964,12 @@ void IQRouter::_SWAllocEvaluate( )
 
       if((_switch_hold_in[expanded_input] >= 0) ||
 	 (_switch_hold_out[expanded_output] >= 0)) {
-	if(f->watch) {
+	if(T::watch && f->watch) {
 	  *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		     << "Discarding grant from input " << input
-		     << "." << (vc % _input_speedup)
+		     << "." << (vc % input_speedup)
 		     << " to output " << output
-		     << "." << (expanded_output % _output_speedup)
+		     << "." << (expanded_output % output_speedup)
 		     << " due to conflict with held connection at ";
 	  if(_switch_hold_in[expanded_input] >= 0) {
 	    *gWatchOut << "input";
@@ -1751,43 +1984,43 @@ void IQRouter::_SWAllocEvaluate( )
 	  *gWatchOut << "." << endl;
 	}
 	iter->second.second = STALL_CROSSBAR_CONFLICT;
-      } else if(_speculative && (cur_buf->GetState(vc) == VC::vc_alloc)) {
+      } else if(speculative && (cur_buf->GetState(vc) == VC::vc_alloc)) {
 
 	assert(f->head);
 
-	if(_vc_allocator) { // separate VC and switch allocators
+	if(vc_allocator) { // separate VC and switch allocators
 
 	  int const input_and_vc = 
 	    _vc_shuffle_requests ? (vc*_inputs + input) : (input*_vcs + vc);
-	  int const output_and_vc = _vc_allocator->OutputAssigned(input_and_vc);//获取_in_match中和input_and_vc相匹配的output_and_vc
+	  int const output_and_vc = vc_allocator->OutputAssigned(input_and_vc);//获取_in_match中和input_and_vc相匹配的output_and_vc
 
 	  if(output_and_vc < 0) {
-	    if(f->watch) {
+	    if(T::watch && f->watch) {
 	      *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 			 << "Discarding grant from input " << input
-			 << "." << (vc % _input_speedup)
+			 << "." << (vc % input_speedup)
 			 << " to output " << output
-			 << "." << (expanded_output % _output_speedup)
+			 << "." << (expanded_output % output_speedup)
 			 << " due to misspeculation." << endl;
 	    }
 	    iter->second.second = -1; // stall is counted in VC allocation path!
 	  } else if((output_and_vc / _vcs) != output) {
-	    if(f->watch) {
+	    if(T::watch && f->watch) {
 	      *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 			 << "Discarding grant from input " << input
-			 << "." << (vc % _input_speedup)
+			 << "." << (vc % input_speedup)
 			 << " to output " << output
-			 << "." << (expanded_output % _output_speedup)
+			 << "." << (expanded_output % output_speedup)
 			 << " due to port mismatch between VC and switch allocator." << endl;
 	    }
 	    iter->second.second = STALL_BUFFER_CONFLICT; // count this case as if we had failed allocation
 	  } else if(dest_buf->IsFullFor((output_and_vc % _vcs))) {
-	    if(f->watch) {
+	    if(T::watch && f->watch) {
 	      *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 			 << "Discarding grant from input " << input
-			 << "." << (vc % _input_speedup)
+			 << "." << (vc % input_speedup)
 			 << " to output " << output
-			 << "." << (expanded_output % _output_speedup)
+			 << "." << (expanded_output % output_speedup)
 			 << " due to lack of credit." << endl;
 	    }
 	    iter->second.second = dest_buf->IsFull() ? STALL_BUFFER_FULL : STALL_BUFFER_RESERVED;
@@ -1798,15 +2031,15 @@ void IQRouter::_SWAllocEvaluate( )
 	  OutputSet const * const route_set = cur_buf->GetRouteSet(vc);
 	  assert(route_set);
 
-	  set<OutputSet::sSetElement> const setlist = route_set->GetSet();
+	  OutputSet const & setlist = route_set->GetSet();
 
 	  bool busy = true;
 	  bool full = true;
 	  bool reserved = false;
 
-	  assert(!_noq || (setlist.size() == 1));
+	  assert(!noq || (setlist.size() == 1));
 
-	  for(set<OutputSet::sSetElement>::const_iterator iset = setlist.begin();
+	  for(OutputSet::const_iterator iset = setlist.begin();
 	      iset != setlist.end();
 	      ++iset) {
 	    if(iset->output_port == output) {
@@ -1814,7 +2047,7 @@ void IQRouter::_SWAllocEvaluate( )
 	      int vc_start;
 	      int vc_end;
 	      
-	      if(_noq && _noq_next_output_port[input][vc] >= 0) {
+	      if(noq && _noq_next_output_port[input][vc] >= 0) {
 		assert(!_routing_delay);
 		vc_start = _noq_next_vc_start[input][vc];
 		vc_end = _noq_next_vc_end[input][vc];
@@ -1845,22 +2078,22 @@ void IQRouter::_SWAllocEvaluate( )
 	  }
 
 	  if(busy) {
-	    if(f->watch) {
+	    if(T::watch && f->watch) {
 	      *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 			 << "Discarding grant from input " << input
-			 << "." << (vc % _input_speedup)
+			 << "." << (vc % input_speedup)
 			 << " to output " << output
-			 << "." << (expanded_output % _output_speedup)
+			 << "." << (expanded_output % output_speedup)
 			 << " because no suitable output VC for piggyback allocation is available." << endl;
 	    }
 	    iter->second.second = STALL_BUFFER_BUSY;
 	  } else if(full) {
-	    if(f->watch) {
+	    if(T::watch && f->watch) {
 	      *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 			 << "Discarding grant from input " << input
-			 << "." << (vc % _input_speedup)
+			 << "." << (vc % input_speedup)
 			 << " to output " << output
-			 << "." << (expanded_output % _output_speedup)
+			 << "." << (expanded_output % output_speedup)
 			 << " because all suitable output VCs for piggyback allocation are full." << endl;
 	    }
 	    iter->second.second = reserved ? STALL_BUFFER_RESERVED : STALL_BUFFER_FULL;
@@ -1875,12 +2108,12 @@ void IQRouter::_SWAllocEvaluate( )
 	assert((match_vc >= 0) && (match_vc < _vcs));
 
 	if(dest_buf->IsFullFor(match_vc)) {
-	  if(f->watch) {
+	  if(T::watch && f->watch) {
 	    *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		       << "  Discarding grant from input " << input
-		       << "." << (vc % _input_speedup)
+		       << "." << (vc % input_speedup)
 		       << " to output " << output
-		       << "." << (expanded_output % _output_speedup)
+		       << "." << (expanded_output % output_speedup)
 		       << " due to lack of credit." << endl;
 	  }
 	  iter->second.second = dest_buf->IsFull() ? STALL_BUFFER_FULL : STALL_BUFFER_RESERVED;
@@ -1890,8 +2123,17 @@ void IQRouter::_SWAllocEvaluate( )
   }
 }
 
+template<class T>
 void IQRouter::_SWAllocUpdate( int subnet, TrafficManager * trafficmanager)
 {
+  bool const speculative = T::speculative && _speculative;
+  bool const hold_switch = T::hold_switch && _hold_switch_for_packet;
+  bool const noq = T::noq && _noq;
+  int const input_speedup = T::unit_speedup ? 1 : _input_speedup;
+  int const output_speedup = T::unit_speedup ? 1 : _output_speedup;
+  typename T::tVCAlloc * const vc_allocator
+    = static_cast<typename T::tVCAlloc *>(_vc_allocator);
+
   while(!_sw_alloc_vcs.empty()) {
 
     pair<int, pair<pair<int, int>, int> > const & item = _sw_alloc_vcs.front();
@@ -1910,13 +2152,13 @@ void IQRouter::_SWAllocUpdate( int subnet, TrafficManager * trafficmanager)
     Buffer * const cur_buf = _buf[input];
     assert(!cur_buf->Empty(vc));
     assert((cur_buf->GetState(vc) == VC::active) ||
-	   (_speculative && (cur_buf->GetState(vc) == VC::vc_alloc)));
+	   (speculative && (cur_buf->GetState(vc) == VC::vc_alloc)));
     
     Flit * const f = cur_buf->FrontFlit(vc);
     assert(f);
     assert(f->vc == vc);
 
-    if(f->watch) {
+    if(T::watch && f->watch) {
       *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		 << "Completed switch allocation for VC " << vc
 		 << " at input " << input
@@ -1928,12 +2170,12 @@ void IQRouter::_SWAllocUpdate( int subnet, TrafficManager * trafficmanager)
     
     if(expanded_output >= 0) {
       
-      int const expanded_input = input * _input_speedup + vc % _input_speedup;
+      int const expanded_input = input * input_speedup + vc % input_speedup;
       assert(_switch_hold_vc[expanded_input] < 0);
       assert(_switch_hold_in[expanded_input] < 0);
       assert(_switch_hold_out[expanded_output] < 0);
 
-      int const output = expanded_output / _output_speedup;
+      int const output = expanded_output / output_speedup;
       assert((output >= 0) && (output < _outputs));
 
       BufferState * const dest_buf = _next_buf[output];
@@ -1943,11 +2185,11 @@ void IQRouter::_SWAllocUpdate( int subnet, TrafficManager * trafficmanager)
       }
       int match_vc;
 
-      if(!_vc_allocator && (cur_buf->GetState(vc) == VC::vc_alloc)) {
+      if(!vc_allocator && (cur_buf->GetState(vc) == VC::vc_alloc)) {
 
 	assert(f->head);
 
-	int const cl = f->cl;
+	int const cl = f->packet->cl;
 	assert((cl >= 0) && (cl < _classes));
 
 	int const vc_offset = _vc_rr_offset[output*_classes+cl];
@@ -1956,11 +2198,11 @@ void IQRouter::_SWAllocUpdate( int subnet, TrafficManager * trafficmanager)
 	int match_prio = numeric_limits<int>::min();
 
 	const OutputSet * route_set = cur_buf->GetRouteSet(vc);
-	set<OutputSet::sSetElement> const setlist = route_set->GetSet();
+	OutputSet const & setlist = route_set->GetSet();
 	
-	assert(!_noq || (setlist.size() == 1));
+	assert(!noq || (setlist.size() == 1));
 	
-	for(set<OutputSet::sSetElement>::const_iterator iset = setlist.begin();
+	for(OutputSet::const_iterator iset = setlist.begin();
 	    iset != setlist.end();
 	    ++iset) {
 	  if(iset->output_port == output) {
@@ -1968,7 +2210,7 @@ void IQRouter::_SWAllocUpdate( int subnet, TrafficManager * trafficmanager)
 	    int vc_start;
 	    int vc_end;
 	    
-	    if(_noq && _noq_next_output_port[input][vc] >= 0) {
+	    if(noq && _noq_next_output_port[input][vc] >= 0) {
 	      assert(!_routing_delay);
 	      vc_start = _noq_next_vc_start[input][vc];
 	      vc_end = _noq_next_vc_end[input][vc];
@@ -2006,7 +2248,7 @@ void IQRouter::_SWAllocUpdate( int subnet, TrafficManager * trafficmanager)
 	}
 	assert(match_vc >= 0);
 
-	if(f->watch) {
+	if(T::watch && f->watch) {
 	  *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		     << "  Allocating VC " << match_vc
 		     << " at output " << output
@@ -2028,20 +2270,20 @@ void IQRouter::_SWAllocUpdate( int subnet, TrafficManager * trafficmanager)
       }
       assert((match_vc >= 0) && (match_vc < _vcs));
 
-      if(f->watch) {
+      if(T::watch && f->watch) {
 	*gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		   << "  Scheduling switch connection from input " << input
-		   << "." << (vc % _input_speedup)
+		   << "." << (vc % input_speedup)
 		   << " to output " << output
-		   << "." << (expanded_output % _output_speedup)
+		   << "." << (expanded_output % output_speedup)
 		   << "." << endl;
       }
 
       cur_buf->RemoveFlit(vc);
 
 #ifdef TRACK_FLOWS
-      --_stored_flits[f->cl][input];
-      if(f->tail) --_active_packets[f->cl][input];
+      --_stored_flits[f->packet->cl][input];
+      if(f->tail) --_active_packets[f->packet->cl][input];
 #endif
 
       _bufferMonitor->read(input, f) ;
@@ -2053,8 +2295,8 @@ void IQRouter::_SWAllocUpdate( int subnet, TrafficManager * trafficmanager)
 	const FlitChannel * channel = _output_channels[output];
 	const Router * router = channel->GetSink();
 	if(router) {
-	  if(_noq) {
-	    if(f->watch) {
+	  if(noq) {
+	    if(T::watch && f->watch) {
 	      *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 			 << "Updating lookahead routing information for flit " << f->id
 			 << " (NOQ)." << endl;
@@ -2068,35 +2310,35 @@ void IQRouter::_SWAllocUpdate( int subnet, TrafficManager * trafficmanager)
 	    int next_vc_end = _noq_next_vc_end[input][vc];
 	    assert(next_vc_end >= 0 && next_vc_end < _vcs);
 	    _noq_next_vc_end[input][vc] = -1;
-	    f->la_route_set.Clear();
-	    f->la_route_set.AddRange(next_output_port, next_vc_start, next_vc_end);
+	    f->packet->la_route_set.Clear();
+	    f->packet->la_route_set.AddRange(next_output_port, next_vc_start, next_vc_end);
 	  } else {
-	    if(f->watch) {
+	    if(T::watch && f->watch) {
 	      *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 			 << "Updating lookahead routing information for flit " << f->id
 			 << "." << endl;
 	    }
 	    int in_channel = channel->GetSinkPort();
-	    _rf(router, f, in_channel, &f->la_route_set, false);
+	    _rf(router, f, in_channel, &f->packet->la_route_set, false);
 	  }
 	} else {
-	  f->la_route_set.Clear();
+	  f->packet->la_route_set.Clear();
 	}
       }
 
 #ifdef TRACK_FLOWS
-      ++_outstanding_credits[f->cl][output];
-      _outstanding_classes[output][f->vc].push(f->cl);
+      ++_outstanding_credits[f->packet->cl][output];
+      _outstanding_classes[output][f->vc].push(f->packet->cl);
 #endif
 
       dest_buf->SendingFlit(f);
 
       _crossbar_flits.push_back(make_pair(-1, make_pair(f, make_pair(expanded_input, expanded_output))));
 
-      if(_out_queue_credits.count(input) == 0) {
-	_out_queue_credits.insert(make_pair(input, Credit::New()));
+      if(!_out_queue_credits[input]) {
+	_out_queue_credits[input] = Credit::New();
       }
-      _out_queue_credits.find(input)->second->vc.insert(vc);
+      _out_queue_credits[input]->vc.Insert(vc);
 
       if(cur_buf->Empty(vc)) {
 	if(f->tail) {
@@ -2127,36 +2369,36 @@ void IQRouter::_SWAllocUpdate( int subnet, TrafficManager * trafficmanager)
 	    cur_buf->SetState(vc, VC::routing);
 	    _route_vcs.push_back(make_pair(-1, item.second.first));
 	  } else {
-	    if(nf->watch) {
+	    if(T::watch && nf->watch) {
 	      *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 			 << "Using precomputed lookahead routing information for VC " << vc
 			 << " at input " << input
 			 << " (front: " << nf->id
 			 << ")." << endl;
 	    }
-	    cur_buf->SetRouteSet(vc, &nf->la_route_set);
+	    cur_buf->SetRouteSet(vc, &nf->packet->la_route_set);
 	    cur_buf->SetState(vc, VC::vc_alloc);
-	    if(_speculative) {
+	    if(speculative) {
 	      _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first,
 							      -1)));
 	    }
-	    if(_vc_allocator) {
+	    if(vc_allocator) {
 	      _vc_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first,
 							      -1)));
 	    }
-	    if(_noq) {
+	    if(noq) {
 	      _UpdateNOQ(input, vc, nf);
 	    }
 	  }
 	} else {
-	  if(_hold_switch_for_packet) {
-	    if(f->watch) {
+	  if(hold_switch) {
+	    if(T::watch && f->watch) {
 	      *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 			 << "Setting up switch hold for VC " << vc
 			 << " at input " << input
-			 << "." << (expanded_input % _input_speedup)
+			 << "." << (expanded_input % input_speedup)
 			 << " to output " << output
-			 << "." << (expanded_output % _output_speedup)
+			 << "." << (expanded_output % output_speedup)
 			 << "." << endl;
 	    }
 	    _switch_hold_vc[expanded_input] = vc;
@@ -2171,7 +2413,7 @@ void IQRouter::_SWAllocUpdate( int subnet, TrafficManager * trafficmanager)
 	}
       }
     } else {
-      if(f->watch) {
+      if(T::watch && f->watch) {
 	*gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		   << "  No output port allocated." << endl;
       }
@@ -2184,15 +2426,15 @@ void IQRouter::_SWAllocUpdate( int subnet, TrafficManager * trafficmanager)
 	     (expanded_output == STALL_BUFFER_RESERVED) ||
 	     (expanded_output == STALL_CROSSBAR_CONFLICT));
       if(expanded_output == STALL_BUFFER_BUSY) {
-	++_buffer_busy_stalls[f->cl];
+	++_buffer_busy_stalls[f->packet->cl];
       } else if(expanded_output == STALL_BUFFER_CONFLICT) {
-	++_buffer_conflict_stalls[f->cl];
+	++_buffer_conflict_stalls[f->packet->cl];
       } else if(expanded_output == STALL_BUFFER_FULL) {
-	++_buffer_full_stalls[f->cl];
+	++_buffer_full_stalls[f->packet->cl];
       } else if(expanded_output == STALL_BUFFER_RESERVED) {
-	++_buffer_reserved_stalls[f->cl];
+	++_buffer_reserved_stalls[f->packet->cl];
       } else if(expanded_output == STALL_CROSSBAR_CONFLICT) {
-	++_crossbar_conflict_stalls[f->cl];
+	++_crossbar_conflict_stalls[f->packet->cl];
       }
 #endif
 
@@ -2207,9 +2449,13 @@ void IQRouter::_SWAllocUpdate( int subnet, TrafficManager * trafficmanager)
 // switch traversal
 //------------------------------------------------------------------------------
 
+template<class T>
 void IQRouter::_SwitchEvaluate( )
 {
-  for(deque<pair<int, pair<Flit *, pair<int, int> > > >::iterator iter = _crossbar_flits.begin();
+  int const input_speedup = T::unit_speedup ? 1 : _input_speedup;
+  int const output_speedup = T::unit_speedup ? 1 : _output_speedup;
+
+  for(RingQueue<pair<int, pair<Flit *, pair<int, int> > > >::iterator iter = _crossbar_flits.begin();
       iter != _crossbar_flits.end();
       ++iter) {
     
@@ -2225,20 +2471,24 @@ void IQRouter::_SwitchEvaluate( )
     int const expanded_input = iter->second.second.first;
     int const expanded_output = iter->second.second.second;
       
-    if(f->watch) {
+    if(T::watch && f->watch) {
       *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		 << "Beginning crossbar traversal for flit " << f->id
-		 << " from input " << (expanded_input / _input_speedup)
-		 << "." << (expanded_input % _input_speedup)
-		 << " to output " << (expanded_output / _output_speedup)
-		 << "." << (expanded_output % _output_speedup)
+		 << " from input " << (expanded_input / input_speedup)
+		 << "." << (expanded_input % input_speedup)
+		 << " to output " << (expanded_output / output_speedup)
+		 << "." << (expanded_output % output_speedup)
 		 << "." << endl;
     }
   }
 }
 
+template<class T>
 void IQRouter::_SwitchUpdate( )
 {
+  int const input_speedup = T::unit_speedup ? 1 : _input_speedup;
+  int const output_speedup = T::unit_speedup ? 1 : _output_speedup;
+
   while(!_crossbar_flits.empty()) {
 
     pair<int, pair<Flit *, pair<int, int> > > const & item = _crossbar_flits.front();
@@ -2253,36 +2503,36 @@ void IQRouter::_SwitchUpdate( )
     assert(f);
 
     int const expanded_input = item.second.second.first;
-    int const input = expanded_input / _input_speedup;
+    int const input = expanded_input / input_speedup;
     assert((input >= 0) && (input < _inputs));
     int const expanded_output = item.second.second.second;
-    int const output = expanded_output / _output_speedup;
+    int const output = expanded_output / output_speedup;
     assert((output >= 0) && (output < _outputs));
 //这个周期与_SWAllocUdpate一样
     for (int output = 0; output < _outputs - 1; ++output) {
       _next_buf[output]->nextBufWithoutHeadFlit();
     }
-    if(f->watch) {
+    if(T::watch && f->watch) {
       *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		 << "Completed crossbar traversal for flit " << f->id
 		 << " from input " << input
-		 << "." << (expanded_input % _input_speedup)
+		 << "." << (expanded_input % input_speedup)
 		 << " to output " << output
-		 << "." << (expanded_output % _output_speedup)
+		 << "." << (expanded_output % output_speedup)
 		 << "." << endl;
     }
     _switchMonitor->traversal(input, output, f) ;
 
-    if(f->watch) {
+    if(T::watch && f->watch) {
       *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		 << "Buffering flit " << f->id
 		 << " at output " << output
 		 << "." << endl;
     }
-    _output_buffer[output].push(f);
+    _output_buffer[output].push_back(f);
     //the output buffer size isn't precise due to flits in flight
     //but there is a maximum bound based on output speed up and ST traversal
-    assert(_output_buffer[output].size()<=(size_t)_output_buffer_size+ _crossbar_delay* _output_speedup+( _output_speedup-1) ||_output_buffer_size==-1);
+    assert(_output_buffer[output].size()<=(size_t)_output_buffer_size+ _crossbar_delay* output_speedup+( output_speedup-1) ||_output_buffer_size==-1);
     _crossbar_flits.pop_front();
   }
 }
@@ -2294,20 +2544,17 @@ void IQRouter::_SwitchUpdate( )
 
 void IQRouter::_OutputQueuing( )
 {
-  for(map<int, Credit *>::const_iterator iter = _out_queue_credits.begin();
-      iter != _out_queue_credits.end();
-      ++iter) {
-
-    int const input = iter->first;
-    assert((input >= 0) && (input < _inputs));
+  for(int input = 0; input < _inputs; ++input) {
 
-    Credit * const c = iter->second;
-    assert(c);
-    assert(!c->vc.empty());
+    Credit * const c = _out_queue_credits[input];
+    if(!c) {
+      continue;
+    }
+    assert(!c->vc.Empty());
 
-    _credit_buffer[input].push(c);
+    _credit_buffer[input].push_back(c);
+    _out_queue_credits[input] = NULL;
   }
-  _out_queue_credits.clear();
 }
 
 //------------------------------------------------------------------------------
@@ -2320,10 +2567,10 @@ void IQRouter::_SendFlits( )
     if ( !_output_buffer[output].empty( ) ) {
       Flit * const f = _output_buffer[output].front( );
       assert(f);
-      _output_buffer[output].pop( );
+      _output_buffer[output].pop_front( );
 
 #ifdef TRACK_FLOWS
-      ++_sent_flits[f->cl][output];
+      ++_sent_flits[f->packet->cl][output];
 #endif
 
       if(f->watch)
@@ -2345,7 +2592,7 @@ void IQRouter::_SendCredits( )
     if ( !_credit_buffer[input].empty( ) ) {
       Credit * const c = _credit_buffer[input].front( );
       assert(c);
-      _credit_buffer[input].pop( );
+      _credit_buffer[input].pop_front( );
       _input_credits[input]->Send( c );
     }
   }
@@ -2428,7 +2675,7 @@ void IQRouter::_UpdateNOQ(int input, int vc, Flit const * f) {
   assert(f);
   assert(f->vc == vc);
   assert(f->head);
-  set<OutputSet::sSetElement> sl = f->la_route_set.GetSet();
+  OutputSet const & sl = f->packet->la_route_set.GetSet();
   assert(sl.size() == 1);
   int out_port = sl.begin()->output_port;
   const FlitChannel * channel = _output_channels[out_port];
@@ -2437,9 +2684,9 @@ void IQRouter::_UpdateNOQ(int input, int vc, Flit const * f) {
     int in_channel = channel->GetSinkPort();
     OutputSet nos;
     _rf(router, f, in_channel, &nos, false);
-    sl = nos.GetSet();
-    assert(sl.size() == 1);
-    OutputSet::sSetElement const & se = *sl.begin();
+    OutputSet const & nsl = nos.GetSet();
+    assert(nsl.size() == 1);
+    OutputSet::sSetElement const & se = *nsl.begin();
     int next_output_port = se.output_port;
     assert(next_output_port >= 0);
     assert(_noq_next_output_port[input][vc] < 0);
@@ -29,13 +29,13 @@
 #define _IQ_ROUTER_HPP_
 
 #include <string>
-#include <deque>
 #include <queue>
 #include <set>
 #include <map>
 
 #include "router.hpp"
 #include "routefunc.hpp"
+#include "ring_queue.hpp"
 
 using namespace std;
 
@@ -67,18 +67,22 @@ class IQRouter : public Router {
   int _vc_alloc_delay;
   int _sw_alloc_delay;
 
-  map<int, Flit *> _in_queue_flits;
+  // flits and credits that arrived or were generated this cycle, per input
+  vector<Flit *> _in_queue_flits;
 
-  deque<pair<int, pair<Credit *, int> > > _proc_credits;
+  RingQueue<pair<int, pair<Credit *, int> > > _proc_credits;
 
-  deque<pair<int, pair<int, int> > > _route_vcs;
-  deque<pair<int, pair<pair<int, int>, int> > > _vc_alloc_vcs;  
-  deque<pair<int, pair<pair<int, int>, int> > > _sw_hold_vcs;
-  deque<pair<int, pair<pair<int, int>, int> > > _sw_alloc_vcs;
+  RingQueue<pair<int, pair<int, int> > > _route_vcs;
+  RingQueue<pair<int, pair<pair<int, int>, int> > > _vc_alloc_vcs;  
+  RingQueue<pair<int, pair<pair<int, int>, int> > > _sw_hold_vcs;
+  RingQueue<pair<int, pair<pair<int, int>, int> > > _sw_alloc_vcs;
 
-  deque<pair<int, pair<Flit *, pair<int, int> > > > _crossbar_flits;
+  RingQueue<pair<int, pair<Flit *, pair<int, int> > > > _crossbar_flits;
 
-  map<int, Credit *> _out_queue_credits;
+  vector<Credit *> _out_queue_credits;
+
+  // outputs that had a VC assigned in the current _VCAllocUpdate()
+  vector<int> _vc_alloc_matched;
 
   vector<Buffer *> _buf;
   vector<BufferState *> _next_buf;
@@ -93,9 +97,9 @@ class IQRouter : public Router {
   tRoutingFunction   _rf;
 
   int _output_buffer_size;
-  vector<queue<Flit *> > _output_buffer;
+  vector<RingQueue<Flit *> > _output_buffer;
 
-  vector<queue<Credit *> > _credit_buffer;
+  vector<RingQueue<Credit *> > _credit_buffer;
 
   bool _hold_switch_for_packet;
   vector<int> _switch_hold_in;
@@ -116,21 +120,24 @@ class IQRouter : public Router {
 
   virtual void _InternalStep( int subnet, TrafficManager * trafficManager);
 
-  bool _SWAllocAddReq(int input, int vc, int output);
+  // The pipeline stages are specialized by a traits class (see IQRouter::New).
+  template<class T> bool _SWAllocAddReq(int input, int vc, int output);
+  template<class T, class A> bool _SWAllocAddReq(A * allocator, int input, int vc,
+						  int output, int prio);
 
-  void _InputQueuing(int subnet, TrafficManager * trafficmanager );
+  template<class T> void _InputQueuing(int subnet, TrafficManager * trafficmanager );
 
-  void _RouteEvaluate( );
-  void _VCAllocEvaluate( );
-  void _SWHoldEvaluate( );
-  void _SWAllocEvaluate( );
-  void _SwitchEvaluate( );
+  template<class T> void _RouteEvaluate( );
+  template<class T> void _VCAllocEvaluate( );
+  template<class T> void _SWHoldEvaluate( );
+  template<class T> void _SWAllocEvaluate( );
+  template<class T> void _SwitchEvaluate( );
 
-  void _RouteUpdate( );
-  void _VCAllocUpdate( );
-  void _SWHoldUpdate( );
-  void _SWAllocUpdate(int subnet, TrafficManager * trafficmanager );
-  void _SwitchUpdate( );
+  template<class T> void _RouteUpdate( );
+  template<class T> void _VCAllocUpdate( );
+  template<class T> void _SWHoldUpdate( );
+  template<class T> void _SWAllocUpdate(int subnet, TrafficManager * trafficmanager );
+  template<class T> void _SwitchUpdate( );
 
   void _OutputQueuing( );
 
@@ -148,6 +155,10 @@ class IQRouter : public Router {
   SwitchMonitor * _switchMonitor ;
   BufferMonitor * _bufferMonitor ;
 
+protected:
+
+  template<class T> void _PipelineStep( int subnet, TrafficManager * trafficmanager );
+
 public:
 
   IQRouter( Configuration const & config,
@@ -155,11 +166,20 @@ public:
 	    int inputs, int outputs );
   
   virtual ~IQRouter( );
+
+  // picks the pipeline variant that matches the configuration
+  static IQRouter * New( Configuration const & config,
+			 Module *parent, string const & name, int id,
+			 int inputs, int outputs );
   
   virtual void AddOutputChannel(FlitChannel * channel, CreditChannel * backchannel);
 
   virtual void ReadInputs( );
   virtual void WriteOutputs( );
+
+  virtual bool Idle( ) const;
+
+  virtual void Serialize( Checkpoint & ckpt );
   
   void Display( ostream & os = cout ) const;
 
@@ -180,6 +200,7 @@ public:
 
   inline void SetNextBufState(int output, BufferState::_states s){
 	  _next_buf[output]->SetState(s);
+	  Wake();
   };
   inline BufferState * GetNextBuf(int output){
 	  return _next_buf[output];
@@ -42,6 +42,7 @@
 #include <iostream>
 #include <cassert>
 #include "router.hpp"
+#include "checkpoint.hpp"
 
 //////////////////Sub router types//////////////////////
 #include "iq_router.hpp"
@@ -92,6 +93,7 @@ void Router::AddInputChannel( FlitChannel *channel, CreditChannel *backchannel )
   _input_channels.push_back( channel );
   _input_credits.push_back( backchannel );
   channel->SetSink( this, _input_channels.size() - 1 ) ;
+  channel->SetReceiver( this );
 }
 
 void Router::AddOutputChannel( FlitChannel *channel, CreditChannel *backchannel )
@@ -100,6 +102,7 @@ void Router::AddOutputChannel( FlitChannel *channel, CreditChannel *backchannel
   _output_credits.push_back( backchannel );
   _channel_faults.push_back( false );
   channel->SetSource( this, _output_channels.size() - 1 ) ;
+  backchannel->SetReceiver( this );
 }
 
 void Router::Evaluate(int subnet, TrafficManager* trafficManager )
@@ -111,6 +114,43 @@ void Router::Evaluate(int subnet, TrafficManager* trafficManager )
   }
 }
 
+// flits or credits waiting to be picked up by ReadInputs
+bool Router::_InputsPending( ) const
+{
+  for ( size_t i = 0; i < _input_channels.size( ); ++i ) {
+    if ( _input_channels[i]->Receive( ) ) {
+      return true;
+    }
+  }
+  for ( size_t o = 0; o < _output_credits.size( ); ++o ) {
+    if ( _output_credits[o]->Receive( ) ) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// state shared by all router types, for use by their Serialize()
+void Router::_SerializeState( Checkpoint & ckpt )
+{
+  ckpt.Sync( _partial_internal_cycles );
+  ckpt.Sync( _channel_faults );
+#ifdef TRACK_FLOWS
+  ckpt.Sync( _received_flits );
+  ckpt.Sync( _stored_flits );
+  ckpt.Sync( _sent_flits );
+  ckpt.Sync( _outstanding_credits );
+  ckpt.Sync( _active_packets );
+#endif
+#ifdef TRACK_STALLS
+  ckpt.Sync( _buffer_busy_stalls );
+  ckpt.Sync( _buffer_conflict_stalls );
+  ckpt.Sync( _buffer_full_stalls );
+  ckpt.Sync( _buffer_reserved_stalls );
+  ckpt.Sync( _crossbar_conflict_stalls );
+#endif
+}
+
 void Router::OutChannelFault( int c, bool fault )
 {
   assert( ( c >= 0 ) && ( (size_t)c < _channel_faults.size( ) ) );
@@ -133,7 +173,7 @@ Router *Router::NewRouter( const Configuration& config,
   const string type = config.GetStr( "router" );
   Router *r = NULL;
   if ( type == "iq" ) {
-    r = new IQRouter( config, parent, name, id, inputs, outputs );
+    r = IQRouter::New( config, parent, name, id, inputs, outputs );
   } else if ( type == "event" ) {
     r = new EventRouter( config, parent, name, id, inputs, outputs );
   } else if ( type == "chaos" ) {
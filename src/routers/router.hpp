@@ -91,6 +91,10 @@ protected:
 
   virtual void _InternalStep(int subnet, TrafficManager* trafficmanager) = 0;
 
+  bool _InputsPending( ) const;
+
+  void _SerializeState( Checkpoint & ckpt );
+
 public:
   Router( const Configuration& config,
 	  Module *parent, const string & name, int id,
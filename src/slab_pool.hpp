@@ -0,0 +1,182 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef _SLAB_POOL_HPP_
+#define _SLAB_POOL_HPP_
+
+#include <vector>
+#include <mutex>
+#include <atomic>
+
+using namespace std;
+
+// Pool of recycled objects carved out of large contiguous blocks. Every
+// thread keeps its own free list and only takes the shared lock to trade a
+// batch of objects with the shared free list or to allocate a new block,
+// so routers stepped by several threads can allocate without contention.
+// Objects are constructed once per block and handed out again as they
+// were freed; FreeAll() releases all blocks at once.
+template<class T> class SlabPool {
+
+public:
+  static T * New( );
+  static void Free( T * t );
+  static void FreeAll( );
+
+  // objects currently handed out, the most handed out at any one time, and
+  // the number of objects in all blocks
+  static inline int Live( ) {return _live.load(memory_order_relaxed);}
+  static inline int Peak( ) {return _peak.load(memory_order_relaxed);}
+  static inline int Allocated( ) {return _allocated.load(memory_order_relaxed);}
+
+private:
+  static int const _block_size = 1024;
+  static int const _batch_size = 256;
+
+  struct Cache {
+    vector<T *> free;
+    unsigned int generation;
+    Cache( ) : generation(0) {}
+    ~Cache( );
+  };
+
+  static thread_local Cache _cache;
+
+  static mutex _lock;
+  static vector<T *> _blocks;
+  static vector<T *> _shared;
+
+  // bumped by FreeAll() to invalidate the per-thread free lists
+  static atomic<unsigned int> _generation;
+
+  static atomic<int> _live;
+  static atomic<int> _peak;
+  static atomic<int> _allocated;
+
+  static Cache & _GetCache( );
+  static void _Refill( Cache & cache );
+  static void _Spill( Cache & cache );
+};
+
+template<class T> thread_local typename SlabPool<T>::Cache SlabPool<T>::_cache;
+template<class T> mutex SlabPool<T>::_lock;
+template<class T> vector<T *> SlabPool<T>::_blocks;
+template<class T> vector<T *> SlabPool<T>::_shared;
+template<class T> atomic<unsigned int> SlabPool<T>::_generation(1);
+template<class T> atomic<int> SlabPool<T>::_live(0);
+template<class T> atomic<int> SlabPool<T>::_peak(0);
+template<class T> atomic<int> SlabPool<T>::_allocated(0);
+
+// hand a thread's free objects back when it exits
+template<class T> SlabPool<T>::Cache::~Cache( )
+{
+  if(!free.empty() && (generation == _generation.load(memory_order_relaxed))) {
+    lock_guard<mutex> guard(_lock);
+    _shared.insert(_shared.end(), free.begin(), free.end());
+  }
+}
+
+template<class T> typename SlabPool<T>::Cache & SlabPool<T>::_GetCache( )
+{
+  Cache & cache = _cache;
+  unsigned int const generation = _generation.load(memory_order_relaxed);
+  if(cache.generation != generation) {
+    cache.free.clear();
+    cache.generation = generation;
+  }
+  return cache;
+}
+
+template<class T> T * SlabPool<T>::New( )
+{
+  Cache & cache = _GetCache();
+  if(cache.free.empty()) {
+    _Refill(cache);
+  }
+  T * t = cache.free.back();
+  cache.free.pop_back();
+
+  int const live = _live.fetch_add(1, memory_order_relaxed) + 1;
+  int peak = _peak.load(memory_order_relaxed);
+  while((live > peak) &&
+        !_peak.compare_exchange_weak(peak, live, memory_order_relaxed)) {
+  }
+  return t;
+}
+
+template<class T> void SlabPool<T>::Free( T * t )
+{
+  Cache & cache = _GetCache();
+  cache.free.push_back(t);
+  if((int)cache.free.size() >= 2 * _batch_size) {
+    _Spill(cache);
+  }
+  _live.fetch_sub(1, memory_order_relaxed);
+}
+
+template<class T> void SlabPool<T>::FreeAll( )
+{
+  lock_guard<mutex> guard(_lock);
+  for(size_t i = 0; i < _blocks.size(); ++i) {
+    delete [] _blocks[i];
+  }
+  _blocks.clear();
+  _shared.clear();
+  _generation.fetch_add(1, memory_order_relaxed);
+  _live.store(0, memory_order_relaxed);
+  _peak.store(0, memory_order_relaxed);
+  _allocated.store(0, memory_order_relaxed);
+}
+
+// Takes a batch from the shared free list, or a fresh block if it is empty.
+// A block is queued so that its objects are handed out in address order.
+template<class T> void SlabPool<T>::_Refill( Cache & cache )
+{
+  lock_guard<mutex> guard(_lock);
+  if(!_shared.empty()) {
+    size_t const n = min(_shared.size(), (size_t)_batch_size);
+    cache.free.insert(cache.free.end(), _shared.end() - n, _shared.end());
+    _shared.resize(_shared.size() - n);
+  } else {
+    T * block = new T[_block_size];
+    _blocks.push_back(block);
+    _allocated.fetch_add(_block_size, memory_order_relaxed);
+    for(int i = _block_size - 1; i >= 0; --i) {
+      cache.free.push_back(&block[i]);
+    }
+  }
+}
+
+// Moves the least recently freed batch to the shared free list.
+template<class T> void SlabPool<T>::_Spill( Cache & cache )
+{
+  lock_guard<mutex> guard(_lock);
+  _shared.insert(_shared.end(), cache.free.begin(), cache.free.begin() + _batch_size);
+  cache.free.erase(cache.free.begin(), cache.free.begin() + _batch_size);
+}
+
+#endif
@@ -41,6 +41,7 @@
 #include <cstdio>
 
 #include "stats.hpp"
+#include "checkpoint.hpp"
 
 Stats::Stats( Module *parent, const string &name,
 	      double bin_size, int num_bins ) :
@@ -128,3 +129,13 @@ ostream & operator<<(ostream & os, const Stats & s) {
   os << "]";
   return os;
 }
+
+void Stats::Serialize( Checkpoint & ckpt )
+{
+  ckpt.Sync(_num_samples);
+  ckpt.Sync(_sample_sum);
+  ckpt.Sync(_sample_squared_sum);
+  ckpt.Sync(_min);
+  ckpt.Sync(_max);
+  ckpt.Sync(_hist);
+}
@@ -30,6 +30,8 @@
 
 #include "module.hpp"
 
+class Checkpoint;
+
 class Stats : public Module {
   int    _num_samples;
   double _sample_sum;
@@ -65,6 +67,8 @@ public:
 
   int GetBin(int b){ return _hist[b];}
 
+  void Serialize( Checkpoint & ckpt );
+
   void Display( ostream & os = cout ) const;
 
   friend ostream & operator<<(ostream & os, const Stats & s);
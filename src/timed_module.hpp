@@ -29,18 +29,46 @@
 #define _TIMED_MODULE_HPP_
 
 #include "module.hpp"
+#include "active_set.hpp"
 
 class TrafficManager;
+class Checkpoint;
 
 class TimedModule : public Module {
 
 public:
-    TimedModule(Module * parent, string const & name) : Module(parent, name) {}
+    TimedModule(Module * parent, string const & name) : Module(parent, name), _wake_set(NULL), _wake_index(-1) {}
     virtual ~TimedModule() {}
 
     virtual void ReadInputs() = 0;
     virtual void Evaluate(int, TrafficManager*) = 0;
     virtual void WriteOutputs() = 0;
+
+    // Active-set scheduling: a module that reports Idle() after writing its
+    // outputs is skipped until something calls Wake() on it again. Idle()
+    // must only return true if all three phases would be no-ops.
+    virtual bool Idle() const { return false; }
+
+    // Saves or restores all state that persists from one cycle to the next.
+    virtual void Serialize(Checkpoint & ckpt) {
+        Error("Checkpointing is not supported by this module.");
+    }
+
+    // Modules that step other modules on their behalf forward the wake set
+    // to them so that a send to any of them wakes the owner.
+    virtual void SetWakeSet(ActiveSet * s, int index) {
+        _wake_set = s;
+        _wake_index = index;
+    }
+    inline void Wake() {
+        if(_wake_set) {
+            _wake_set->Insert(_wake_index);
+        }
+    }
+
+protected:
+    ActiveSet * _wake_set;
+    int _wake_index;
 };
 
 #endif
@@ -31,6 +31,9 @@
 #include <limits>
 #include <cstdlib>
 #include <ctime>
+#include <cstring>
+#include <unistd.h>
+#include <sys/wait.h>
 
 #include "booksim.hpp"
 #include "booksim_config.hpp"
@@ -38,7 +41,11 @@
 #include "batchtrafficmanager.hpp"
 #include "random_utils.hpp" 
 #include "vc.hpp"
+#include "credit.hpp"
 #include "packet_reply_info.hpp"
+#include "checkpoint.hpp"
+#include "misc_utils.hpp"
+#include "alloc_counter.hpp"
 
 TrafficManager * TrafficManager::New(Configuration const & config,
                                      vector<Network *> const & net)
@@ -63,7 +70,21 @@ TrafficManager::TrafficManager( const Configuration &config, const vector<Networ
     _routers = _net[0]->NumRouters( );
 
     _vcs = config.GetInt("num_vcs");
+    VCMask::SetVCs(_vcs);
     _subnets = config.GetInt("subnets");
+
+    _subnet_pool = NULL;
+    _subnet_evaluate = false;
+    _subnet_job.tm = this;
+    if((_subnets > 1) && config.GetInt("parallel_subnets")) {
+        if(Network::ParallelSteppingSafe(config)) {
+            _subnet_pool = new WorkerPool(_subnets);
+            _subnet_evaluate = Network::ParallelEvaluateSafe(config);
+        } else {
+            cout << "WARNING: parallel_subnets ignored for this configuration, stepping subnets serially." << endl;
+        }
+    }
+    _subnet_ejected_flits.resize(_subnets, vector<Flit *>(_nodes, NULL));
  
     _subnet.resize(Flit::NUM_FLIT_TYPES);
     _subnet[Flit::READ_REQUEST] = config.GetInt("read_request_subnet");
@@ -281,7 +302,6 @@ TrafficManager::TrafficManager( const Configuration &config, const vector<Networ
 
     _total_in_flight_flits.resize(_classes);
     _measured_in_flight_flits.resize(_classes);
-    _retired_packets.resize(_classes);
 
     _packet_seq_no.resize(_nodes);
     _repliesPending.resize(_nodes);
@@ -353,6 +373,11 @@ TrafficManager::TrafficManager( const Configuration &config, const vector<Networ
 
     _include_queuing = config.GetInt( "include_queuing" );
 
+    _skip_idle_cycles = config.GetInt( "skip_idle_cycles" );
+
+    _count_allocations = config.GetInt( "count_allocations" );
+    EnableAllocCounter(_count_allocations);
+
     _print_csv_results = config.GetInt( "print_csv_results" );
     _deadlock_warn_timeout = config.GetInt( "deadlock_warn_timeout" );
 
@@ -380,6 +405,28 @@ TrafficManager::TrafficManager( const Configuration &config, const vector<Networ
         _stats_out = new ofstream(stats_out_file.c_str());
         config.WriteMatlabFile(_stats_out);
     }
+
+    _checkpoint_out = config.GetStr( "checkpoint_out" );
+    _checkpoint_in = config.GetStr( "checkpoint_in" );
+
+    _fork_after_warmup = config.GetInt( "fork_after_warmup" );
+    int const parallel_sims = config.GetInt( "parallel_sims" );
+    _fork_jobs = (parallel_sims < 0) ? (int)sysconf(_SC_NPROCESSORS_ONLN) : parallel_sims;
+    _fork_at_start = (_fork_jobs > 0) && (_total_sims > 1) && !_fork_after_warmup;
+    if(_fork_jobs <= 0) {
+        _fork_jobs = _total_sims;
+    }
+    _fork_child = -1;
+    _fork_fd = -1;
+    _forked = false;
+    _fork_stable = true;
+    if((_fork_after_warmup || _fork_at_start) &&
+       (_subnet_pool || (config.GetInt("network_threads") > 1) ||
+        (_stats_out && (_stats_out != &cout)))) {
+        cout << "WARNING: fork_after_warmup and parallel_sims ignored for this configuration, running simulations serially." << endl;
+        _fork_after_warmup = false;
+        _fork_at_start = false;
+    }
   
 #ifdef TRACK_FLOWS
     _injected_flits.resize(_classes, vector<int>(_nodes, 0));
@@ -455,6 +502,7 @@ TrafficManager::TrafficManager( const Configuration &config, const vector<Networ
     _overall_min_plat.resize(_classes, 0.0);
     _overall_avg_plat.resize(_classes, 0.0);
     _overall_max_plat.resize(_classes, 0.0);
+    _overall_sqr_plat.resize(_classes, 0.0);
 
     _nlat_stats.resize(_classes);
     _overall_min_nlat.resize(_classes, 0.0);
@@ -497,6 +545,7 @@ TrafficManager::TrafficManager( const Configuration &config, const vector<Networ
     _overall_min_accepted.resize(_classes, 0.0);
     _overall_avg_accepted.resize(_classes, 0.0);
     _overall_max_accepted.resize(_classes, 0.0);
+    _overall_sqr_accepted.resize(_classes, 0.0);
 
 #ifdef TRACK_STALLS
     _buffer_busy_stalls.resize(_classes);
@@ -589,6 +638,8 @@ TrafficManager::TrafficManager( const Configuration &config, const vector<Networ
 TrafficManager::~TrafficManager( )
 {
 
+    if(_subnet_pool) delete _subnet_pool;
+
     for ( int source = 0; source < _nodes; ++source ) {
         for ( int subnet = 0; subnet < _subnets; ++subnet ) {
             delete _buf_states[source][subnet];
@@ -636,6 +687,7 @@ TrafficManager::~TrafficManager( )
 
     PacketReplyInfo::FreeAll();
     Flit::FreeAll();
+    Packet::FreeAll();
     Credit::FreeAll();
 }
 
@@ -644,111 +696,100 @@ void TrafficManager::_RetireFlit( Flit *f, int dest )
 {
     _deadlock_timer = 0;
 
-    assert(_total_in_flight_flits[f->cl].count(f->id) > 0);
-    _total_in_flight_flits[f->cl].erase(f->id);
+    Packet * const p = f->packet;
+
+    assert(_total_in_flight_flits[p->cl].count(f->id) > 0);
+    _total_in_flight_flits[p->cl].erase(f->id);
   
-    if(f->record) {
-        assert(_measured_in_flight_flits[f->cl].count(f->id) > 0);
-        _measured_in_flight_flits[f->cl].erase(f->id);
+    if(p->record) {
+        assert(_measured_in_flight_flits[p->cl].count(f->id) > 0);
+        _measured_in_flight_flits[p->cl].erase(f->id);
     }
 
     if ( f->watch ) { 
         *gWatchOut << GetSimTime() << " | "
                    << "node" << dest << " | "
                    << "Retiring flit " << f->id 
-                   << " (packet " << f->pid
-                   << ", src = " << f->src 
-                   << ", dest = " << f->dest
+                   << " (packet " << p->pid
+                   << ", src = " << p->src 
+                   << ", dest = " << p->dest
                    << ", hops = " << f->hops
                    << ", flat = " << f->atime - f->itime
                    << ")." << endl;
     }
 
-    if ( f->head && ( f->dest != dest ) ) {
+    if ( f->head && ( p->dest != dest ) ) {
         ostringstream err;
         err << "Flit " << f->id << " arrived at incorrect output " << dest;
         Error( err.str( ) );
     }
   
-    if((_slowest_flit[f->cl] < 0) ||
-       (_flat_stats[f->cl]->Max() < (f->atime - f->itime)))
-        _slowest_flit[f->cl] = f->id;
-    _flat_stats[f->cl]->AddSample( f->atime - f->itime);
+    if((_slowest_flit[p->cl] < 0) ||
+       (_flat_stats[p->cl]->Max() < (f->atime - f->itime)))
+        _slowest_flit[p->cl] = f->id;
+    _flat_stats[p->cl]->AddSample( f->atime - f->itime);
     if(_pair_stats){
-        _pair_flat[f->cl][f->src*_nodes+dest]->AddSample( f->atime - f->itime );
+        _pair_flat[p->cl][p->src*_nodes+dest]->AddSample( f->atime - f->itime );
     }
       
+    if ( f->head ) {
+        p->head_itime = f->itime;
+        p->head_atime = f->atime;
+        p->head_id = f->id;
+    }
+
     if ( f->tail ) {
-        Flit * head;
-        if(f->head) {
-            head = f;
-        } else {
-            map<int, Flit *>::iterator iter = _retired_packets[f->cl].find(f->pid);
-            assert(iter != _retired_packets[f->cl].end());
-            head = iter->second;
-            _retired_packets[f->cl].erase(iter);
-            assert(head->head);
-            assert(f->pid == head->pid);
-        }
         if ( f->watch ) { 
             *gWatchOut << GetSimTime() << " | "
                        << "node" << dest << " | "
-                       << "Retiring packet " << f->pid 
-                       << " (plat = " << f->atime - head->ctime
-                       << ", nlat = " << f->atime - head->itime
-                       << ", frag = " << (f->atime - head->atime) - (f->id - head->id) // NB: In the spirit of solving problems using ugly hacks, we compute the packet length by taking advantage of the fact that the IDs of flits within a packet are contiguous.
-                       << ", src = " << head->src 
-                       << ", dest = " << head->dest
+                       << "Retiring packet " << p->pid 
+                       << " (plat = " << f->atime - p->ctime
+                       << ", nlat = " << f->atime - p->head_itime
+                       << ", frag = " << (f->atime - p->head_atime) - (f->id - p->head_id) // NB: In the spirit of solving problems using ugly hacks, we compute the packet length by taking advantage of the fact that the IDs of flits within a packet are contiguous.
+                       << ", src = " << p->src 
+                       << ", dest = " << p->dest
                        << ")." << endl;
         }
 
         //code the source of request, look carefully, its tricky ;)
-        if (f->type == Flit::READ_REQUEST || f->type == Flit::WRITE_REQUEST) {
+        if (p->type == Flit::READ_REQUEST || p->type == Flit::WRITE_REQUEST) {
             PacketReplyInfo* rinfo = PacketReplyInfo::New();
-            rinfo->source = f->src;
+            rinfo->source = p->src;
             rinfo->time = f->atime;
-            rinfo->record = f->record;
-            rinfo->type = f->type;
+            rinfo->record = p->record;
+            rinfo->type = p->type;
             _repliesPending[dest].push_back(rinfo);
         } else {
-            if(f->type == Flit::READ_REPLY || f->type == Flit::WRITE_REPLY  ){
+            if(p->type == Flit::READ_REPLY || p->type == Flit::WRITE_REPLY  ){
                 _requestsOutstanding[dest]--;
-            } else if(f->type == Flit::ANY_TYPE) {
-                _requestsOutstanding[f->src]--;
+            } else if(p->type == Flit::ANY_TYPE) {
+                _requestsOutstanding[p->src]--;
             }
       
         }
 
         // Only record statistics once per packet (at tail)
         // and based on the simulation state
-        if ( ( _sim_state == warming_up ) || f->record ) {
+        if ( ( _sim_state == warming_up ) || p->record ) {
       
-            _hop_stats[f->cl]->AddSample( f->hops );
-
-            if((_slowest_packet[f->cl] < 0) ||
-               (_plat_stats[f->cl]->Max() < (f->atime - head->itime)))
-                _slowest_packet[f->cl] = f->pid;
-            _plat_stats[f->cl]->AddSample( f->atime - head->ctime);
-            _nlat_stats[f->cl]->AddSample( f->atime - head->itime);
-            _frag_stats[f->cl]->AddSample( (f->atime - head->atime) - (f->id - head->id) );
+            _hop_stats[p->cl]->AddSample( f->hops );
+
+            if((_slowest_packet[p->cl] < 0) ||
+               (_plat_stats[p->cl]->Max() < (f->atime - p->head_itime)))
+                _slowest_packet[p->cl] = p->pid;
+            _plat_stats[p->cl]->AddSample( f->atime - p->ctime);
+            _nlat_stats[p->cl]->AddSample( f->atime - p->head_itime);
+            _frag_stats[p->cl]->AddSample( (f->atime - p->head_atime) - (f->id - p->head_id) );
    
             if(_pair_stats){
-                _pair_plat[f->cl][f->src*_nodes+dest]->AddSample( f->atime - head->ctime );
-                _pair_nlat[f->cl][f->src*_nodes+dest]->AddSample( f->atime - head->itime );
+                _pair_plat[p->cl][p->src*_nodes+dest]->AddSample( f->atime - p->ctime );
+                _pair_nlat[p->cl][p->src*_nodes+dest]->AddSample( f->atime - p->head_itime );
             }
         }
     
-        if(f != head) {
-            head->Free();
-        }
-    
     }
   
-    if(f->head && !f->tail) {
-        _retired_packets[f->cl].insert(make_pair(f->pid, f));
-    } else {
-        f->Free();
-    }
+    f->Free();
 }
 
 int TrafficManager::_IssuePacket( int source, int cl )
@@ -852,35 +893,35 @@ void TrafficManager::_GeneratePacket( int source, int stype,
                    << "." << endl;
     }
   
+    Packet * p = Packet::New();
+    p->pid        = pid;
+    p->subnetwork = subnetwork;
+    p->src        = source;
+    p->ctime      = time;
+    p->record     = record;
+    p->cl         = cl;
+    p->type       = packet_type;
+    //packets are only generated to nodes smaller or equal to limit
+    p->dest       = packet_destination;
+
     for ( int i = 0; i < size; ++i ) {
-        Flit * f  = Flit::New();
+        Flit * f  = Flit::New(p);
         f->id     = _cur_id++;//_cur_id是根据flit产生的顺序给每个flit的编号
         assert(_cur_id);
-        f->pid    = pid;
         f->watch  = watch | (gWatchOut && (_flits_to_watch.count(f->id) > 0));
-        f->subnetwork = subnetwork;
-        f->src    = source;
-        f->ctime  = time;
-        f->record = record;
-        f->cl     = cl;
 
-        _total_in_flight_flits[f->cl].insert(make_pair(f->id, f));//只要通过generate产生了flit，就要加入到_total_in_flight_flits里面
+        _total_in_flight_flits[f->packet->cl].insert(make_pair(f->id, f));//只要通过generate产生了flit，就要加入到_total_in_flight_flits里面
         if(record) {
-            _measured_in_flight_flits[f->cl].insert(make_pair(f->id, f));
+            _measured_in_flight_flits[f->packet->cl].insert(make_pair(f->id, f));
         }
     
         if(gTrace){
-            cout<<"New Flit "<<f->src<<endl;
+            cout<<"New Flit "<<f->packet->src<<endl;
         }
-        f->type = packet_type;
-
         if ( i == 0 ) { // Head flit
             f->head = true;
-            //packets are only generated to nodes smaller or equal to limit
-            f->dest = packet_destination;
         } else {
             f->head = false;
-            f->dest = -1;
         }
         switch( _pri_type ) {
         case class_based:
@@ -910,7 +951,7 @@ void TrafficManager::_GeneratePacket( int source, int stype,
             *gWatchOut << GetSimTime() << " | "
                        << "node" << source << " | "
                        << "Enqueuing flit " << f->id
-                       << " (packet " << f->pid
+                       << " (packet " << f->packet->pid
                        << ") at time " << time
                        << "." << endl;
         }
@@ -962,46 +1003,28 @@ void TrafficManager::_Step( )
         cout << "WARNING: Possible network deadlock.\n";
     }
 
-    vector<map<int, Flit *> > flits(_subnets);
-  
-    for ( int subnet = 0; subnet < _subnets; ++subnet ) {
-        for ( int n = 0; n < _nodes; ++n ) {
-            Flit * const f = _net[subnet]->ReadFlit( n );//该节点eject信道的_output flit
-            if ( f ) {
-                if(f->watch) {
-                    *gWatchOut << GetSimTime() << " | "
-                               << "node" << n << " | "
-                               << "Ejecting flit " << f->id
-                               << " (packet " << f->pid << ")"
-                               << " from VC " << f->vc
-                               << "." << endl;
-                }
-                flits[subnet].insert(make_pair(n, f));//flits里面保存eject信道的_output flit；这里是插入map
-                if((_sim_state == warming_up) || (_sim_state == running)) {
-                    ++_accepted_flits[f->cl][n];
-                    if(f->tail) {
-                        ++_accepted_packets[f->cl][n];
-                    }
-                }
-            }
+    if(_subnet_pool) {
+        _subnet_phase = subnet_read;
+        _subnet_pool->Run(&_subnet_job);
+    } else {
+        for ( int subnet = 0; subnet < _subnets; ++subnet ) {
+            _ReadSubnet(subnet);
+        }
+    }
 
-            Credit * const c = _net[subnet]->ReadCredit( n );//该节点inject_cred信道的_output flit
-            if ( c ) {
-#ifdef TRACK_FLOWS
-                for(set<int>::const_iterator iter = c->vc.begin(); iter != c->vc.end(); ++iter) {
-                    int const vc = *iter;
-                    assert(!_outstanding_classes[n][subnet][vc].empty());
-                    int cl = _outstanding_classes[n][subnet][vc].front();
-                    _outstanding_classes[n][subnet][vc].pop();
-                    assert(_outstanding_credits[cl][subnet][n] > 0);
-                    --_outstanding_credits[cl][subnet][n];
+    if((_sim_state == warming_up) || (_sim_state == running)) {
+        for ( int subnet = 0; subnet < _subnets; ++subnet ) {
+            for(int n = 0; n < _nodes; ++n) {
+                Flit * const f = _subnet_ejected_flits[subnet][n];
+                if(!f) {
+                    continue;
+                }
+                ++_accepted_flits[f->packet->cl][n];
+                if(f->tail) {
+                    ++_accepted_packets[f->packet->cl][n];
                 }
-#endif
-                _buf_states[n][subnet]->ProcessCredit(c);
-                c->Free();
             }
         }
-        _net[subnet]->ReadInputs( );//1.信道执行ReadInputs，将信道_input数据读入到信道_wait_queue，同时指定出队时间；2.路由器遍历自己的输入信道，将输入信道的_output读入_in_queue_flits，并修改_active为true
     }
   
     if ( !_empty_network ) {
@@ -1021,7 +1044,7 @@ void TrafficManager::_Step( )
             int class_limit = _classes;
 
             if(_hold_switch_for_packet) {
-                list<Flit *> const & pp = _partial_packets[n][last_class];
+                tFlitList const & pp = _partial_packets[n][last_class];
                 if(!pp.empty() && !pp.front()->head && 
                    !dest_buf->IsFullFor(pp.front()->vc)) {
                     f = pp.front();
@@ -1037,7 +1060,7 @@ void TrafficManager::_Step( )
 
                 int const c = (last_class + i) % _classes;
 
-                list<Flit *> const & pp = _partial_packets[n][c];
+                tFlitList const & pp = _partial_packets[n][c];
 
                 if(pp.empty()) {
 //dest_buf状态改变有三个契机，一是没有flit过来，如idle变sleeping，wakingup变active；二是flit过来，如sleeping变wakingup，idle变active；三是buffer为空，且最后是tail flit离开，如active转idle。
@@ -1047,9 +1070,9 @@ void TrafficManager::_Step( )
 
                 Flit * const cf = pp.front();
                 assert(cf);
-                assert(cf->cl == c);
+                assert(cf->packet->cl == c);
 	
-                if(cf->subnetwork != subnet) {
+                if(cf->packet->subnetwork != subnet) {
                     continue;
                 }
 
@@ -1061,7 +1084,7 @@ void TrafficManager::_Step( )
 
                     OutputSet route_set;
                     _rf(NULL, cf, -1, &route_set, true);//通过路由算法将包注入路由器，注入操作得到的输出端口为-1；这里只是更新了变量route_set，并没有更新flit的la_route_set
-                    set<OutputSet::sSetElement> const & os = route_set.GetSet();
+                    OutputSet const & os = route_set.GetSet();
                     assert(os.size() == 1);
                     OutputSet::sSetElement const &se = *os.begin();
                     assert(se.output_port == -1);
@@ -1079,7 +1102,7 @@ void TrafficManager::_Step( )
                         // first hop, we have to temporarily set cf's VC to be non-negative 
                         // in order to avoid seting of an assertion in the routing function.
                         cf->vc = vc_start;
-                        _rf(router, cf, in_channel, &cf->la_route_set, false);
+                        _rf(router, cf, in_channel, &cf->packet->la_route_set, false);
                         cf->vc = -1;
 
                         if (cf->watch) {
@@ -1088,7 +1111,7 @@ void TrafficManager::_Step( )
                                        << "Generating lookahead routing info for flit " << cf->id
                                        << " (NOQ)." << endl;
                         }
-                        set<OutputSet::sSetElement> const sl = cf->la_route_set.GetSet();
+                        OutputSet const & sl = cf->packet->la_route_set.GetSet();
                         assert(sl.size() == 1);
                         int next_output = sl.begin()->output_port;
                         vc_count /= router->NumOutputs();
@@ -1158,9 +1181,9 @@ void TrafficManager::_Step( )
 
             if(f) {
 
-                assert(f->subnetwork == subnet);
+                assert(f->packet->subnetwork == subnet);
 
-                int const c = f->cl;
+                int const c = f->packet->cl;
 
                 if(f->head) {
 	  
@@ -1170,7 +1193,7 @@ void TrafficManager::_Step( )
                             const Router * router = inject->GetSink();
                             assert(router);
                             int in_channel = inject->GetSinkPort();
-                            _rf(router, f, in_channel, &f->la_route_set, false);
+                            _rf(router, f, in_channel, &f->packet->la_route_set, false);
                             if(f->watch) {
                                 *gWatchOut << GetSimTime() << " | "
                                            << "node" << n << " | "
@@ -1184,7 +1207,7 @@ void TrafficManager::_Step( )
                                        << " (NOQ)." << endl;
                         }
                     } else {
-                        f->la_route_set.Clear();
+                        f->packet->la_route_set.Clear();
                     }
 
                     dest_buf->TakeBuffer(f->vc);//++_in_use_by[vc]
@@ -1241,9 +1264,9 @@ void TrafficManager::_Step( )
 
     for(int subnet = 0; subnet < _subnets; ++subnet) {
         for(int n = 0; n < _nodes; ++n) {
-            map<int, Flit *>::const_iterator iter = flits[subnet].find(n);
-            if(iter != flits[subnet].end()) {
-                Flit * const f = iter->second;
+            Flit * const f = _subnet_ejected_flits[subnet][n];
+            if(f) {
+                _subnet_ejected_flits[subnet][n] = NULL;
 
                 f->atime = _time;
                 if(f->watch) {
@@ -1254,19 +1277,33 @@ void TrafficManager::_Step( )
                                << "." << endl;
                 }
                 Credit * const c = Credit::New();
-                c->vc.insert(f->vc);
+                c->vc.Insert(f->vc);
                 _net[subnet]->WriteCredit(c, n);
 	
 #ifdef TRACK_FLOWS
-                ++_ejected_flits[f->cl][n];
+                ++_ejected_flits[f->packet->cl][n];
 #endif
 	
                 _RetireFlit(f, n);//deadlock_timer清零
             }
         }
-        flits[subnet].clear();//clear函数将map清空
-        _net[subnet]->Evaluate(subnet, this );//1.信道的Evaluate函数体为空；2.路由器的Evalute函数只有在其_avtive参数为true时才执行对应操作
-        _net[subnet]->WriteOutputs( );//如果信道的等待队列wait_queue不为空，就把wait_queue里面的第一个元素写入信道的_output;对于路由器，如果output_buffer不为空，就把第一个元素写入对应的output信道的_input；如果credit_buffer不为空，就把其写入对应的input_cred信道的_input
+    }
+
+    // retiring flits above only touches traffic manager state, so the
+    // subnets themselves can be stepped independently of each other
+    if(_subnet_pool) {
+        if(!_subnet_evaluate) {
+            for(int subnet = 0; subnet < _subnets; ++subnet) {
+                _net[subnet]->Evaluate(subnet, this );
+            }
+        }
+        _subnet_phase = subnet_write;
+        _subnet_pool->Run(&_subnet_job);
+    } else {
+        for(int subnet = 0; subnet < _subnets; ++subnet) {
+            _net[subnet]->Evaluate(subnet, this );//1.信道的Evaluate函数体为空；2.路由器的Evalute函数只有在其_avtive参数为true时才执行对应操作
+            _net[subnet]->WriteOutputs( );//如果信道的等待队列wait_queue不为空，就把wait_queue里面的第一个元素写入信道的_output;对于路由器，如果output_buffer不为空，就把第一个元素写入对应的output信道的_input；如果credit_buffer不为空，就把其写入对应的input_cred信道的_input
+        }
     }
 
     ++_time;//每个sample周期_time的值会加1
@@ -1277,6 +1314,112 @@ void TrafficManager::_Step( )
 
 }
   
+void TrafficManager::_ReadSubnet( int subnet )
+{
+    for ( int n = 0; n < _nodes; ++n ) {
+        Flit * const f = _net[subnet]->ReadFlit( n );//该节点eject信道的_output flit
+        if ( f ) {
+            if(f->watch) {
+                *gWatchOut << GetSimTime() << " | "
+                           << "node" << n << " | "
+                           << "Ejecting flit " << f->id
+                           << " (packet " << f->packet->pid << ")"
+                           << " from VC " << f->vc
+                           << "." << endl;
+            }
+            _subnet_ejected_flits[subnet][n] = f;//_subnet_ejected_flits里面保存eject信道的_output flit
+        }
+
+        Credit * const c = _net[subnet]->ReadCredit( n );//该节点inject_cred信道的_output flit
+        if ( c ) {
+#ifdef TRACK_FLOWS
+            for(int vc = c->vc.First(); vc >= 0; vc = c->vc.Next(vc)) {
+                assert(!_outstanding_classes[n][subnet][vc].empty());
+                int cl = _outstanding_classes[n][subnet][vc].front();
+                _outstanding_classes[n][subnet][vc].pop();
+                assert(_outstanding_credits[cl][subnet][n] > 0);
+                --_outstanding_credits[cl][subnet][n];
+            }
+#endif
+            _buf_states[n][subnet]->ProcessCredit(c);
+            c->Free();
+        }
+    }
+    _net[subnet]->ReadInputs( );//1.信道执行ReadInputs，将信道_input数据读入到信道_wait_queue，同时指定出队时间；2.路由器遍历自己的输入信道，将输入信道的_output读入_in_queue_flits，并修改_active为true
+}
+
+void TrafficManager::_StepSubnet( int subnet )
+{
+    if(_subnet_phase == subnet_read) {
+        _ReadSubnet(subnet);
+        return;
+    }
+    if(_subnet_evaluate) {
+        _net[subnet]->Evaluate(subnet, this );
+    }
+    _net[subnet]->WriteOutputs( );
+}
+  
+// Nothing is in flight and no module of any network has work pending, so
+// the only thing that can happen in the next cycle is packet generation.
+bool TrafficManager::_Quiescent( ) const
+{
+    if ( _empty_network ) {
+        return false;
+    }
+    // generated flits stay in _total_in_flight_flits until they retire, so
+    // this also covers the source queues
+    for ( int c = 0; c < _classes; ++c ) {
+        if ( !_total_in_flight_flits[c].empty() ) {
+            return false;
+        }
+    }
+    if ( Credit::OutStanding() != 0 ) {
+        return false;
+    }
+    for ( int subnet = 0; subnet < _subnets; ++subnet ) {
+        if ( !_net[subnet]->Idle() ) {
+            return false;
+        }
+    }
+    // injection buffer states still advance their power-gating state while
+    // idle or waking up
+    for ( int n = 0; n < _nodes; ++n ) {
+        for ( int subnet = 0; subnet < _subnets; ++subnet ) {
+            BufferState::_states const s = _buf_states[n][subnet]->GetState();
+            if ( ( s == BufferState::idle ) || ( s == BufferState::wakingup ) ) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// While the system is quiescent, the next event is the next packet
+// generated by a source, so advance _time directly to it. Sources are still
+// polled every skipped cycle to draw the same random numbers as full
+// stepping. Stops at the cycle that generates a packet (which _Step then
+// completes; calling _Inject again in the same cycle is a no-op), or after
+// limit cycles. Returns the number of cycles skipped.
+int TrafficManager::_SkipIdleCycles( int limit )
+{
+    if ( !_skip_idle_cycles || gTrace || !_Quiescent( ) ) {
+        return 0;
+    }
+    int skipped = 0;
+    while ( skipped < limit ) {
+        _Inject( );
+        for ( int c = 0; c < _classes; ++c ) {
+            if ( !_total_in_flight_flits[c].empty() ) {
+                return skipped;
+            }
+        }
+        ++_time;
+        ++skipped;
+    }
+    return skipped;
+}
+
 bool TrafficManager::_PacketsOutstanding( ) const
 {
     for ( int c = 0; c < _classes; ++c ) {
@@ -1383,11 +1526,21 @@ void TrafficManager::_ComputeStats( const vector<int> & stats, int *sum, int *mi
     }
 }
 
+void TrafficManager::_DisplayPoolUsage( ostream & os ) const
+{
+    os << "Flit pool: " << SlabPool<Flit>::Live( ) << " live, "
+       << SlabPool<Flit>::Peak( ) << " peak, "
+       << SlabPool<Flit>::Allocated( ) << " allocated" << endl;
+    os << "Credit pool: " << SlabPool<Credit>::Live( ) << " live, "
+       << SlabPool<Credit>::Peak( ) << " peak, "
+       << SlabPool<Credit>::Allocated( ) << " allocated" << endl;
+}
+
 void TrafficManager::_DisplayRemaining( ostream & os ) const 
 {
     for(int c = 0; c < _classes; ++c) {
 
-        map<int, Flit *>::const_iterator iter;
+        tFlitMap::const_iterator iter;
         int i;
 
         os << "Class " << c << ":" << endl;
@@ -1426,6 +1579,19 @@ bool TrafficManager::_SingleSim( )
     vector<double> prev_accepted(_classes, 0.0);
     bool clear_last = false;
     int total_phases = 0;
+
+    if(!_checkpoint_in.empty()) {
+        // resume measuring where the checkpointed run finished warming up
+        _Checkpoint(_checkpoint_in, true, total_phases, prev_latency, prev_accepted);
+        _checkpoint_in = "";
+        clear_last = true;
+        if(_fork_after_warmup && !_ForkSims()) {
+            return true;
+        }
+    }
+    if(_fork_at_start && !_ForkSims()) {
+        return true;
+    }
     while( ( total_phases < _max_samples ) && 
            ( ( _sim_state != running ) || 
              ( converged < 3 ) ) ) {
@@ -1436,13 +1602,22 @@ bool TrafficManager::_SingleSim( )
         }
     
     
-        for ( int iter = 0; iter < _sample_period; ++iter )
+        long long const allocs = AllocCount( );
+        int const start_time = _time;
+        for ( int iter = 0; iter < _sample_period; ++iter ) {
+            iter += _SkipIdleCycles( _sample_period - iter - 1 );
             _Step( );
+        }
     
         //cout << _sim_state << endl;
 
         UpdateStats();
         DisplayStats();
+        if ( _count_allocations ) {
+            cout << "Heap allocations per cycle = "
+                 << (double)( AllocCount( ) - allocs ) / (double)( _time - start_time ) << endl;
+            _DisplayPoolUsage( );
+        }
     
         int lat_exc_class = -1;
         int lat_chg_exc_class = -1;
@@ -1470,11 +1645,11 @@ bool TrafficManager::_SingleSim( )
             double latency = (double)_plat_stats[c]->Sum();
             double count = (double)_plat_stats[c]->NumSamples();
       
-            map<int, Flit *>::const_iterator iter;
+            tFlitMap::const_iterator iter;
             for(iter = _total_in_flight_flits[c].begin(); 
                 iter != _total_in_flight_flits[c].end(); 
                 iter++) {
-                latency += (double)(_time - iter->second->ctime);
+                latency += (double)(_time - iter->second->packet->ctime);
                 count++;
             }
       
@@ -1534,6 +1709,16 @@ bool TrafficManager::_SingleSim( )
                 cout << "Warmed up ..." <<  "Time used is " << _time << " cycles" <<endl;
                 clear_last = true;
                 _sim_state = running;
+                if(!_checkpoint_out.empty()) {
+                    // the phase counter is only advanced at the end of this
+                    // iteration
+                    int phases = total_phases + 1;
+                    _Checkpoint(_checkpoint_out, false, phases, prev_latency, prev_accepted);
+                    _checkpoint_out = "";
+                }
+                if(_fork_after_warmup && !_ForkSims()) {
+                    return true;
+                }
             }
         } else if(_sim_state == running) {
             if ( ( !_measure_latency || ( lat_chg_exc_class < 0 ) ) &&
@@ -1575,11 +1760,11 @@ bool TrafficManager::_SingleSim( )
                         double acc_latency = _plat_stats[c]->Sum();
                         double acc_count = (double)_plat_stats[c]->NumSamples();
 	    
-                        map<int, Flit *>::const_iterator iter;
+                        tFlitMap::const_iterator iter;
                         for(iter = _total_in_flight_flits[c].begin(); 
                             iter != _total_in_flight_flits[c].end(); 
                             iter++) {
-                            acc_latency += (double)(_time - iter->second->ctime);
+                            acc_latency += (double)(_time - iter->second->packet->ctime);
                             acc_count++;
                         }
 	    
@@ -1647,9 +1832,22 @@ bool TrafficManager::Run( )
 
         if ( !_SingleSim( ) ) {
             cout << "Simulation unstable, ending ..." << endl;
+            if(_fork_child >= 0) {
+                _ExitForkChild(false);
+            }
             return false;
         }
 
+        if(_forked) {
+            // the children have already run every measurement phase
+            if(!_fork_stable) {
+                return false;
+            }
+            break;
+        }
+        _fork_after_warmup = false;
+        _fork_at_start = false;
+
         // Empty any remaining packets
         cout << "Draining remaining packets ..." << endl;
         _empty_network = true;
@@ -1683,11 +1881,17 @@ bool TrafficManager::Run( )
         //for the love of god don't ever say "Time taken" anywhere else
         //the power script depend on it
         cout << "Time taken is " << _time << " cycles" <<endl; 
+        if ( _count_allocations ) {
+            _DisplayPoolUsage( );
+        }
 
         if(_stats_out) {
             WriteStats(*_stats_out);
         }
         _UpdateOverallStats();
+        if(_fork_child >= 0) {
+            _ExitForkChild(true);
+        }
     }
   
     DisplayOverallStats();
@@ -1708,6 +1912,7 @@ void TrafficManager::_UpdateOverallStats() {
         _overall_min_plat[c] += _plat_stats[c]->Min();
         _overall_avg_plat[c] += _plat_stats[c]->Average();
         _overall_max_plat[c] += _plat_stats[c]->Max();
+        _overall_sqr_plat[c] += _plat_stats[c]->Average() * _plat_stats[c]->Average();
         _overall_min_nlat[c] += _nlat_stats[c]->Min();
         _overall_avg_nlat[c] += _nlat_stats[c]->Average();
         _overall_max_nlat[c] += _nlat_stats[c]->Max();
@@ -1749,6 +1954,7 @@ void TrafficManager::_UpdateOverallStats() {
         _overall_min_accepted[c] += rate_min;
         _overall_avg_accepted[c] += rate_avg;
         _overall_max_accepted[c] += rate_max;
+        _overall_sqr_accepted[c] += rate_avg * rate_avg;
         _ComputeStats( _accepted_packets[c], &count_sum, &count_min, &count_max );
         rate_min = (double)count_min / time_delta;
         rate_sum = (double)count_sum / time_delta;
@@ -1784,6 +1990,262 @@ void TrafficManager::_UpdateOverallStats() {
     }
 }
 
+vector<vector<double> *> TrafficManager::_OverallStatsVectors( )
+{
+    vector<vector<double> *> overall;
+    overall.push_back(&_overall_min_plat);
+    overall.push_back(&_overall_avg_plat);
+    overall.push_back(&_overall_max_plat);
+    overall.push_back(&_overall_sqr_plat);
+    overall.push_back(&_overall_min_nlat);
+    overall.push_back(&_overall_avg_nlat);
+    overall.push_back(&_overall_max_nlat);
+    overall.push_back(&_overall_min_flat);
+    overall.push_back(&_overall_avg_flat);
+    overall.push_back(&_overall_max_flat);
+    overall.push_back(&_overall_min_frag);
+    overall.push_back(&_overall_avg_frag);
+    overall.push_back(&_overall_max_frag);
+    overall.push_back(&_overall_hop_stats);
+    overall.push_back(&_overall_min_sent_packets);
+    overall.push_back(&_overall_avg_sent_packets);
+    overall.push_back(&_overall_max_sent_packets);
+    overall.push_back(&_overall_min_accepted_packets);
+    overall.push_back(&_overall_avg_accepted_packets);
+    overall.push_back(&_overall_max_accepted_packets);
+    overall.push_back(&_overall_min_sent);
+    overall.push_back(&_overall_avg_sent);
+    overall.push_back(&_overall_max_sent);
+    overall.push_back(&_overall_min_accepted);
+    overall.push_back(&_overall_avg_accepted);
+    overall.push_back(&_overall_max_accepted);
+    overall.push_back(&_overall_sqr_accepted);
+#ifdef TRACK_STALLS
+    overall.push_back(&_overall_buffer_busy_stalls);
+    overall.push_back(&_overall_buffer_conflict_stalls);
+    overall.push_back(&_overall_buffer_full_stalls);
+    overall.push_back(&_overall_buffer_reserved_stalls);
+    overall.push_back(&_overall_crossbar_conflict_stalls);
+#endif
+    return overall;
+}
+
+void TrafficManager::_Serialize( Checkpoint & ckpt )
+{
+    ckpt.Check(_nodes, "nodes");
+    ckpt.Check(_routers, "routers");
+    ckpt.Check(_subnets, "subnets");
+    ckpt.Check(_classes, "classes");
+    ckpt.Check(_vcs, "num_vcs");
+
+    vector<long> rng_x;
+    vector<double> rng_u;
+    if(!ckpt.Loading()) {
+        SaveRandomStream(rng_x, rng_u);
+    }
+    ckpt.Sync(rng_x);
+    ckpt.Sync(rng_u);
+    if(ckpt.Loading()) {
+        RestoreRandomStream(rng_x, rng_u);
+    }
+
+    ckpt.Sync(_time);
+    ckpt.Sync(_cur_id);
+    ckpt.Sync(_cur_pid);
+    ckpt.SyncEnum(_sim_state);
+    ckpt.Sync(_reset_time);
+    ckpt.Sync(_drain_time);
+    ckpt.Sync(_empty_network);
+    ckpt.Sync(_deadlock_timer);
+
+    ckpt.Sync(_last_class);
+    ckpt.Sync(_last_vc);
+    for(int n = 0; n < _nodes; ++n) {
+        for(int subnet = 0; subnet < _subnets; ++subnet) {
+            _buf_states[n][subnet]->Serialize(ckpt);
+        }
+    }
+#ifdef TRACK_FLOWS
+    ckpt.Sync(_outstanding_credits);
+    ckpt.Sync(_outstanding_classes);
+    ckpt.Sync(_injected_flits);
+    ckpt.Sync(_ejected_flits);
+#endif
+
+    ckpt.Sync(_qtime);
+    ckpt.Sync(_qdrained);
+    ckpt.Sync(_partial_packets);
+    ckpt.Sync(_total_in_flight_flits);
+    ckpt.Sync(_measured_in_flight_flits);
+
+    ckpt.Sync(_packet_seq_no);
+    ckpt.Sync(_repliesPending);
+    ckpt.Sync(_requestsOutstanding);
+
+    for(int c = 0; c < _classes; ++c) {
+        _injection_process[c]->Serialize(ckpt);
+    }
+
+    for(map<string, Stats *>::iterator iter = _stats.begin();
+        iter != _stats.end();
+        ++iter) {
+        iter->second->Serialize(ckpt);
+    }
+    ckpt.Sync(_sent_packets);
+    ckpt.Sync(_accepted_packets);
+    ckpt.Sync(_sent_flits);
+    ckpt.Sync(_accepted_flits);
+#ifdef TRACK_STALLS
+    ckpt.Sync(_buffer_busy_stalls);
+    ckpt.Sync(_buffer_conflict_stalls);
+    ckpt.Sync(_buffer_full_stalls);
+    ckpt.Sync(_buffer_reserved_stalls);
+    ckpt.Sync(_crossbar_conflict_stalls);
+#endif
+    ckpt.Sync(_slowest_packet);
+    ckpt.Sync(_slowest_flit);
+
+    vector<vector<double> *> overall = _OverallStatsVectors();
+    for(size_t i = 0; i < overall.size(); ++i) {
+        ckpt.Sync(*overall[i]);
+    }
+
+    for(int subnet = 0; subnet < _subnets; ++subnet) {
+        _net[subnet]->Serialize(ckpt);
+    }
+}
+
+// Saves the simulation state at the end of warmup, or restores it in place
+// of warming up. The convergence history of _SingleSim travels with it so
+// that a resumed run takes exactly the same path as an uninterrupted one.
+void TrafficManager::_Checkpoint( string const & filename, bool load, int & phases,
+                                  vector<double> & prev_latency, vector<double> & prev_accepted )
+{
+    Checkpoint ckpt(filename, load);
+    _Serialize(ckpt);
+    ckpt.Sync(phases);
+    ckpt.Sync(prev_latency);
+    ckpt.Sync(prev_accepted);
+    if(load) {
+        cout << "Restored checkpoint " << filename << " at time " << _time << endl;
+    } else {
+        cout << "Saved checkpoint " << filename << " at time " << _time << endl;
+    }
+}
+
+// Called at the start of the first simulation, or once it has warmed up:
+// forks one child per simulation, keeping at most _fork_jobs of them
+// running. Each child reseeds the random number generator and runs its
+// simulation from the shared state. The parent echoes the children's
+// output in order and accumulates their overall statistics. Returns true
+// in a child and false in the parent.
+bool TrafficManager::_ForkSims( )
+{
+    _fork_after_warmup = false;
+    _fork_at_start = false;
+
+    // draw the children's seeds up front so results only depend on the seed
+    vector<long> seeds(_total_sims);
+    for(int sim = 0; sim < _total_sims; ++sim) {
+        seeds[sim] = RandomIntLong();
+    }
+
+    vector<vector<double> *> overall = _OverallStatsVectors();
+    size_t const stats_size = overall.size() * _classes * sizeof(double);
+
+    vector<int> fds(_total_sims, -1);
+    vector<pid_t> pids(_total_sims, 0);
+    int started = 0;
+    for(int sim = 0; sim < _total_sims; ++sim) {
+        for(; (started < _total_sims) && (started < sim + _fork_jobs); ++started) {
+            int fd[2];
+            if(pipe(fd) < 0) {
+                Error("Unable to create pipe for simulation child");
+            }
+            // don't let the children inherit buffered output
+            cout.flush();
+            pid_t pid = fork();
+            if(pid < 0) {
+                Error("Unable to fork simulation child");
+            }
+            if(pid == 0) {
+                close(fd[0]);
+                for(int i = sim; i < started; ++i) {
+                    close(fds[i]);
+                }
+                _fork_child = started;
+                _fork_fd = fd[1];
+                RandomSeed(seeds[started]);
+                cout.rdbuf(_fork_log.rdbuf());
+                // only report this child's own results
+                for(size_t i = 0; i < overall.size(); ++i) {
+                    overall[i]->assign(_classes, 0.0);
+                }
+                return true;
+            }
+            close(fd[1]);
+            fds[started] = fd[0];
+            pids[started] = pid;
+        }
+
+        string result;
+        char buf[4096];
+        ssize_t n;
+        while((n = read(fds[sim], buf, sizeof(buf))) != 0) {
+            if(n < 0) {
+                Error("Unable to read from simulation child");
+            }
+            result.append(buf, n);
+        }
+        close(fds[sim]);
+        int status;
+        waitpid(pids[sim], &status, 0);
+        if(result.size() < 1 + stats_size) {
+            Error("Simulation child exited unexpectedly");
+        }
+        cout << result.substr(1 + stats_size);
+        if(!result[0]) {
+            _fork_stable = false;
+            continue;
+        }
+        char const * p = result.data() + 1;
+        for(size_t i = 0; i < overall.size(); ++i) {
+            for(int c = 0; c < _classes; ++c) {
+                double v;
+                memcpy(&v, p, sizeof(double));
+                (*overall[i])[c] += v;
+                p += sizeof(double);
+            }
+        }
+    }
+    _forked = true;
+    return false;
+}
+
+// Sends a child's output and overall statistics back to the parent.
+void TrafficManager::_ExitForkChild( bool stable )
+{
+    string result(1, stable ? 1 : 0);
+    vector<vector<double> *> overall = _OverallStatsVectors();
+    for(size_t i = 0; i < overall.size(); ++i) {
+        result.append((char const *)&(*overall[i])[0], _classes * sizeof(double));
+    }
+    result += _fork_log.str();
+
+    char const * p = result.data();
+    size_t left = result.size();
+    while(left > 0) {
+        ssize_t n = write(_fork_fd, p, left);
+        if(n < 0) {
+            _exit(1);
+        }
+        p += n;
+        left -= n;
+    }
+    close(_fork_fd);
+    _exit(0);
+}
+
 void TrafficManager::WriteStats(ostream & os) const {
   
     os << "%=================================" << endl;
@@ -2083,6 +2545,15 @@ void TrafficManager::DisplayStats(ostream & os) const {
     }
 }
 
+// Half-width of the 95% confidence interval of the mean over all
+// simulations, given the sum and sum of squares of their results.
+double TrafficManager::_ConfidenceInterval( double sum, double sqr ) const
+{
+    double const n = (double)_total_sims;
+    double const var = max(0.0, (sqr - sum * sum / n) / (n - 1.0));
+    return student_t95(_total_sims - 1) * sqrt(var / n);
+}
+
 void TrafficManager::DisplayOverallStats( ostream & os ) const {
 
     os << "====== Overall Traffic Statistics ======" << endl;
@@ -2096,6 +2567,10 @@ void TrafficManager::DisplayOverallStats( ostream & os ) const {
     
         os << "Packet latency average = " << _overall_avg_plat[c] / (double)_total_sims
            << " (" << _total_sims << " samples)" << endl;
+        if(_total_sims > 1) {
+            os << "\t95% confidence interval = +/- "
+               << _ConfidenceInterval(_overall_avg_plat[c], _overall_sqr_plat[c]) << endl;
+        }
         os << "\tminimum = " << _overall_min_plat[c] / (double)_total_sims
            << " (" << _total_sims << " samples)" << endl;
         os << "\tmaximum = " << _overall_max_plat[c] / (double)_total_sims
@@ -2145,6 +2620,10 @@ void TrafficManager::DisplayOverallStats( ostream & os ) const {
     
         os << "Accepted flit rate average = " << _overall_avg_accepted[c] / (double)_total_sims
            << " (" << _total_sims << " samples)" << endl;
+        if(_total_sims > 1) {
+            os << "\t95% confidence interval = +/- "
+               << _ConfidenceInterval(_overall_avg_accepted[c], _overall_sqr_accepted[c]) << endl;
+        }
         os << "\tminimum = " << _overall_min_accepted[c] / (double)_total_sims
            << " (" << _total_sims << " samples)" << endl;
         os << "\tmaximum = " << _overall_max_accepted[c] / (double)_total_sims
@@ -31,6 +31,7 @@
 #include <list>
 #include <map>
 #include <set>
+#include <sstream>
 #include <cassert>
 
 #include "module.hpp"
@@ -43,9 +44,12 @@
 #include "routefunc.hpp"
 #include "outputset.hpp"
 #include "injection.hpp"
+#include "worker_pool.hpp"
+#include "pool_allocator.hpp"
 
 //register the requests to a node
 class PacketReplyInfo;
+class Checkpoint;
 
 class TrafficManager : public Module {
 
@@ -111,11 +115,16 @@ protected:
 
   vector<vector<int> > _qtime;
   vector<vector<bool> > _qdrained;
-  vector<vector<list<Flit *> > > _partial_packets;
 
-  vector<map<int, Flit *> > _total_in_flight_flits;
-  vector<map<int, Flit *> > _measured_in_flight_flits;
-  vector<map<int, Flit *> > _retired_packets;
+  // every flit passes through these, so their nodes are recycled
+  typedef list<Flit *, PoolAllocator<Flit *> > tFlitList;
+  typedef map<int, Flit *, less<int>,
+              PoolAllocator<pair<int const, Flit *> > > tFlitMap;
+
+  vector<vector<tFlitList> > _partial_packets;
+
+  vector<tFlitMap> _total_in_flight_flits;
+  vector<tFlitMap> _measured_in_flight_flits;
   bool _empty_network;
 
   bool _hold_switch_for_packet;
@@ -126,6 +135,23 @@ protected:
 
   vector<int> _subnet;
 
+  // subnets stepped on their own threads (parallel_subnets)
+  enum eSubnetPhase { subnet_read, subnet_write };
+
+  class SubnetJob : public WorkerPool::Job {
+  public:
+    TrafficManager * tm;
+    void Execute( int thread ) { tm->_StepSubnet( thread ); }
+  };
+
+  WorkerPool * _subnet_pool;
+  SubnetJob _subnet_job;
+  eSubnetPhase _subnet_phase;
+  bool _subnet_evaluate;
+
+  // flit ejected at each node in the current cycle, or NULL
+  vector<vector<Flit *> > _subnet_ejected_flits;
+
   // ============ deadlock ==========
 
   int _deadlock_timer;
@@ -143,6 +169,7 @@ protected:
   vector<double> _overall_min_plat;  
   vector<double> _overall_avg_plat;  
   vector<double> _overall_max_plat;  
+  vector<double> _overall_sqr_plat;
 
   vector<Stats *> _nlat_stats;     
   vector<double> _overall_min_nlat;  
@@ -182,6 +209,7 @@ protected:
   vector<double> _overall_min_accepted;
   vector<double> _overall_avg_accepted;
   vector<double> _overall_max_accepted;
+  vector<double> _overall_sqr_accepted;
 
 #ifdef TRACK_STALLS
   vector<vector<int> > _buffer_busy_stalls;
@@ -218,6 +246,26 @@ protected:
 
   int   _include_queuing;
 
+  bool  _skip_idle_cycles;
+
+  // report heap allocations per cycle for every sample period
+  bool  _count_allocations;
+
+  // warm up once, then run each simulation's measurements in a child
+  bool  _fork_after_warmup;
+  // run each simulation from the start in a child
+  bool  _fork_at_start;
+  int   _fork_jobs;
+  int   _fork_child;
+  int   _fork_fd;
+  bool  _forked;
+  bool  _fork_stable;
+  ostringstream _fork_log;
+
+  // write the warmed-up state to / resume it from a checkpoint file
+  string _checkpoint_out;
+  string _checkpoint_in;
+
   vector<int> _measure_stats;
   bool _pair_stats;
 
@@ -266,6 +314,11 @@ protected:
 
   void _Inject();
   void _Step( );
+  void _ReadSubnet( int subnet );
+  void _StepSubnet( int subnet );
+
+  bool _Quiescent( ) const;
+  int  _SkipIdleCycles( int limit );
 
   bool _PacketsOutstanding( ) const;
   
@@ -279,11 +332,21 @@ protected:
   virtual bool _SingleSim( );
 
   void _DisplayRemaining( ostream & os = cout ) const;
+  void _DisplayPoolUsage( ostream & os = cout ) const;
   
   void _LoadWatchList(const string & filename);
 
   virtual void _UpdateOverallStats();
 
+  vector<vector<double> *> _OverallStatsVectors( );
+  bool _ForkSims( );
+  double _ConfidenceInterval( double sum, double sqr ) const;
+  void _ExitForkChild( bool stable );
+
+  virtual void _Serialize( Checkpoint & ckpt );
+  void _Checkpoint( string const & filename, bool load, int & phases,
+                    vector<double> & prev_latency, vector<double> & prev_accepted );
+
   virtual string _OverallStatsCSV(int c = 0) const;
 
   int _GetNextPacketSize(int cl) const;
@@ -0,0 +1,99 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <chrono>
+#include <cassert>
+
+#include "booksim.hpp"
+#include "worker_pool.hpp"
+
+WorkerPool::WorkerPool( int threads )
+  : _threads(threads), _job(NULL), _generation(0), _pending(0), _stop(false)
+{
+  assert(_threads >= 1);
+  for(int t = 1; t < _threads; ++t) {
+    _workers.push_back(thread(&WorkerPool::_WorkerLoop, this, t));
+  }
+}
+
+WorkerPool::~WorkerPool( )
+{
+  _stop.store(true, memory_order_release);
+  _generation.fetch_add(1, memory_order_release);
+  for(size_t i = 0; i < _workers.size(); ++i) {
+    _workers[i].join();
+  }
+}
+
+void WorkerPool::Pause( int & spins )
+{
+  // spin briefly, then give the core away; a pool that has been idle for a
+  // long time (e.g. between simulations) backs off to sleeping
+  if(spins < 64) {
+    ++spins;
+  } else if(spins < 16384) {
+    ++spins;
+    this_thread::yield();
+  } else {
+    this_thread::sleep_for(chrono::microseconds(50));
+  }
+}
+
+void WorkerPool::Run( Job * job )
+{
+  assert(job);
+  if(_threads == 1) {
+    job->Execute(0);
+    return;
+  }
+  _job = job;
+  _pending.store(_threads - 1, memory_order_relaxed);
+  _generation.fetch_add(1, memory_order_release);
+  job->Execute(0);
+  int spins = 0;
+  while(_pending.load(memory_order_acquire) > 0) {
+    Pause(spins);
+  }
+}
+
+void WorkerPool::_WorkerLoop( int thread )
+{
+  unsigned int seen = 0;
+  while(true) {
+    int spins = 0;
+    unsigned int gen;
+    while((gen = _generation.load(memory_order_acquire)) == seen) {
+      Pause(spins);
+    }
+    seen = gen;
+    if(_stop.load(memory_order_acquire)) {
+      return;
+    }
+    _job->Execute(thread);
+    _pending.fetch_sub(1, memory_order_release);
+  }
+}
@@ -0,0 +1,71 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef _WORKER_POOL_HPP_
+#define _WORKER_POOL_HPP_
+
+#include <vector>
+#include <thread>
+#include <atomic>
+
+using namespace std;
+
+// A fixed set of worker threads used to split one simulation phase across
+// cores. Run() hands the same job to every thread (the caller acts as
+// thread 0) and returns once all of them have finished it.
+class WorkerPool {
+
+public:
+  class Job {
+  public:
+    virtual ~Job() {}
+    virtual void Execute( int thread ) = 0;
+  };
+
+  WorkerPool( int threads );
+  ~WorkerPool( );
+
+  inline int NumThreads( ) const {return _threads;}
+
+  void Run( Job * job );
+
+  // back-off used while busy-waiting on another thread
+  static void Pause( int & spins );
+
+private:
+  int _threads;
+  vector<thread> _workers;
+
+  Job * _job;
+  atomic<unsigned int> _generation;
+  atomic<int> _pending;
+  atomic<bool> _stop;
+
+  void _WorkerLoop( int thread );
+};
+
+#endif